@@ -140,6 +140,9 @@ void animation_loop()
 	imgui_render_frame(scene.window.glfw_window);
 	glfwSwapBuffers(scene.window.glfw_window);
 	glfwPollEvents();
+
+	// OpenGL errors of the frame (sampled check mode)
+	opengl_check_frame();
 }
 
 
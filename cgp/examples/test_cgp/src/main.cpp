@@ -10,9 +10,17 @@
 #include "cgp/04_grid_container/grid/test/test_grid.hpp"
 #include "cgp/02_numarray/numarray/test/test_numarray.hpp"
 #include "cgp/02_numarray/numarray_stack/test/test_numarray_stack.hpp"
+#include "cgp/02_numarray/numarray_arena/test/test_numarray_arena.hpp"
 #include "cgp/19_camera_controller/test/test_camera_controller.hpp"
 #include "cgp/06_mat/test/test_matrix_stack.hpp"
 #include "cgp/06_mat/functions/test/test_vec_mat.hpp"
+#include "cgp/08_random_noise/noise/test/test_noise.hpp"
+#include "cgp/13_opengl/buffer/vbo/test/test_vbo_packing.hpp"
+#include "cgp/07_image/image_compression/test/test_image_compression.hpp"
+#include "cgp/07_image/test/test_image_transform.hpp"
+#include "cgp/07_image/image_mipmap/test/test_image_mipmap.hpp"
+#include "cgp/12_shape/implicit/marching_cube/test/test_marching_cube.hpp"
+#include "cgp/20_format_parser/mesh_loader/obj/test/test_obj.hpp"
 
 
 using namespace cgp;
@@ -27,9 +35,17 @@ int main(int, char* argv[])
 	cgp_test::test_grid_3D();
 	cgp_test::test_numarray();
 	cgp_test::test_numarray_stack();
+	cgp_test::test_numarray_arena();
 	cgp_test::test_camera_controller();
 	cgp_test::test_matrix_stack();
 	cgp_test::test_vec_mat();
+	cgp_test::test_noise();
+	cgp_test::test_vbo_packing();
+	cgp_test::test_image_compression();
+	cgp_test::test_image_transform();
+	cgp_test::test_image_mipmap();
+	cgp_test::test_marching_cube();
+	cgp_test::test_obj();
 
 
 	return 0;
@@ -6,4 +6,5 @@
 #include "stl/stl.hpp"
 #include "types/types.hpp"
 #include "string/string.hpp"
+#include "memory_arena/memory_arena.hpp"
 
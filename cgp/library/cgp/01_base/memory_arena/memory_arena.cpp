@@ -0,0 +1,112 @@
+#include "memory_arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace cgp
+{
+
+	memory_arena_structure::memory_arena_structure(size_t initial_capacity)
+	{
+		if (initial_capacity > 0)
+			add_block(initial_capacity);
+	}
+
+	memory_arena_structure::~memory_arena_structure()
+	{
+		release_blocks();
+	}
+
+	void* memory_arena_structure::allocate(size_t size, size_t alignment)
+	{
+		if (size == 0)
+			size = 1;
+
+		// Aligned position in the current block, or in a new one if it doesn't fit
+		std::uintptr_t start = 0;
+		if (!blocks.empty()) {
+			std::uintptr_t const begin = reinterpret_cast<std::uintptr_t>(blocks.back().data);
+			start = (begin + offset + alignment - 1) & ~std::uintptr_t(alignment - 1);
+			if (start + size > begin + blocks.back().size)
+				start = 0;
+		}
+		if (start == 0) {
+			size_t const previous_size = blocks.empty() ? 0 : blocks.back().size;
+			add_block(std::max(std::max(size + alignment, 2 * previous_size), block_size_min));
+			std::uintptr_t const begin = reinterpret_cast<std::uintptr_t>(blocks.back().data);
+			start = (begin + alignment - 1) & ~std::uintptr_t(alignment - 1);
+		}
+
+		offset = size_t(start + size - reinterpret_cast<std::uintptr_t>(blocks.back().data));
+		last_allocation = reinterpret_cast<void*>(start);
+
+		counters.bytes += size;
+		counters.allocations++;
+		peak_bytes = std::max(peak_bytes, counters.bytes);
+
+		return last_allocation;
+	}
+
+	void memory_arena_structure::deallocate(void* data, size_t)
+	{
+		// Only the last allocation can be given back (ex. a buffer freed right after its creation)
+		if (data != nullptr && data == last_allocation) {
+			offset = size_t(static_cast<char*>(data) - blocks.back().data);
+			last_allocation = nullptr;
+		}
+	}
+
+	void memory_arena_structure::reset()
+	{
+		// Several blocks were needed: replace them by a single one that can hold all of them for the next period
+		if (blocks.size() > 1) {
+			size_t const total = capacity();
+			release_blocks();
+			add_block(total);
+		}
+		offset = 0;
+		last_allocation = nullptr;
+
+		counters_previous = counters;
+		counters = counters_structure();
+	}
+
+	size_t memory_arena_structure::capacity() const
+	{
+		size_t total = 0;
+		for (block_structure const& block : blocks)
+			total += block.size;
+		return total;
+	}
+
+	void memory_arena_structure::add_block(size_t size)
+	{
+		char* data = static_cast<char*>(std::malloc(size));
+		if (data == nullptr)
+			throw std::bad_alloc();
+
+		blocks.push_back({ data, size });
+		offset = 0;
+
+		counters.heap_bytes += size;
+		counters.heap_allocations++;
+	}
+
+	void memory_arena_structure::release_blocks()
+	{
+		for (block_structure const& block : blocks)
+			std::free(block.data);
+		blocks.clear();
+		offset = 0;
+	}
+
+
+	memory_arena_structure& frame_arena()
+	{
+		static memory_arena_structure arena;
+		return arena;
+	}
+
+}
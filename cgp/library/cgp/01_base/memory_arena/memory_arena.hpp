@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace cgp
+{
+
+	/** Bump allocator for short-lived buffers
+	 * - allocate() takes the memory linearly in large blocks, without any call to the heap once a block is available.
+	 * - deallocate() only gives back the memory of the last allocation, the rest is released all at once by reset().
+	 * - reset() merges the blocks used since the previous reset in a single block large enough for all of them: once the
+	 *   usage is stable (ex. the same per-frame buffers at each frame), the arena doesn't allocate anything on the heap.
+	 * An arena is not thread-safe: it must only be used by one thread. */
+	struct memory_arena_structure
+	{
+		struct counters_structure
+		{
+			size_t bytes = 0;            // Memory taken from the arena (in Byte)
+			size_t allocations = 0;      // Number of allocations in the arena
+			size_t heap_bytes = 0;       // Memory of the blocks allocated on the heap by the arena (in Byte)
+			size_t heap_allocations = 0; // Number of blocks allocated on the heap by the arena
+		};
+
+		// Counters since the last reset, and counters of the period between the two previous resets (ex. the last frame)
+		counters_structure counters;
+		counters_structure counters_previous;
+		// Maximal memory taken from the arena between two resets
+		size_t peak_bytes = 0;
+
+		// Minimal size of a new block (in Byte)
+		size_t block_size_min = 64 * 1024;
+
+		memory_arena_structure() = default;
+		explicit memory_arena_structure(size_t initial_capacity);
+		~memory_arena_structure();
+
+		memory_arena_structure(memory_arena_structure const&) = delete;
+		memory_arena_structure& operator=(memory_arena_structure const&) = delete;
+
+		void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+		void deallocate(void* data, size_t size);
+
+		// Release all the allocations (the memory is kept for the next ones)
+		void reset();
+
+		// Total size of the blocks owned by the arena (in Byte)
+		size_t capacity() const;
+
+	private:
+		struct block_structure { char* data; size_t size; };
+
+		std::vector<block_structure> blocks; // the allocations are taken in blocks.back()
+		size_t offset = 0;                   // first free Byte in blocks.back()
+		void* last_allocation = nullptr;
+
+		void add_block(size_t size);
+		void release_blocks();
+	};
+
+	/** Arena of the buffers only used during the current frame
+	 *  Reset by the animation loop at the end of each frame - to be used by the render thread only. */
+	memory_arena_structure& frame_arena();
+
+
+	/** Standard allocator taking its memory in a memory_arena_structure (the frame arena by default)
+	 *  ex. std::vector<vec3, arena_allocator<vec3>> buffer; */
+	template <typename T>
+	struct arena_allocator
+	{
+		typedef T value_type;
+
+		memory_arena_structure* arena;
+
+		arena_allocator() : arena(&frame_arena()) {}
+		arena_allocator(memory_arena_structure& arena_arg) : arena(&arena_arg) {}
+		template <typename U> arena_allocator(arena_allocator<U> const& other) : arena(other.arena) {}
+
+		T* allocate(size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); }
+		void deallocate(T* data, size_t n) { arena->deallocate(data, n * sizeof(T)); }
+	};
+
+	template <typename T, typename U> bool operator==(arena_allocator<T> const& a, arena_allocator<U> const& b) { return a.arena == b.arena; }
+	template <typename T, typename U> bool operator!=(arena_allocator<T> const& a, arena_allocator<U> const& b) { return a.arena != b.arena; }
+
+}
@@ -2,3 +2,4 @@
 
 #include "numarray_stack/numarray_stack.hpp"
 #include "numarray/numarray.hpp"
+#include "numarray_arena/numarray_arena.hpp"
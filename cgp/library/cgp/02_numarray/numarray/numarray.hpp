@@ -1,6 +1,7 @@
 #pragma once
 
 #include "cgp/01_base/base.hpp"
+#include "numarray_expression.hpp"
 
 #include <vector>
 #include <iostream>
@@ -16,6 +17,7 @@ namespace cgp
  *
  * The numarray structure is a wrapper around an std::vector with additional convenient functionalities
  * - Overloaded operators + - * / as well as common outputs
+ *   (lazy(a) opts in for a whole expression evaluated in a single loop, see numarray_expression)
  * - Strict bound checking with operator [] and () (unless cgp_NO_DEBUG is defined)
  *
  * Numarray follows the main syntax than std::vector
@@ -25,6 +27,8 @@ namespace cgp
 template <typename T>
 struct numarray
 {
+    typedef T value_type;
+
     /** Internal data stored as std::vector */
     std::vector<T> data;
 
@@ -33,6 +37,10 @@ struct numarray
     numarray(int size);                     // numarray with a given size 
     numarray(std::initializer_list<T> arg); // Inline initialization using { } 
     numarray(std::vector<T> const& arg);    // Direct initialization from std::vector 
+    template <typename E> numarray(numarray_expression<E> const& expression); // Evaluation of a lazy expression (lazy(a)+b, ...)
+
+    /** Evaluate the expression in a single loop (without temporary numarray) */
+    template <typename E> numarray<T>& operator=(numarray_expression<E> const& expression);
 
     /** Similar to matlab linespace 
     * Linear interpolation between p1 and p2 along N variable */
@@ -120,10 +128,16 @@ template <typename T> T sum(numarray<T> const& a);
 template <typename T> numarray<T>  operator-(numarray<T> const& a);
 
 template <typename T> numarray<T>& operator+=(numarray<T>& a, numarray<T> const& b);
+template <typename T> numarray<T>& operator+=(numarray<T>& a, T const& b);
 template <typename T> numarray<T>  operator+(numarray<T> const& a, numarray<T> const& b);
+template <typename T> numarray<T>  operator+(numarray<T> const& a, T const& b);
+template <typename T> numarray<T>  operator+(T const& a, numarray<T> const& b);
 
 template <typename T> numarray<T>& operator-=(numarray<T>& a, numarray<T> const& b);
+template <typename T> numarray<T>& operator-=(numarray<T>& a, T const& b);
 template <typename T> numarray<T>  operator-(numarray<T> const& a, numarray<T> const& b);
+template <typename T> numarray<T>  operator-(numarray<T> const& a, T const& b);
+template <typename T> numarray<T>  operator-(T const& a, numarray<T> const& b);
 
 template <typename T> numarray<T>& operator*=(numarray<T>& a, numarray<T> const& b);
 template <typename T> numarray<T>  operator*(numarray<T> const& a, numarray<T> const& b);
@@ -147,6 +161,25 @@ template <typename T> numarray<T>  add(T const& a, numarray<T> const& b);
 template <typename T> numarray<T>  mul(T const& a, numarray<T> const& b);
 template <typename T> numarray<T>  div(T const& a, numarray<T> const& b);
 
+/** Lazy evaluation (opt-in, see numarray_expression)
+ * lazy(a) is an operand referring to the values of a: the operators involving it build an expression, evaluated in a
+ * single loop when assigned to a numarray or used in a compound assignment. Ex. c = lazy(a)*2.0f + b - c;
+ * The expression must be evaluated in the statement where it is built (don't store it with auto). */
+template <typename T> numarray_expression_leaf<T> lazy(numarray<T> const& a);
+
+template <typename T, typename E> numarray<T>& operator+=(numarray<T>& a, numarray_expression<E> const& b);
+template <typename T, typename E> numarray<T>& operator-=(numarray<T>& a, numarray_expression<E> const& b);
+template <typename T, typename E> numarray<T>& operator*=(numarray<T>& a, numarray_expression<E> const& b);
+template <typename T, typename E> numarray<T>& operator/=(numarray<T>& a, numarray_expression<E> const& b);
+
+// Functions on numarrays also applied to expressions (the expression is evaluated first)
+template <typename E> std::ostream& operator<<(std::ostream& s, numarray_expression<E> const& v);
+template <typename E> std::string str(numarray_expression<E> const& v, std::string const& separator=" ", std::string const& begin="", std::string const& end="");
+template <typename E> typename E::value_type max(numarray_expression<E> const& v);
+template <typename E> typename E::value_type min(numarray_expression<E> const& v);
+template <typename E> typename E::value_type average(numarray_expression<E> const& a);
+template <typename E> typename E::value_type sum(numarray_expression<E> const& a);
+
 }
 
 
@@ -178,6 +211,29 @@ numarray<T>::numarray(const std::vector<T>& arg)
     :data(arg)
 {}
 
+template <typename T>
+template <typename E>
+numarray<T>::numarray(numarray_expression<E> const& expression)
+    :data()
+{
+    *this = expression;
+}
+
+template <typename T>
+template <typename E>
+numarray<T>& numarray<T>::operator=(numarray_expression<E> const& expression)
+{
+    // The operands have the same size as the expression: if this numarray is one of them, it is not reallocated
+    E const& e = expression.self();
+    int const N = e.size();
+    data.resize(N);
+
+    T* values = data.data();
+    for (int k = 0; k < N; ++k)
+        values[k] = e.at(k);
+    return *this;
+}
+
 template <typename T>
 int numarray<T>::size() const
 {
@@ -456,148 +512,155 @@ template <typename T> T min(numarray<T> const& v)
 }
 
 
-template <typename T>
-numarray<T>& operator+=(numarray<T>& a, numarray<T> const& b)
+namespace detail
 {
+// Evaluation of an expression in a single loop: a[k] = op(a[k], b[k])
+template <typename C, typename E, typename Op>
+C& numarray_compound_assignment(C& a, numarray_expression<E> const& expression, Op)
+{
+    E const& b = expression.self();
     assert_cgp(a.size()>0 && b.size()>0, "Size must be >0");
     assert_cgp(a.size()==b.size(), "Size do not agree");
 
-    const int N = a.size();
+    int const N = a.size();
+    typename C::value_type* values = a.data.data();
     for(int k=0; k<N; ++k)
-        a[k] += b[k];
+        values[k] = Op::apply(values[k], b.at(k));
     return a;
 }
+}
 
+template <typename T> numarray_expression_leaf<T> lazy(numarray<T> const& a)
+{
+    return numarray_expression_leaf<T>(a);
+}
 
+template <typename T, typename E>
+numarray<T>& operator+=(numarray<T>& a, numarray_expression<E> const& b)
+{
+    return detail::numarray_compound_assignment(a, b, detail::numarray_op_add());
+}
+template <typename T, typename E>
+numarray<T>& operator-=(numarray<T>& a, numarray_expression<E> const& b)
+{
+    return detail::numarray_compound_assignment(a, b, detail::numarray_op_sub());
+}
+template <typename T, typename E>
+numarray<T>& operator*=(numarray<T>& a, numarray_expression<E> const& b)
+{
+    return detail::numarray_compound_assignment(a, b, detail::numarray_op_mul());
+}
+template <typename T, typename E>
+numarray<T>& operator/=(numarray<T>& a, numarray_expression<E> const& b)
+{
+    return detail::numarray_compound_assignment(a, b, detail::numarray_op_div());
+}
 
+
+// The operators evaluate a lazy expression: the result is computed in a single loop, without copy of the operands
+template <typename T>
+numarray<T>& operator+=(numarray<T>& a, numarray<T> const& b)
+{
+    return a += lazy(b);
+}
+template <typename T> numarray<T>& operator+=(numarray<T>& a, T const& b)
+{
+    int const N = a.size();
+    for(int k=0; k<N; ++k)
+        a.at(k) += b;
+    return a;
+}
 template <typename T>
 numarray<T>  operator+(numarray<T> const& a, numarray<T> const& b)
 {
-    numarray<T> res = a;
-    res += b;
-    return res;
+    return numarray<T>(lazy(a) + lazy(b));
 }
-
 template <typename T>
 numarray<T>  operator+(numarray<T> const& a, T const& b)
 {
-    numarray<T> res = a;
-    res += b;
-    return res;
+    return numarray<T>(lazy(a) + b);
 }
-
 template <typename T>
 numarray<T>  operator+(T const& a, numarray<T> const& b)
 {
-    int const N = b.size();
-    numarray<T> res(N);
-    for(int k=0; k<N; ++k)
-        res[k] = a+b[k];
-    return res;
+    return numarray<T>(a + lazy(b));
 }
 
 template <typename T> numarray<T>  operator-(numarray<T> const& a)
 {
-    int const N = a.size();
-    numarray<T> b(N);
-    for(int k=0; k<N; ++k)
-        b[k] = -a[k];
-    return b;
+    return numarray<T>(-lazy(a));
 }
 
 
 template <typename T> numarray<T>& operator-=(numarray<T>& a, numarray<T> const& b)
 {
-    assert_cgp(a.size()>0 && b.size()>0, "Size must be >0");
-    assert_cgp(a.size()==b.size(), "Size do not agree");
-
-    const int N = a.size();
+    return a -= lazy(b);
+}
+template <typename T> numarray<T>& operator-=(numarray<T>& a, T const& b)
+{
+    int const N = a.size();
     for(int k=0; k<N; ++k)
-        a[k] -= b[k];
+        a.at(k) -= b;
     return a;
 }
-
 template <typename T> numarray<T>  operator-(numarray<T> const& a, numarray<T> const& b)
 {
-    numarray<T> res = a;
-    res -= b;
-    return res;
+    return numarray<T>(lazy(a) - lazy(b));
+}
+template <typename T> numarray<T>  operator-(numarray<T> const& a, T const& b)
+{
+    return numarray<T>(lazy(a) - b);
+}
+template <typename T> numarray<T>  operator-(T const& a, numarray<T> const& b)
+{
+    return numarray<T>(a - lazy(b));
 }
 
 
 template <typename T> numarray<T>& operator*=(numarray<T>& a, numarray<T> const& b)
 {
-    assert_cgp(a.size()>0 && b.size()>0, "Size must be >0");
-    assert_cgp(a.size()==b.size(), "Size do not agree");
-
-    const int N = a.size();
-    for(int k=0; k<N; ++k)
-        a[k] *= b[k];
-    return a;
+    return a *= lazy(b);
 }
 template <typename T> numarray<T>  operator*(numarray<T> const& a, numarray<T> const& b)
 {
-    numarray<T> res = a;
-    res *= b;
-    return res;
+    return numarray<T>(lazy(a) * lazy(b));
 }
 
-
-
-
 template <typename T> numarray<T>& operator*=(numarray<T>& a, float b)
 {
     int const N = a.size();
     for(int k=0; k<N; ++k)
-        a[k] *= b;
+        a.at(k) *= b;
     return a;
 }
 template <typename T> numarray<T>  operator*(numarray<T> const& a, float b)
 {
-    int const N = a.size();
-    numarray<T> res(N);
-    for(int k=0; k<N; ++k)
-        res[k] = a[k]*b;
-    return res;
+    return numarray<T>(lazy(a) * b);
 }
 template <typename T> numarray<T>  operator*(float a, numarray<T> const& b)
 {
-    int const N = b.size();
-    numarray<T> res(N);
-    for(int k=0; k<N; ++k)
-        res[k] = a*b[k];
-    return res;
+    return numarray<T>(a * lazy(b));
 }
 
 template <typename T> numarray<T>& operator/=(numarray<T>& a, numarray<T> const& b)
 {
-    assert_cgp(a.size()>0 && b.size()>0, "Size must be >0");
-    assert_cgp(a.size()==b.size(), "Size do not agree");
-
-    const int N = a.size();
-    for(int k=0; k<N; ++k)
-        a[k] /= b[k];
-    return a;
+    return a /= lazy(b);
 }
 template <typename T> numarray<T>& operator/=(numarray<T>& a, float b)
 {
     assert_cgp(a.size()>0, "Size must be >0");
     const int N = a.size();
     for(int k=0; k<N; ++k)
-        a[k] /= b;
+        a.at(k) /= b;
     return a;
 }
 template <typename T> numarray<T>  operator/(numarray<T> const& a, numarray<T> const& b)
 {
-    numarray<T> res = a;
-    res /= b;
-    return res;
+    return numarray<T>(lazy(a) / lazy(b));
 }
 template <typename T> numarray<T>  operator/(numarray<T> const& a, float b)
 {
-    numarray<T> res = a;
-    res /= b;
-    return res;
+    return numarray<T>(lazy(a) / b);
 }
 
 
@@ -644,101 +707,62 @@ template <typename T> auto const* ptr(numarray<T> const& v)
 
 template <typename T> numarray<T> sub(numarray<T> const& a, T const& b)
 {
-    int N= a.size();
-    numarray<T> res;
-    res.resize(N);
-
-    for(int k=0; k<N; ++k){
-        res[k] = a[k]-b;
-    }
-
-    return res;
+    return numarray<T>(lazy(a) - b);
 }
 template <typename T> numarray<T> add(numarray<T> const& a, T const& b)
 {
-    int N= a.size();
-    numarray<T> res;
-    res.resize(N);
-
-    for(int k=0; k<N; ++k){
-        res[k] = a[k]+b;
-    }
-
-    return res;
+    return numarray<T>(lazy(a) + b);
 }
 template <typename T> numarray<T> mul(numarray<T> const& a, T const& b)
 {
-    int N= a.size();
-    numarray<T> res;
-    res.resize(N);
-
-    for(int k=0; k<N; ++k){
-        res[k] = a[k]*b;
-    }
-
-    return res;
+    return numarray<T>(numarray_expression_scalar_right<numarray<T>, T, detail::numarray_op_mul>(a, b));
 }
 template <typename T> numarray<T> div(numarray<T> const& a, T const& b)
 {
-    int N= a.size();
-    numarray<T> res;
-    res.resize(N);
-
-    for(int k=0; k<N; ++k){
-        res[k] = a[k]/b;
-    }
-
-    return res;
+    return numarray<T>(numarray_expression_scalar_right<numarray<T>, T, detail::numarray_op_div>(a, b));
 }
 
 template <typename T> numarray<T>  sub(T const& a, numarray<T> const& b)
 {
-    int N= a.size();
-    numarray<T> res;
-    res.resize(N);
-
-    for(int k=0; k<N; ++k){
-        res[k] = a-b[k];
-    }
-
-    return res;
+    return numarray<T>(a - lazy(b));
 }
 template <typename T> numarray<T>  add(T const& a, numarray<T> const& b)
 {
-    int N= a.size();
-    numarray<T> res;
-    res.resize(N);
-
-    for(int k=0; k<N; ++k){
-        res[k] = a+b[k];
-    }
-
-    return res;
+    return numarray<T>(a + lazy(b));
 }
 template <typename T> numarray<T>  mul(T const& a, numarray<T> const& b)
 {
-    int N= a.size();
-    numarray<T> res;
-    res.resize(N);
-
-    for(int k=0; k<N; ++k){
-        res[k] = a*b[k];
-    }
-
-    return res;
+    return numarray<T>(numarray_expression_scalar_left<numarray<T>, T, detail::numarray_op_mul>(a, b));
 }
 template <typename T> numarray<T>  div(T const& a, numarray<T> const& b)
 {
-    int N= a.size();
-    numarray<T> res;
-    res.resize(N);
+    return numarray<T>(numarray_expression_scalar_left<numarray<T>, T, detail::numarray_op_div>(a, b));
+}
 
-    for(int k=0; k<N; ++k){
-        res[k] = a/b[k];
-    }
 
-    return res;
+template <typename E> std::ostream& operator<<(std::ostream& s, numarray_expression<E> const& v)
+{
+    return s << eval(v);
+}
+template <typename E> std::string str(numarray_expression<E> const& v, std::string const& separator, std::string const& begin, std::string const& end)
+{
+    return str(eval(v), separator, begin, end);
+}
+template <typename E> typename E::value_type max(numarray_expression<E> const& v)
+{
+    return max(eval(v));
+}
+template <typename E> typename E::value_type min(numarray_expression<E> const& v)
+{
+    return min(eval(v));
+}
+template <typename E> typename E::value_type average(numarray_expression<E> const& a)
+{
+    return average(eval(a));
+}
+template <typename E> typename E::value_type sum(numarray_expression<E> const& a)
+{
+    return sum(eval(a));
 }
-
 
 }
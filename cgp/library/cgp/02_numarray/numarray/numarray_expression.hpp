@@ -0,0 +1,241 @@
+#pragma once
+
+#include "cgp/01_base/base.hpp"
+
+#include <type_traits>
+
+/* ************************************************** */
+/*           Header                                   */
+/* ************************************************** */
+
+namespace cgp
+{
+
+template <typename T> struct numarray;
+
+/** Lazy arithmetic expression on numarrays (expression templates) - opt-in
+ *
+ * The math operators on numarray (a+b, a*2.0f, -a, add(a,b), ...) return a new numarray. Wrapping an operand with
+ * lazy() builds an expression instead: the operators involving it return a lightweight node describing the operation,
+ * and a whole expression such as
+ *   c = lazy(a)*2.0f + b - c;
+ * is only evaluated when it is assigned to a numarray (assignment, construction, +=, ...), in a single loop over the
+ * elements and without any temporary numarray.
+ *
+ * The nodes refer to the numarrays used as operands (they are not copied): an expression must be evaluated in the
+ * statement where it is built. Don't store it using auto, convert it to a numarray (or use eval()) instead.
+ **/
+template <typename E>
+struct numarray_expression
+{
+    E const& self() const { return static_cast<E const&>(*this); }
+};
+
+/** Operand of an expression referring to the contiguous values of a numarray (or numarray_arena) - built by lazy() */
+template <typename T>
+struct numarray_expression_leaf : numarray_expression<numarray_expression_leaf<T>>
+{
+    typedef T value_type;
+
+    T const* values;
+    int N;
+
+    template <typename C> explicit numarray_expression_leaf(C const& a) : values(a.data.data()), N(a.size()) {}
+
+    int size() const { return N; }
+    T const& at(int index) const { return values[index]; }
+};
+
+namespace detail
+{
+    // Numarrays are stored as leaves in the expression nodes, sub-expressions are stored by value
+    template <typename E> struct numarray_expression_operand { typedef E type; };
+    template <typename T> struct numarray_expression_operand<numarray<T>> { typedef numarray_expression_leaf<T> type; };
+
+    // Types accepted by the lazy operators: the expressions, and the containers that can be mixed with them (lazy(a)+b)
+    template <typename E> struct is_numarray_expression : std::false_type {};
+    template <typename E> struct is_numarray_operand : is_numarray_expression<E> {};
+    template <typename T> struct is_numarray_operand<numarray<T>> : std::true_type {};
+
+    // At least one operand is an expression: operations between plain numarrays are not lazy
+    template <typename A, typename B> struct enable_if_numarray_lazy_binary
+        : std::enable_if<is_numarray_operand<A>::value && is_numarray_operand<B>::value && (is_numarray_expression<A>::value || is_numarray_expression<B>::value)> {};
+    template <typename A> struct enable_if_numarray_lazy : std::enable_if<is_numarray_expression<A>::value> {};
+
+    struct numarray_op_add { template <typename A, typename B> static auto apply(A const& a, B const& b) -> decltype(a+b) { return a+b; } };
+    struct numarray_op_sub { template <typename A, typename B> static auto apply(A const& a, B const& b) -> decltype(a-b) { return a-b; } };
+    struct numarray_op_mul { template <typename A, typename B> static auto apply(A const& a, B const& b) -> decltype(a*b) { return a*b; } };
+    struct numarray_op_div { template <typename A, typename B> static auto apply(A const& a, B const& b) -> decltype(a/b) { return a/b; } };
+}
+
+/** Element-wise operation between two operands of the same size: op(a[k], b[k]) */
+template <typename A, typename B, typename Op>
+struct numarray_expression_binary : numarray_expression<numarray_expression_binary<A, B, Op>>
+{
+    typedef typename A::value_type value_type;
+
+    typename detail::numarray_expression_operand<A>::type a;
+    typename detail::numarray_expression_operand<B>::type b;
+
+    numarray_expression_binary(A const& a_arg, B const& b_arg);
+
+    int size() const { return a.size(); }
+    value_type at(int index) const { return Op::apply(a.at(index), b.at(index)); }
+};
+
+/** Operation between each element of an expression and a scalar value: op(a[k], s) */
+template <typename A, typename S, typename Op>
+struct numarray_expression_scalar_right : numarray_expression<numarray_expression_scalar_right<A, S, Op>>
+{
+    typedef typename A::value_type value_type;
+
+    typename detail::numarray_expression_operand<A>::type a;
+    S s;
+
+    numarray_expression_scalar_right(A const& a_arg, S const& s_arg) : a(a_arg), s(s_arg) {}
+
+    int size() const { return a.size(); }
+    value_type at(int index) const { return Op::apply(a.at(index), s); }
+};
+
+/** Operation between a scalar value and each element of an expression: op(s, a[k]) */
+template <typename A, typename S, typename Op>
+struct numarray_expression_scalar_left : numarray_expression<numarray_expression_scalar_left<A, S, Op>>
+{
+    typedef typename A::value_type value_type;
+
+    typename detail::numarray_expression_operand<A>::type a;
+    S s;
+
+    numarray_expression_scalar_left(S const& s_arg, A const& a_arg) : a(a_arg), s(s_arg) {}
+
+    int size() const { return a.size(); }
+    value_type at(int index) const { return Op::apply(s, a.at(index)); }
+};
+
+/** Opposite of each element: -a[k] */
+template <typename A>
+struct numarray_expression_negate : numarray_expression<numarray_expression_negate<A>>
+{
+    typedef typename A::value_type value_type;
+
+    typename detail::numarray_expression_operand<A>::type a;
+
+    numarray_expression_negate(A const& a_arg) : a(a_arg) {}
+
+    int size() const { return a.size(); }
+    value_type at(int index) const { return -a.at(index); }
+};
+
+namespace detail
+{
+    template <typename T> struct is_numarray_expression<numarray_expression_leaf<T>> : std::true_type {};
+    template <typename A, typename B, typename Op> struct is_numarray_expression<numarray_expression_binary<A, B, Op>> : std::true_type {};
+    template <typename A, typename S, typename Op> struct is_numarray_expression<numarray_expression_scalar_right<A, S, Op>> : std::true_type {};
+    template <typename A, typename S, typename Op> struct is_numarray_expression<numarray_expression_scalar_left<A, S, Op>> : std::true_type {};
+    template <typename A> struct is_numarray_expression<numarray_expression_negate<A>> : std::true_type {};
+}
+
+/** Lazy operators: at least one of the operands is an expression (ex. lazy(a)+b, -lazy(a), 2.0f*lazy(a))
+ * The numarrays used as operands must have the same size. */
+template <typename A, typename = typename detail::enable_if_numarray_lazy<A>::type> numarray_expression_negate<A> operator-(A const& a);
+
+template <typename A, typename B, typename = typename detail::enable_if_numarray_lazy_binary<A, B>::type> numarray_expression_binary<A, B, detail::numarray_op_add> operator+(A const& a, B const& b);
+template <typename A, typename = typename detail::enable_if_numarray_lazy<A>::type> numarray_expression_scalar_right<A, typename A::value_type, detail::numarray_op_add> operator+(A const& a, typename A::value_type const& b);
+template <typename A, typename = typename detail::enable_if_numarray_lazy<A>::type> numarray_expression_scalar_left<A, typename A::value_type, detail::numarray_op_add>  operator+(typename A::value_type const& a, A const& b);
+
+template <typename A, typename B, typename = typename detail::enable_if_numarray_lazy_binary<A, B>::type> numarray_expression_binary<A, B, detail::numarray_op_sub> operator-(A const& a, B const& b);
+template <typename A, typename = typename detail::enable_if_numarray_lazy<A>::type> numarray_expression_scalar_right<A, typename A::value_type, detail::numarray_op_sub> operator-(A const& a, typename A::value_type const& b);
+template <typename A, typename = typename detail::enable_if_numarray_lazy<A>::type> numarray_expression_scalar_left<A, typename A::value_type, detail::numarray_op_sub>  operator-(typename A::value_type const& a, A const& b);
+
+template <typename A, typename B, typename = typename detail::enable_if_numarray_lazy_binary<A, B>::type> numarray_expression_binary<A, B, detail::numarray_op_mul> operator*(A const& a, B const& b);
+template <typename A, typename = typename detail::enable_if_numarray_lazy<A>::type> numarray_expression_scalar_right<A, float, detail::numarray_op_mul> operator*(A const& a, float b);
+template <typename A, typename = typename detail::enable_if_numarray_lazy<A>::type> numarray_expression_scalar_left<A, float, detail::numarray_op_mul>  operator*(float a, A const& b);
+
+template <typename A, typename B, typename = typename detail::enable_if_numarray_lazy_binary<A, B>::type> numarray_expression_binary<A, B, detail::numarray_op_div> operator/(A const& a, B const& b);
+template <typename A, typename = typename detail::enable_if_numarray_lazy<A>::type> numarray_expression_scalar_right<A, float, detail::numarray_op_div> operator/(A const& a, float b);
+
+/** Explicit evaluation of an expression into a new numarray */
+template <typename E> numarray<typename E::value_type> eval(numarray_expression<E> const& expression);
+
+}
+
+
+
+/* ************************************************** */
+/*           IMPLEMENTATION                           */
+/* ************************************************** */
+
+namespace cgp
+{
+
+template <typename A, typename B, typename Op>
+numarray_expression_binary<A, B, Op>::numarray_expression_binary(A const& a_arg, B const& b_arg)
+    :a(a_arg), b(b_arg)
+{
+    assert_cgp(a.size()>0 && b.size()>0, "Size must be >0");
+    assert_cgp(a.size()==b.size(), "Size do not agree");
+}
+
+
+template <typename A, typename> numarray_expression_negate<A> operator-(A const& a)
+{
+    return numarray_expression_negate<A>(a);
+}
+
+template <typename A, typename B, typename> numarray_expression_binary<A, B, detail::numarray_op_add> operator+(A const& a, B const& b)
+{
+    return numarray_expression_binary<A, B, detail::numarray_op_add>(a, b);
+}
+template <typename A, typename> numarray_expression_scalar_right<A, typename A::value_type, detail::numarray_op_add> operator+(A const& a, typename A::value_type const& b)
+{
+    return numarray_expression_scalar_right<A, typename A::value_type, detail::numarray_op_add>(a, b);
+}
+template <typename A, typename> numarray_expression_scalar_left<A, typename A::value_type, detail::numarray_op_add> operator+(typename A::value_type const& a, A const& b)
+{
+    return numarray_expression_scalar_left<A, typename A::value_type, detail::numarray_op_add>(a, b);
+}
+
+template <typename A, typename B, typename> numarray_expression_binary<A, B, detail::numarray_op_sub> operator-(A const& a, B const& b)
+{
+    return numarray_expression_binary<A, B, detail::numarray_op_sub>(a, b);
+}
+template <typename A, typename> numarray_expression_scalar_right<A, typename A::value_type, detail::numarray_op_sub> operator-(A const& a, typename A::value_type const& b)
+{
+    return numarray_expression_scalar_right<A, typename A::value_type, detail::numarray_op_sub>(a, b);
+}
+template <typename A, typename> numarray_expression_scalar_left<A, typename A::value_type, detail::numarray_op_sub> operator-(typename A::value_type const& a, A const& b)
+{
+    return numarray_expression_scalar_left<A, typename A::value_type, detail::numarray_op_sub>(a, b);
+}
+
+template <typename A, typename B, typename> numarray_expression_binary<A, B, detail::numarray_op_mul> operator*(A const& a, B const& b)
+{
+    return numarray_expression_binary<A, B, detail::numarray_op_mul>(a, b);
+}
+template <typename A, typename> numarray_expression_scalar_right<A, float, detail::numarray_op_mul> operator*(A const& a, float b)
+{
+    return numarray_expression_scalar_right<A, float, detail::numarray_op_mul>(a, b);
+}
+template <typename A, typename> numarray_expression_scalar_left<A, float, detail::numarray_op_mul> operator*(float a, A const& b)
+{
+    return numarray_expression_scalar_left<A, float, detail::numarray_op_mul>(a, b);
+}
+
+template <typename A, typename B, typename> numarray_expression_binary<A, B, detail::numarray_op_div> operator/(A const& a, B const& b)
+{
+    return numarray_expression_binary<A, B, detail::numarray_op_div>(a, b);
+}
+template <typename A, typename> numarray_expression_scalar_right<A, float, detail::numarray_op_div> operator/(A const& a, float b)
+{
+    assert_cgp(a.size()>0, "Size must be >0");
+    return numarray_expression_scalar_right<A, float, detail::numarray_op_div>(a, b);
+}
+
+
+template <typename E> numarray<typename E::value_type> eval(numarray_expression<E> const& expression)
+{
+    return numarray<typename E::value_type>(expression);
+}
+
+}
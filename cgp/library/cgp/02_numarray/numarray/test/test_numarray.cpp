@@ -114,5 +114,42 @@ namespace cgp_test
 			assert_cgp_no_msg(cgp::is_equal(sum(a),  4.5f+8.2f+6.1f-3.6));
 		}
 
+
+		// test operators (a new numarray is returned)
+		{
+			cgp::numarray<float> a = { 1.0f, 2.0f, 3.0f };
+			cgp::numarray<float> b = { 4.0f, 5.0f, 6.0f };
+			cgp::numarray<float> c = { 7.0f, 8.0f, 9.0f };
+			static_assert(std::is_same<decltype(a + b), cgp::numarray<float>>::value, "numarray operators must return a numarray");
+			static_assert(std::is_same<decltype(add(a, 1.0f)), cgp::numarray<float>>::value, "numarray operators must return a numarray");
+			auto s = a + b; // safe to store: doesn't refer to a or b
+			assert_cgp_no_msg(is_equal(s, { 5.0f, 7.0f, 9.0f }));
+			c = a * 2.0f + b - c;
+			assert_cgp_no_msg(is_equal(c, { -1.0f, 1.0f, 3.0f }));
+			c += a * b;
+			assert_cgp_no_msg(is_equal(c, { 3.0f, 11.0f, 21.0f }));
+			cgp::numarray<float> d = -(c - 1.0f) / 2.0f;
+			assert_cgp_no_msg(is_equal(d, { -1.0f, -5.0f, -10.0f }));
+			assert_cgp_no_msg(cgp::is_equal(sum(a + b), 21.0f));
+
+			cgp::numarray<int> e = { 1,2,3 };
+			e = 2 + e * e;
+			assert_cgp_no_msg(is_equal(e, { 3,6,11 }));
+		}
+
+		// test lazy expressions (evaluated in a single loop)
+		{
+			cgp::numarray<float> a = { 1.0f, 2.0f, 3.0f };
+			cgp::numarray<float> b = { 4.0f, 5.0f, 6.0f };
+			cgp::numarray<float> c = { 7.0f, 8.0f, 9.0f };
+			c = lazy(a) * 2.0f + b - c;
+			assert_cgp_no_msg(is_equal(c, { -1.0f, 1.0f, 3.0f }));
+			c += lazy(a) * b;
+			assert_cgp_no_msg(is_equal(c, { 3.0f, 11.0f, 21.0f }));
+			cgp::numarray<float> d = -(lazy(c) - 1.0f) / 2.0f;
+			assert_cgp_no_msg(is_equal(d, { -1.0f, -5.0f, -10.0f }));
+			assert_cgp_no_msg(cgp::is_equal(sum(a + lazy(b)), 21.0f));
+			assert_cgp_no_msg(is_equal(eval(2.0f * lazy(a)), a + a));
+		}
 	}
 }
\ No newline at end of file
@@ -0,0 +1,279 @@
+#pragma once
+
+#include "cgp/01_base/base.hpp"
+#include "cgp/02_numarray/numarray/numarray.hpp"
+
+#include <algorithm>
+#include <vector>
+
+/* ************************************************** */
+/*           Header                                   */
+/* ************************************************** */
+
+namespace cgp
+{
+
+/** Numarray whose elements are stored in a memory arena (the frame arena by default)
+ *
+ * Same use as a numarray for short-lived buffers (ex. data recomputed at each frame): the allocations don't call the
+ * heap, and all the memory is released at once when the arena is reset (at the end of the frame for the frame arena).
+ * A numarray_arena must therefore not be used after the reset of its arena - copy it in a numarray to keep its values.
+ *
+ * numarray_arena can be used in lazy numarray expressions: numarray_arena<vec3> p = lazy(a)*2.0f + b; numarray<vec3> q = lazy(p) - a;
+ **/
+template <typename T>
+struct numarray_arena
+{
+    typedef T value_type;
+
+    /** Internal data stored as std::vector using the arena */
+    std::vector<T, arena_allocator<T>> data;
+
+    // Constructors
+    numarray_arena();                                                    // Empty, in the frame arena
+    explicit numarray_arena(memory_arena_structure& arena);              // Empty, in a given arena
+    explicit numarray_arena(int size, memory_arena_structure& arena = frame_arena());
+    template <typename E> numarray_arena(numarray_expression<E> const& expression, memory_arena_structure& arena = frame_arena());
+
+    numarray_arena(numarray_arena<T> const& other);
+    numarray_arena(numarray_arena<T>&&) = default;
+    numarray_arena<T>& operator=(numarray_arena<T> const& other);
+    numarray_arena<T>& operator=(numarray_arena<T>&&) = default;
+
+    /** Evaluate the expression in a single loop (without temporary numarray) */
+    template <typename E> numarray_arena<T>& operator=(numarray_expression<E> const& expression);
+
+    int size() const;
+    numarray_arena<T>& resize(int size);
+    numarray_arena<T>& reserve(int size);
+    numarray_arena<T>& push_back(T const& value);
+    numarray_arena<T>& clear();
+    numarray_arena<T>& fill(T const& value);
+
+    /** Element access (bound checking similar to numarray) */
+    T const& operator[](int index) const;
+    T& operator[](int index);
+    T const& operator()(int index) const;
+    T& operator()(int index);
+
+    /** Direct access to the value - doesn't check index bounds*/
+    inline T const& at(int index) const { return data[index]; }
+    inline T& at(int index)             { return data[index]; }
+
+    typename std::vector<T, arena_allocator<T>>::iterator begin() { return data.begin(); }
+    typename std::vector<T, arena_allocator<T>>::iterator end() { return data.end(); }
+    typename std::vector<T, arena_allocator<T>>::const_iterator begin() const { return data.begin(); }
+    typename std::vector<T, arena_allocator<T>>::const_iterator end() const { return data.end(); }
+};
+
+template <typename T> std::string type_str(numarray_arena<T> const&);
+
+template <typename T, typename E> numarray_arena<T>& operator+=(numarray_arena<T>& a, numarray_expression<E> const& b);
+template <typename T, typename E> numarray_arena<T>& operator-=(numarray_arena<T>& a, numarray_expression<E> const& b);
+template <typename T, typename E> numarray_arena<T>& operator*=(numarray_arena<T>& a, numarray_expression<E> const& b);
+template <typename T, typename E> numarray_arena<T>& operator/=(numarray_arena<T>& a, numarray_expression<E> const& b);
+template <typename T> numarray_arena<T>& operator+=(numarray_arena<T>& a, numarray_arena<T> const& b);
+template <typename T> numarray_arena<T>& operator-=(numarray_arena<T>& a, numarray_arena<T> const& b);
+template <typename T> numarray_arena<T>& operator*=(numarray_arena<T>& a, numarray_arena<T> const& b);
+template <typename T> numarray_arena<T>& operator/=(numarray_arena<T>& a, numarray_arena<T> const& b);
+template <typename T> numarray_arena<T>& operator*=(numarray_arena<T>& a, float b);
+template <typename T> numarray_arena<T>& operator/=(numarray_arena<T>& a, float b);
+
+// Operand of a lazy expression referring to the values of a (see numarray_expression)
+template <typename T> numarray_expression_leaf<T> lazy(numarray_arena<T> const& a);
+
+namespace detail
+{
+    template <typename T> struct numarray_expression_operand<numarray_arena<T>> { typedef numarray_expression_leaf<T> type; };
+    template <typename T> struct is_numarray_operand<numarray_arena<T>> : std::true_type {};
+}
+
+}
+
+
+
+/* ************************************************** */
+/*           IMPLEMENTATION                           */
+/* ************************************************** */
+
+namespace cgp
+{
+
+template <typename T>
+numarray_arena<T>::numarray_arena()
+    :data(arena_allocator<T>(frame_arena()))
+{}
+
+template <typename T>
+numarray_arena<T>::numarray_arena(memory_arena_structure& arena)
+    :data(arena_allocator<T>(arena))
+{}
+
+template <typename T>
+numarray_arena<T>::numarray_arena(int size, memory_arena_structure& arena)
+    :data(size, T(), arena_allocator<T>(arena))
+{}
+
+template <typename T>
+template <typename E>
+numarray_arena<T>::numarray_arena(numarray_expression<E> const& expression, memory_arena_structure& arena)
+    :data(arena_allocator<T>(arena))
+{
+    *this = expression;
+}
+
+// The copies use the same arena as their source
+template <typename T>
+numarray_arena<T>::numarray_arena(numarray_arena<T> const& other)
+    :data(other.data, other.data.get_allocator())
+{}
+
+template <typename T>
+numarray_arena<T>& numarray_arena<T>::operator=(numarray_arena<T> const& other)
+{
+    data.assign(other.data.begin(), other.data.end());
+    return *this;
+}
+
+template <typename T>
+template <typename E>
+numarray_arena<T>& numarray_arena<T>::operator=(numarray_expression<E> const& expression)
+{
+    E const& e = expression.self();
+    int const N = e.size();
+    data.resize(N);
+
+    T* values = data.data();
+    for (int k = 0; k < N; ++k)
+        values[k] = e.at(k);
+    return *this;
+}
+
+template <typename T>
+int numarray_arena<T>::size() const
+{
+    return int(data.size());
+}
+
+template <typename T>
+numarray_arena<T>& numarray_arena<T>::resize(int size)
+{
+    assert_cgp_no_msg(size>=0);
+    data.resize(size);
+    return *this;
+}
+
+template <typename T>
+numarray_arena<T>& numarray_arena<T>::reserve(int size)
+{
+    assert_cgp_no_msg(size>=0);
+    data.reserve(size);
+    return *this;
+}
+
+template <typename T>
+numarray_arena<T>& numarray_arena<T>::push_back(T const& value)
+{
+    data.push_back(value);
+    return *this;
+}
+
+template <typename T>
+numarray_arena<T>& numarray_arena<T>::clear()
+{
+    data.clear();
+    return *this;
+}
+
+template <typename T>
+numarray_arena<T>& numarray_arena<T>::fill(T const& value)
+{
+    std::fill(data.begin(), data.end(), value);
+    return *this;
+}
+
+template <typename T>
+T const& numarray_arena<T>::operator[](int index) const
+{
+    assert_cgp(index>=0 && index<size(), "Try to access numarray_arena["+str(index)+"] for a size="+str(size()));
+    return data[index];
+}
+
+template <typename T>
+T& numarray_arena<T>::operator[](int index)
+{
+    assert_cgp(index>=0 && index<size(), "Try to access numarray_arena["+str(index)+"] for a size="+str(size()));
+    return data[index];
+}
+
+template <typename T>
+T const& numarray_arena<T>::operator()(int index) const
+{
+    return (*this)[index];
+}
+
+template <typename T>
+T& numarray_arena<T>::operator()(int index)
+{
+    return (*this)[index];
+}
+
+template <typename T> std::string type_str(numarray_arena<T> const&)
+{
+    using cgp::type_str;
+    return "numarray_arena<" + type_str(T()) + ">";
+}
+
+template <typename T, typename E> numarray_arena<T>& operator+=(numarray_arena<T>& a, numarray_expression<E> const& b)
+{
+    return detail::numarray_compound_assignment(a, b, detail::numarray_op_add());
+}
+template <typename T, typename E> numarray_arena<T>& operator-=(numarray_arena<T>& a, numarray_expression<E> const& b)
+{
+    return detail::numarray_compound_assignment(a, b, detail::numarray_op_sub());
+}
+template <typename T, typename E> numarray_arena<T>& operator*=(numarray_arena<T>& a, numarray_expression<E> const& b)
+{
+    return detail::numarray_compound_assignment(a, b, detail::numarray_op_mul());
+}
+template <typename T, typename E> numarray_arena<T>& operator/=(numarray_arena<T>& a, numarray_expression<E> const& b)
+{
+    return detail::numarray_compound_assignment(a, b, detail::numarray_op_div());
+}
+template <typename T> numarray_arena<T>& operator+=(numarray_arena<T>& a, numarray_arena<T> const& b)
+{
+    return a += lazy(b);
+}
+template <typename T> numarray_arena<T>& operator-=(numarray_arena<T>& a, numarray_arena<T> const& b)
+{
+    return a -= lazy(b);
+}
+template <typename T> numarray_arena<T>& operator*=(numarray_arena<T>& a, numarray_arena<T> const& b)
+{
+    return a *= lazy(b);
+}
+template <typename T> numarray_arena<T>& operator/=(numarray_arena<T>& a, numarray_arena<T> const& b)
+{
+    return a /= lazy(b);
+}
+template <typename T> numarray_arena<T>& operator*=(numarray_arena<T>& a, float b)
+{
+    int const N = a.size();
+    for(int k=0; k<N; ++k)
+        a.at(k) *= b;
+    return a;
+}
+template <typename T> numarray_arena<T>& operator/=(numarray_arena<T>& a, float b)
+{
+    int const N = a.size();
+    for(int k=0; k<N; ++k)
+        a.at(k) /= b;
+    return a;
+}
+
+template <typename T> numarray_expression_leaf<T> lazy(numarray_arena<T> const& a)
+{
+    return numarray_expression_leaf<T>(a);
+}
+
+}
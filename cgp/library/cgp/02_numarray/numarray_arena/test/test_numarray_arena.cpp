@@ -0,0 +1,47 @@
+#include "cgp/02_numarray/numarray.hpp"
+
+#if defined(__linux__) || defined(__EMSCRIPTEN__)
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#endif
+
+namespace cgp_test
+{
+
+	void test_numarray_arena()
+	{
+		{
+			cgp::memory_arena_structure arena;
+			cgp::numarray_arena<int> a(arena);
+			for (int k = 0; k < 1000; ++k)
+				a.push_back(k);
+			assert_cgp_no_msg(a.size() == 1000);
+			assert_cgp_no_msg(a[0] == 0 && a[999] == 999);
+			assert_cgp_no_msg(arena.counters.allocations > 0);
+			assert_cgp_no_msg(arena.counters.heap_allocations == 1);
+		}
+
+		// Once the arena is large enough, the same allocations don't use the heap anymore
+		{
+			cgp::memory_arena_structure arena;
+			arena.block_size_min = 1024;
+			for (int frame = 0; frame < 3; ++frame) {
+				cgp::numarray_arena<float> a(1000, arena);
+				cgp::numarray_arena<float> b(3000, arena);
+				arena.reset();
+			}
+			assert_cgp_no_msg(arena.counters_previous.allocations == 2);
+			assert_cgp_no_msg(arena.counters_previous.heap_allocations == 0);
+			assert_cgp_no_msg(arena.capacity() >= 4000 * sizeof(float));
+		}
+
+		// Expressions
+		{
+			cgp::memory_arena_structure arena;
+			cgp::numarray<float> a = { 1.0f, 2.0f, 3.0f };
+			cgp::numarray_arena<float> b(lazy(a) * 2.0f, arena);
+			b += lazy(a);
+			cgp::numarray<float> c = lazy(b) - a;
+			assert_cgp_no_msg(is_equal(c, { 2.0f, 4.0f, 6.0f }));
+		}
+	}
+}
@@ -2,10 +2,22 @@
 
 #include "cgp/01_base/base.hpp"
 
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <sys/stat.h>
 
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__) || defined(__APPLE__)
+#define CGP_FILE_MMAP
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #if defined(__linux__) || defined(__EMSCRIPTEN__)
 #pragma GCC diagnostic ignored "-Wunused-variable"
 #endif
@@ -91,4 +103,95 @@ namespace cgp
 
         return buffer;
     }
-}
\ No newline at end of file
+
+    void file_mapping_structure::open(std::string const& filename)
+    {
+        close();
+        size = file_get_size(filename);
+        if (size == 0)
+            return;
+
+#if defined(_WIN32)
+        HANDLE const file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        assert_cgp(file != INVALID_HANDLE_VALUE, "Cannot open file " + filename);
+        HANDLE const mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        assert_cgp(mapping != NULL, "Cannot map file " + filename);
+        void const* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        assert_cgp(view != NULL, "Cannot map file " + filename);
+
+        handle_file = file;
+        handle_mapping = mapping;
+        data = static_cast<char const*>(view);
+#elif defined(CGP_FILE_MMAP)
+        int const fd = ::open(filename.c_str(), O_RDONLY);
+        assert_cgp(fd >= 0, "Cannot open file " + filename);
+        void* const view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // the mapping stays valid after closing the descriptor
+        assert_cgp(view != MAP_FAILED, "Cannot map file " + filename);
+#ifdef MADV_SEQUENTIAL
+        madvise(view, size, MADV_SEQUENTIAL);
+#endif
+
+        handle_mapping = view;
+        data = static_cast<char const*>(view);
+#else
+        buffer = read_from_file_binary(filename);
+        data = buffer.data();
+#endif
+    }
+
+    void file_mapping_structure::close()
+    {
+#if defined(_WIN32)
+        if (data != nullptr && handle_mapping != nullptr) {
+            UnmapViewOfFile(data);
+            CloseHandle(static_cast<HANDLE>(handle_mapping));
+            CloseHandle(static_cast<HANDLE>(handle_file));
+        }
+#elif defined(CGP_FILE_MMAP)
+        if (handle_mapping != nullptr)
+            munmap(handle_mapping, size);
+#endif
+        buffer.clear();
+        handle_file = nullptr;
+        handle_mapping = nullptr;
+        data = nullptr;
+        size = 0;
+    }
+
+    file_mapping_structure::~file_mapping_structure()
+    {
+        close();
+    }
+
+    uint64_t content_hash(char const* data, size_t size)
+    {
+        // Words of 8 octets are mixed one after the other (the tail is padded with 0)
+        uint64_t h = 0x9E3779B97F4A7C15ull ^ uint64_t(size);
+        size_t const N_word = size / 8;
+        for (size_t k = 0; k <= N_word; ++k)
+        {
+            uint64_t word = 0;
+            size_t const N_octet = (k < N_word) ? 8 : size % 8;
+            if (N_octet == 0)
+                break;
+            std::memcpy(&word, data + 8 * k, N_octet);
+
+            h ^= word * 0xBF58476D1CE4E5B9ull;
+            h = ((h << 31) | (h >> 33)) * 0x94D049BB133111EBull;
+        }
+        h ^= h >> 30;
+        h *= 0xBF58476D1CE4E5B9ull;
+        h ^= h >> 27;
+        h *= 0x94D049BB133111EBull;
+        h ^= h >> 31;
+        return h;
+    }
+
+    uint64_t file_content_hash(std::string const& filename)
+    {
+        file_mapping_structure file;
+        file.open(filename);
+        return content_hash(file.data, file.size);
+    }
+}
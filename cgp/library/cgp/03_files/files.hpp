@@ -3,6 +3,7 @@
 
 #include "cgp/02_numarray/numarray.hpp"
 
+#include <cstdint>
 #include <string>
 #include <sstream>
 #include <fstream>
@@ -25,6 +26,32 @@ namespace cgp
 	/** Read the entire content of a file as binary vector of octets*/
 	std::vector <char> read_from_file_binary(std::string const& filename);
 
+	/** 64-bit hash of a buffer of octets (not cryptographic: used to detect a change of content) */
+	uint64_t content_hash(char const* data, size_t size);
+	/** 64-bit hash of the content of a file */
+	uint64_t file_content_hash(std::string const& filename);
+
+	/** Read-only memory mapping of a file: the content is accessed in place, without being copied
+	 *  (on platforms without memory mapping, the content is read in a buffer owned by the structure) */
+	struct file_mapping_structure
+	{
+		char const* data = nullptr;
+		size_t size = 0;
+
+		file_mapping_structure() = default;
+		file_mapping_structure(file_mapping_structure const&) = delete;
+		file_mapping_structure& operator=(file_mapping_structure const&) = delete;
+		~file_mapping_structure();
+
+		void open(std::string const& filename);
+		void close();
+
+	private:
+		void* handle_file = nullptr;
+		void* handle_mapping = nullptr;
+		std::vector<char> buffer;
+	};
+
 	std::string read_text_file(std::string const& filename);
 	template <typename T> void read_from_file(std::string const& filename, T& data);
 	template <typename T> void read_from_file(std::string const& filename, numarray<numarray<T>>& data);
@@ -6,6 +6,9 @@
 #include "third_party/src/jpeg/jpge.h"
 #include "third_party/src/jpeg/jpgd.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "cgp/13_opengl/opengl.hpp"
 
 #if defined(__linux__) || defined(__EMSCRIPTEN__)
@@ -30,6 +33,26 @@ namespace cgp
     {}
 
     image_structure image_structure::subimage(int start_x, int start_y, int end_x, int end_y) const
+    {
+        return view().subimage(start_x, start_y, end_x, end_y).to_image();
+    }
+
+    image_view_structure image_structure::view() const
+    {
+        int const d = size_of_component(color_type);
+
+        image_view_structure v;
+        v.data = data.data.data();
+        v.width = width;
+        v.height = height;
+        v.stride_x = d;
+        v.stride_y = d * width;
+        v.color_type = color_type;
+        return v;
+    }
+
+
+    image_view_structure image_view_structure::subimage(int start_x, int start_y, int end_x, int end_y) const
     {
         // Sanity check
         assert_cgp_no_msg(start_x < end_x);
@@ -39,25 +62,102 @@ namespace cgp
         assert_cgp_no_msg(end_x <= width);
         assert_cgp_no_msg(end_y <= height);
 
-        // copy
-        image_structure new_image;
-        new_image.width = end_x - start_x;
-        new_image.height = end_y - start_y;
-        new_image.color_type = color_type;
-
-        int s = size_of_component(color_type);
-        new_image.data.resize(s * new_image.width * new_image.height);
-        for (int kx = 0; kx < new_image.width; ++kx) {
-            for (int ky = 0; ky < new_image.height; ++ky) {
-                int offset_in = s * ((kx+start_x) + width * (ky+start_y));
-                int offset_out = s * (kx + new_image.width*ky);
-                for (int ks = 0; ks < s; ++ks) {
-                    new_image.data[offset_out + ks] = data[offset_in + ks];
+        image_view_structure v = *this;
+        v.data = pixel(start_x, start_y);
+        v.width = end_x - start_x;
+        v.height = end_y - start_y;
+        return v;
+    }
+
+    // v(x,y) = (width-1-x, y)
+    image_view_structure image_view_structure::mirror_horizontal() const
+    {
+        image_view_structure v = *this;
+        v.data = pixel(width - 1, 0);
+        v.stride_x = -stride_x;
+        return v;
+    }
+
+    // v(x,y) = (x, height-1-y)
+    image_view_structure image_view_structure::mirror_vertical() const
+    {
+        image_view_structure v = *this;
+        v.data = pixel(0, height - 1);
+        v.stride_y = -stride_y;
+        return v;
+    }
+
+    // v(x,y) = (width-1-y, x)
+    image_view_structure image_view_structure::rotate_90_degrees_counterclockwise() const
+    {
+        image_view_structure v = *this;
+        v.data = pixel(width - 1, 0);
+        v.width = height;
+        v.height = width;
+        v.stride_x = stride_y;
+        v.stride_y = -stride_x;
+        return v;
+    }
+
+    // v(x,y) = (y, height-1-x)
+    image_view_structure image_view_structure::rotate_90_degrees_clockwise() const
+    {
+        image_view_structure v = *this;
+        v.data = pixel(0, height - 1);
+        v.width = height;
+        v.height = width;
+        v.stride_x = -stride_y;
+        v.stride_y = stride_x;
+        return v;
+    }
+
+    // Copy of the pixels of a view whose rows are not contiguous (mirrored or rotated)
+    //  The copy is done by tiles of 32x32 pixels: for a rotation, the columns read in the input stay in cache while the rows of the tile are written
+    template <int D>
+    static void image_view_copy_tiled(image_view_structure const& view, unsigned char* out)
+    {
+        int const tile = 32;
+        for (int ty = 0; ty < view.height; ty += tile) {
+            int const y_end = std::min(ty + tile, view.height);
+            for (int tx = 0; tx < view.width; tx += tile) {
+                int const x_end = std::min(tx + tile, view.width);
+                for (int y = ty; y < y_end; ++y) {
+                    unsigned char const* in = view.pixel(tx, y);
+                    unsigned char* pixel_out = out + D * (size_t(y) * view.width + tx);
+                    for (int x = tx; x < x_end; ++x) {
+                        std::memcpy(pixel_out, in, D);
+                        in += view.stride_x;
+                        pixel_out += D;
+                    }
                 }
             }
         }
+    }
 
-        return new_image;
+    image_structure image_view_structure::to_image() const
+    {
+        int const d = size_of_component(color_type);
+
+        image_structure im;
+        im.width = width;
+        im.height = height;
+        im.color_type = color_type;
+        im.data.resize(d * width * height);
+        if (width == 0 || height == 0)
+            return im;
+
+        unsigned char* out = im.data.data.data();
+        if (stride_x == d) {
+            // Contiguous pixels along the rows: one copy per row
+            for (int y = 0; y < height; ++y)
+                std::memcpy(out + size_t(y) * width * d, pixel(0, y), size_t(width) * d);
+        }
+        else if (d == 3)
+            image_view_copy_tiled<3>(*this, out);
+        else
+            image_view_copy_tiled<4>(*this, out);
+
+        return im;
     }
 
     image_structure image_load_png(std::string const& filename, image_color_type color_type)
@@ -182,7 +282,7 @@ namespace cgp
     }
 
 
-    std::vector<image_structure> image_split_grid(image_structure const& image_in, int N_horizontal, int N_vertical)
+    std::vector<image_view_structure> image_split_grid_view(image_structure const& image_in, int N_horizontal, int N_vertical)
     {
         // Sanity check
         assert_cgp(N_horizontal > 0, "Split image should have N_horizontal>0");
@@ -199,97 +299,106 @@ namespace cgp
             abort();
         }
 
-        std::vector<image_structure> subimages;
+        image_view_structure const view = image_in.view();
+        std::vector<image_view_structure> subimages;
         subimages.resize(N_horizontal * N_vertical);
         for (int kh = 0; kh < N_horizontal; ++kh) {
             for (int kv = 0; kv < N_vertical; ++kv) {
-                subimages[kv+N_vertical*kh] = image_in.subimage(kh * width, kv * height, (kh + 1) * width, (kv + 1) * height);
+                subimages[kv+N_vertical*kh] = view.subimage(kh * width, kv * height, (kh + 1) * width, (kv + 1) * height);
             }
         }
 
         return subimages;
     }
 
+    std::vector<image_structure> image_split_grid(image_structure const& image_in, int N_horizontal, int N_vertical)
+    {
+        std::vector<image_view_structure> const views = image_split_grid_view(image_in, N_horizontal, N_vertical);
+        std::vector<image_structure> subimages(views.size());
+        for (size_t k = 0; k < views.size(); ++k)
+            subimages[k] = views[k].to_image();
+        return subimages;
+    }
+
     
     image_structure image_structure::mirror_horizontal() const
     {
-        image_structure mirrored = *this;
-        int d = size_of_component(color_type);
-        for (int kx = 0; kx < width; ++kx) {
-            for (int ky = 0; ky < height; ++ky) {
-                int offset_in  = kx + width * ky;
-                int offset_out = (width-kx-1) + width * ky;
-                for(int kd=0; kd<d; ++kd)
-                    mirrored.data[kd+d*offset_out] = data[kd+d*offset_in];
-            }
-        }
-
-        return mirrored;
+        return view().mirror_horizontal().to_image();
     }
 
-
     image_structure image_structure::mirror_vertical() const
     {
-        image_structure mirrored = *this;
-
-        int const d = size_of_component(color_type);
-        for (int kx = 0; kx < width; ++kx) {
-            for (int ky = 0; ky < height; ++ky) {
-                int offset_in = kx + width * ky;
-                int offset_out = kx + width * (height-ky-1);
-
-                for (int kd = 0; kd < d; ++kd)
-                    mirrored.data[kd + d * offset_out] = data[kd + d * offset_in];
-            }
-        }
-
-        return mirrored;
+        return view().mirror_vertical().to_image();
     }
 
     image_structure image_structure::rotate_90_degrees_counterclockwise() const
     {
-        int const d = size_of_component(color_type);
-
-        image_structure rotated;
-        rotated.height = width;
-        rotated.width = height;
-        rotated.color_type = color_type;
-        rotated.data.resize(width * height * d);
-
-        for (int kx = 0; kx < width; ++kx) {
-            for (int ky = 0; ky < height; ++ky) {
-                int offset_in = (width-kx-1) + width * ky;
-                int offset_out = ky + height * kx;
-
-                for (int kd = 0; kd < d; ++kd)
-                    rotated.data[kd + d * offset_out] = data[kd + d * offset_in];
-            }
-        }
-
-        return rotated;
+        return view().rotate_90_degrees_counterclockwise().to_image();
     }
     image_structure image_structure::rotate_90_degrees_clockwise() const
     {
-        int const d = size_of_component(color_type);
+        return view().rotate_90_degrees_clockwise().to_image();
+    }
 
-        image_structure rotated;
-        rotated.height = width;
-        rotated.width = height;
-        rotated.color_type = color_type;
-        rotated.data.resize(width * height * d);
+    void image_structure::mirror_horizontal_in_place()
+    {
+        int const d = size_of_component(color_type);
+        unsigned char* pixels = data.data.data();
+        for (int ky = 0; ky < height; ++ky) {
+            unsigned char* row = pixels + size_t(d) * width * ky;
+            for (int kx = 0; kx < width / 2; ++kx)
+                std::swap_ranges(row + d * kx, row + d * (kx + 1), row + d * (width - 1 - kx));
+        }
+    }
 
-        for (int kx = 0; kx < width; ++kx) {
-            for (int ky = 0; ky < height; ++ky) {
-                int offset_in = kx + width * (height-ky-1);
-                int offset_out = ky + height * kx;
+    void image_structure::mirror_vertical_in_place()
+    {
+        size_t const row_size = size_t(size_of_component(color_type)) * width;
+        unsigned char* pixels = data.data.data();
+        for (int ky = 0; ky < height / 2; ++ky)
+            std::swap_ranges(pixels + row_size * ky, pixels + row_size * (ky + 1), pixels + row_size * (height - 1 - ky));
+    }
 
-                for (int kd = 0; kd < d; ++kd)
-                    rotated.data[kd + d * offset_out] = data[kd + d * offset_in];
+    // Transposition of a square image, by tiles of 32x32 pixels
+    static void image_transpose_square_in_place(image_structure& im)
+    {
+        int const d = size_of_component(im.color_type);
+        int const N = im.width;
+        unsigned char* pixels = im.data.data.data();
+        int const tile = 32;
+        for (int ty = 0; ty < N; ty += tile) {
+            for (int tx = ty; tx < N; tx += tile) {
+                for (int y = ty; y < std::min(ty + tile, N); ++y) {
+                    for (int x = std::max(tx, y + 1); x < std::min(tx + tile, N); ++x) {
+                        unsigned char* a = pixels + d * (size_t(y) * N + x);
+                        unsigned char* b = pixels + d * (size_t(x) * N + y);
+                        std::swap_ranges(a, a + d, b);
+                    }
+                }
             }
         }
+    }
 
-        return rotated;
+    void image_structure::rotate_90_degrees_counterclockwise_in_place()
+    {
+        if (width != height) {
+            *this = rotate_90_degrees_counterclockwise();
+            return;
+        }
+        // (x,y) <- (width-1-y, x): transposition, then vertical mirror
+        image_transpose_square_in_place(*this);
+        mirror_vertical_in_place();
+    }
+
+    void image_structure::rotate_90_degrees_clockwise_in_place()
+    {
+        if (width != height) {
+            *this = rotate_90_degrees_clockwise();
+            return;
+        }
+        // (x,y) <- (y, height-1-x): transposition, then horizontal mirror
+        image_transpose_square_in_place(*this);
+        mirror_horizontal_in_place();
     }
-        
 
 }
\ No newline at end of file
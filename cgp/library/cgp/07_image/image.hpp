@@ -3,9 +3,38 @@
 #include "cgp/04_grid_container/grid_container.hpp"
 #include "cgp/05_vec/vec.hpp"
 
+#include <cstddef>
+
 namespace cgp
 {
 	enum class image_color_type {rgb, rgba};
+	struct image_structure;
+
+	/** Read-only view on the pixels of an image, without copy
+	 * The pixel (x,y) starts at data + x*stride_x + y*stride_y (in octets). Strides can be negative: the subimages,
+	 * mirrors and rotations of a view are views on the same pixels. The viewed image must outlive the view.
+	 * to_image() copies the pixels into a new image (by rows when they are contiguous, by cache tiles otherwise). */
+	struct image_view_structure
+	{
+		unsigned char const* data = nullptr; // first octet of the pixel (0,0)
+		int width = 0;
+		int height = 0;
+		int stride_x = 0; // octets between the pixels (x,y) and (x+1,y)
+		int stride_y = 0; // octets between the pixels (x,y) and (x,y+1)
+		image_color_type color_type = image_color_type::rgb;
+
+		unsigned char const* pixel(int x, int y) const { return data + std::ptrdiff_t(x) * stride_x + std::ptrdiff_t(y) * stride_y; }
+
+		// Same conventions as the functions of image_structure
+		image_view_structure subimage(int start_h, int start_v, int end_h, int end_v) const;
+		image_view_structure mirror_horizontal() const;
+		image_view_structure mirror_vertical() const;
+		image_view_structure rotate_90_degrees_counterclockwise() const;
+		image_view_structure rotate_90_degrees_clockwise() const;
+
+		image_structure to_image() const;
+	};
+
 	struct image_structure
 	{
 		int width;
@@ -33,6 +62,15 @@ namespace cgp
 		image_structure rotate_90_degrees_counterclockwise() const;
 		image_structure rotate_90_degrees_clockwise() const;
 
+		// Transformations of the image itself (no allocation, except for the rotation of a non-square image)
+		void mirror_horizontal_in_place();
+		void mirror_vertical_in_place();
+		void rotate_90_degrees_counterclockwise_in_place();
+		void rotate_90_degrees_clockwise_in_place();
+
+		// View on all the pixels of the image
+		image_view_structure view() const;
+
 
 
 	};
@@ -57,4 +95,9 @@ namespace cgp
 	//    1 4 7 10
 	//    2 5 8 11
 	std::vector<image_structure> image_split_grid(image_structure const& image_in, int N_horizontal, int N_vertical);
-}
\ No newline at end of file
+	// Same splitting, the sub-images are views on the input image (no copy)
+	std::vector<image_view_structure> image_split_grid_view(image_structure const& image_in, int N_horizontal, int N_vertical);
+}
+
+#include "image_mipmap/image_mipmap.hpp"
+#include "image_compression/image_compression.hpp"
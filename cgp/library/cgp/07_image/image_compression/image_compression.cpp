@@ -0,0 +1,561 @@
+#include "image_compression.hpp"
+#include "../image_mipmap/image_mipmap.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "cgp/03_files/files.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace cgp
+{
+	int image_compressed_structure::level_count() const
+	{
+		return int(levels.size());
+	}
+	int image_compressed_structure::level_width(int level) const
+	{
+		return std::max(1, width >> level);
+	}
+	int image_compressed_structure::level_height(int level) const
+	{
+		return std::max(1, height >> level);
+	}
+	int image_compressed_structure::block_size() const
+	{
+		return format == image_compression_format::bc1 ? 8 : 16;
+	}
+	size_t image_compressed_structure::bytes() const
+	{
+		size_t total = 0;
+		for (numarray<unsigned char> const& level : levels)
+			total += level.size();
+		return total;
+	}
+
+	static int block_count(int size)
+	{
+		return (size + 3) / 4;
+	}
+
+
+	// ****************************** //
+	// Rgba copy
+	// ****************************** //
+
+	// Copy of the image with 4 octets per pixel
+	static numarray<unsigned char> image_to_rgba(image_structure const& im)
+	{
+		if (im.color_type == image_color_type::rgba)
+			return im.data;
+
+		int const N = im.width * im.height;
+		numarray<unsigned char> rgba(4 * N);
+		unsigned char const* in = ptr(im.data);
+		unsigned char* out = &rgba.data[0];
+		for (int k = 0; k < N; ++k) {
+			out[4 * k + 0] = in[3 * k + 0];
+			out[4 * k + 1] = in[3 * k + 1];
+			out[4 * k + 2] = in[3 * k + 2];
+			out[4 * k + 3] = 255;
+		}
+		return rgba;
+	}
+
+
+	// ****************************** //
+	// Color block (bc1, and color part of bc3)
+	// ****************************** //
+
+	static uint16_t color_pack_565(float r, float g, float b)
+	{
+		int const r5 = std::min(31, std::max(0, int(r * 31 / 255.0f + 0.5f)));
+		int const g6 = std::min(63, std::max(0, int(g * 63 / 255.0f + 0.5f)));
+		int const b5 = std::min(31, std::max(0, int(b * 31 / 255.0f + 0.5f)));
+		return uint16_t((r5 << 11) | (g6 << 5) | b5);
+	}
+	static void color_unpack_565(uint16_t c, int rgb[3])
+	{
+		int const r5 = (c >> 11) & 31;
+		int const g6 = (c >> 5) & 63;
+		int const b5 = c & 31;
+		rgb[0] = (r5 << 3) | (r5 >> 2);
+		rgb[1] = (g6 << 2) | (g6 >> 4);
+		rgb[2] = (b5 << 3) | (b5 >> 2);
+	}
+
+	// The 4 colors of a block in 4 colors mode: c0, c1, (2 c0 + c1)/3, (c0 + 2 c1)/3
+	static void color_palette(uint16_t c0, uint16_t c1, int palette[4][3])
+	{
+		color_unpack_565(c0, palette[0]);
+		color_unpack_565(c1, palette[1]);
+		for (int c = 0; c < 3; ++c) {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+	}
+
+	// Closest palette entry of each pixel, returns the squared error of the block
+	static float color_assign_indices(uint16_t c0, uint16_t c1, float const pixels[16][3], unsigned char indices[16])
+	{
+		int palette[4][3];
+		color_palette(c0, c1, palette);
+
+		float error = 0.0f;
+		for (int k = 0; k < 16; ++k) {
+			float best = 1e30f;
+			for (int i = 0; i < 4; ++i) {
+				float const dr = pixels[k][0] - palette[i][0];
+				float const dg = pixels[k][1] - palette[i][1];
+				float const db = pixels[k][2] - palette[i][2];
+				float const d = dr * dr + dg * dg + db * db;
+				if (d < best) {
+					best = d;
+					indices[k] = (unsigned char)i;
+				}
+			}
+			error += best;
+		}
+		return error;
+	}
+
+	// End points fitting best the pixels for the given indices (least squares)
+	static bool color_fit_end_points(float const pixels[16][3], unsigned char const indices[16], float e0[3], float e1[3])
+	{
+		static float const weight[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f }; // weight of c0 for each index
+		float a = 0, b = 0, c = 0;
+		float x[3] = { 0, 0, 0 };
+		float y[3] = { 0, 0, 0 };
+		for (int k = 0; k < 16; ++k) {
+			float const w = weight[indices[k]];
+			a += w * w;
+			b += w * (1 - w);
+			c += (1 - w) * (1 - w);
+			for (int i = 0; i < 3; ++i) {
+				x[i] += w * pixels[k][i];
+				y[i] += (1 - w) * pixels[k][i];
+			}
+		}
+		float const det = a * c - b * b;
+		if (std::abs(det) < 1e-6f)
+			return false;
+		for (int i = 0; i < 3; ++i) {
+			e0[i] = (c * x[i] - b * y[i]) / det;
+			e1[i] = (a * y[i] - b * x[i]) / det;
+		}
+		return true;
+	}
+
+	// 8 octets: c0, c1 (565), then 2 bits per pixel
+	static void color_encode_block(unsigned char const rgba[16][4], unsigned char* out)
+	{
+		float pixels[16][3];
+		float mean[3] = { 0, 0, 0 };
+		for (int k = 0; k < 16; ++k)
+			for (int i = 0; i < 3; ++i) {
+				pixels[k][i] = rgba[k][i];
+				mean[i] += pixels[k][i] / 16.0f;
+			}
+
+		// Principal axis of the colors (power iteration on the covariance)
+		float cov[6] = { 0, 0, 0, 0, 0, 0 }; // xx xy xz yy yz zz
+		for (int k = 0; k < 16; ++k) {
+			float const d[3] = { pixels[k][0] - mean[0], pixels[k][1] - mean[1], pixels[k][2] - mean[2] };
+			cov[0] += d[0] * d[0]; cov[1] += d[0] * d[1]; cov[2] += d[0] * d[2];
+			cov[3] += d[1] * d[1]; cov[4] += d[1] * d[2]; cov[5] += d[2] * d[2];
+		}
+		float axis[3] = { 1, 1, 1 };
+		for (int iteration = 0; iteration < 8; ++iteration) {
+			float const v[3] = {
+				cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+				cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+				cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2] };
+			float const norm = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+			if (norm < 1e-6f) {
+				axis[0] = axis[1] = axis[2] = 0.0f; // uniform color
+				break;
+			}
+			for (int i = 0; i < 3; ++i)
+				axis[i] = v[i] / norm;
+		}
+
+		// Initial end points: extreme projections on the axis
+		float t_min = 0, t_max = 0;
+		for (int k = 0; k < 16; ++k) {
+			float const t = (pixels[k][0] - mean[0]) * axis[0] + (pixels[k][1] - mean[1]) * axis[1] + (pixels[k][2] - mean[2]) * axis[2];
+			t_min = std::min(t_min, t);
+			t_max = std::max(t_max, t);
+		}
+		uint16_t c0 = color_pack_565(mean[0] + t_max * axis[0], mean[1] + t_max * axis[1], mean[2] + t_max * axis[2]);
+		uint16_t c1 = color_pack_565(mean[0] + t_min * axis[0], mean[1] + t_min * axis[1], mean[2] + t_min * axis[2]);
+		unsigned char indices[16];
+		float error = color_assign_indices(c0, c1, pixels, indices);
+
+		// Refinement of the end points for the selected indices
+		for (int iteration = 0; iteration < 2 && error > 0; ++iteration) {
+			float e0[3], e1[3];
+			if (!color_fit_end_points(pixels, indices, e0, e1))
+				break;
+			uint16_t const c0_fit = color_pack_565(e0[0], e0[1], e0[2]);
+			uint16_t const c1_fit = color_pack_565(e1[0], e1[1], e1[2]);
+			unsigned char indices_fit[16];
+			float const error_fit = color_assign_indices(c0_fit, c1_fit, pixels, indices_fit);
+			if (error_fit >= error)
+				break;
+			c0 = c0_fit;
+			c1 = c1_fit;
+			error = error_fit;
+			std::memcpy(indices, indices_fit, 16);
+		}
+
+		// The 4 colors mode requires c0 > c1 (bc1): swap the end points, or use a single color
+		if (c0 < c1) {
+			std::swap(c0, c1);
+			for (int k = 0; k < 16; ++k)
+				indices[k] ^= 1;
+		}
+		else if (c0 == c1) {
+			for (int k = 0; k < 16; ++k)
+				indices[k] = 0;
+		}
+
+		uint32_t bits = 0;
+		for (int k = 0; k < 16; ++k)
+			bits |= uint32_t(indices[k]) << (2 * k);
+		out[0] = (unsigned char)(c0 & 0xff); out[1] = (unsigned char)(c0 >> 8);
+		out[2] = (unsigned char)(c1 & 0xff); out[3] = (unsigned char)(c1 >> 8);
+		for (int i = 0; i < 4; ++i)
+			out[4 + i] = (unsigned char)((bits >> (8 * i)) & 0xff);
+	}
+
+	static void color_decode_block(unsigned char const* in, bool always_4_colors, unsigned char rgba[16][4])
+	{
+		uint16_t const c0 = uint16_t(in[0] | (in[1] << 8));
+		uint16_t const c1 = uint16_t(in[2] | (in[3] << 8));
+		uint32_t const bits = uint32_t(in[4]) | (uint32_t(in[5]) << 8) | (uint32_t(in[6]) << 16) | (uint32_t(in[7]) << 24);
+
+		int palette[4][3];
+		int alpha[4] = { 255, 255, 255, 255 };
+		color_palette(c0, c1, palette);
+		if (c0 <= c1 && !always_4_colors) {
+			// 3 colors mode: (c0 + c1)/2, and transparent black
+			for (int c = 0; c < 3; ++c) {
+				palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+				palette[3][c] = 0;
+			}
+			alpha[3] = 0;
+		}
+
+		for (int k = 0; k < 16; ++k) {
+			int const i = (bits >> (2 * k)) & 3;
+			rgba[k][0] = (unsigned char)palette[i][0];
+			rgba[k][1] = (unsigned char)palette[i][1];
+			rgba[k][2] = (unsigned char)palette[i][2];
+			rgba[k][3] = (unsigned char)alpha[i];
+		}
+	}
+
+
+	// ****************************** //
+	// Alpha block (bc3)
+	// ****************************** //
+
+	static void alpha_palette(int a0, int a1, int palette[8])
+	{
+		palette[0] = a0;
+		palette[1] = a1;
+		if (a0 > a1) {
+			for (int i = 1; i < 7; ++i)
+				palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+		}
+		else {
+			for (int i = 1; i < 5; ++i)
+				palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+
+	// 8 octets: a0, a1, then 3 bits per pixel
+	static void alpha_encode_block(unsigned char const rgba[16][4], unsigned char* out)
+	{
+		int a0 = 0, a1 = 255;
+		for (int k = 0; k < 16; ++k) {
+			a0 = std::max(a0, int(rgba[k][3]));
+			a1 = std::min(a1, int(rgba[k][3]));
+		}
+
+		int palette[8];
+		alpha_palette(a0, a1, palette);
+
+		uint64_t bits = 0;
+		if (a0 > a1) {
+			for (int k = 0; k < 16; ++k) {
+				int best = 0;
+				for (int i = 1; i < 8; ++i)
+					if (std::abs(palette[i] - rgba[k][3]) < std::abs(palette[best] - rgba[k][3]))
+						best = i;
+				bits |= uint64_t(best) << (3 * k);
+			}
+		}
+
+		out[0] = (unsigned char)a0;
+		out[1] = (unsigned char)a1;
+		for (int i = 0; i < 6; ++i)
+			out[2 + i] = (unsigned char)((bits >> (8 * i)) & 0xff);
+	}
+
+	static void alpha_decode_block(unsigned char const* in, unsigned char rgba[16][4])
+	{
+		int palette[8];
+		alpha_palette(in[0], in[1], palette);
+		uint64_t bits = 0;
+		for (int i = 0; i < 6; ++i)
+			bits |= uint64_t(in[2 + i]) << (8 * i);
+		for (int k = 0; k < 16; ++k)
+			rgba[k][3] = (unsigned char)palette[(bits >> (3 * k)) & 7];
+	}
+
+
+	// ****************************** //
+	// Images
+	// ****************************** //
+
+	// True inside an OpenMP parallel region (ex. images compressed in parallel by the caller): the blocks are then compressed serially
+	static bool omp_in_parallel_region()
+	{
+#ifdef _OPENMP
+		return omp_in_parallel() != 0;
+#else
+		return false;
+#endif
+	}
+
+	static numarray<unsigned char> compress_level(numarray<unsigned char> const& rgba, int width, int height, image_compression_format format)
+	{
+		int const block_x = block_count(width);
+		int const block_y = block_count(height);
+		int const block_size = (format == image_compression_format::bc1 ? 8 : 16);
+		numarray<unsigned char> out(size_t(block_x) * block_y * block_size);
+
+		bool const is_nested = omp_in_parallel_region();
+		#pragma omp parallel for schedule(static) if(!is_nested && block_y>1 && block_x*block_y>1024)
+		for (int by = 0; by < block_y; ++by) {
+			for (int bx = 0; bx < block_x; ++bx) {
+				// Pixels of the block (the border pixels are repeated outside of the image)
+				unsigned char block[16][4];
+				for (int ky = 0; ky < 4; ++ky) {
+					int const y = std::min(4 * by + ky, height - 1);
+					for (int kx = 0; kx < 4; ++kx) {
+						int const x = std::min(4 * bx + kx, width - 1);
+						std::memcpy(block[kx + 4 * ky], &rgba.data[4 * (x + width * y)], 4);
+					}
+				}
+
+				unsigned char* block_out = &out.data[size_t(bx + block_x * by) * block_size];
+				if (format == image_compression_format::bc3) {
+					alpha_encode_block(block, block_out);
+					block_out += 8;
+				}
+				color_encode_block(block, block_out);
+			}
+		}
+		return out;
+	}
+
+	image_compressed_structure image_compress(image_structure const& im, bool is_mipmap)
+	{
+		assert_cgp(im.width > 0 && im.height > 0, "Cannot compress an empty image");
+
+		image_structure rgba;
+		rgba.width = im.width;
+		rgba.height = im.height;
+		rgba.color_type = image_color_type::rgba;
+		rgba.data = image_to_rgba(im);
+
+		bool is_opaque = true;
+		if (im.color_type == image_color_type::rgba) {
+			int const N = im.width * im.height;
+			for (int k = 0; k < N && is_opaque; ++k)
+				is_opaque = (rgba.data.data[4 * k + 3] == 255);
+		}
+
+		image_compressed_structure out;
+		out.width = im.width;
+		out.height = im.height;
+		out.format = (is_opaque ? image_compression_format::bc1 : image_compression_format::bc3);
+
+		while (true) {
+			out.levels.push_back(compress_level(rgba.data, rgba.width, rgba.height, out.format));
+			if (!is_mipmap || (rgba.width == 1 && rgba.height == 1))
+				break;
+			rgba = image_mipmap_downsample(rgba, image_mipmap_filter::box);
+		}
+		return out;
+	}
+
+	image_structure image_decompress(image_compressed_structure const& im, int level)
+	{
+		assert_cgp(level >= 0 && level < im.level_count(), "Incorrect level " + str(level) + " of a compressed image with " + str(im.level_count()) + " levels");
+
+		int const width = im.level_width(level);
+		int const height = im.level_height(level);
+		int const block_x = block_count(width);
+		int const block_y = block_count(height);
+		int const block_size = im.block_size();
+		bool const is_bc3 = (im.format == image_compression_format::bc3);
+		numarray<unsigned char> const& blocks = im.levels[level];
+		assert_cgp_no_msg(blocks.size() == size_t(block_x) * block_y * block_size);
+
+		image_structure out;
+		out.width = width;
+		out.height = height;
+		out.color_type = image_color_type::rgba;
+		out.data.resize(4 * width * height);
+
+		for (int by = 0; by < block_y; ++by) {
+			for (int bx = 0; bx < block_x; ++bx) {
+				unsigned char const* block_in = &blocks.data[size_t(bx + block_x * by) * block_size];
+				unsigned char block[16][4];
+				color_decode_block(block_in + (is_bc3 ? 8 : 0), is_bc3, block);
+				if (is_bc3)
+					alpha_decode_block(block_in, block);
+
+				for (int ky = 0; ky < 4 && 4 * by + ky < height; ++ky)
+					for (int kx = 0; kx < 4 && 4 * bx + kx < width; ++kx)
+						std::memcpy(&out.data[4 * ((4 * bx + kx) + width * (4 * by + ky))], block[kx + 4 * ky], 4);
+			}
+		}
+		return out;
+	}
+
+
+	// ****************************** //
+	// File .cgptex
+	// ****************************** //
+
+	// Layout of the file:
+	//  [header (64 octets)] [blocks of level 0] [blocks of level 1] ...
+	struct cgptex_header {
+		char magic[8];
+		uint32_t version;
+		uint32_t endianness;   // 0x01020304 written in the native order
+		uint64_t source_hash;
+		uint32_t width;
+		uint32_t height;
+		uint32_t format;       // 1: bc1, 3: bc3
+		uint32_t level_count;
+		uint32_t reserved[6];
+	};
+	static_assert(sizeof(cgptex_header) == 64, "Unexpected size of cgptex header");
+
+	static char const cgptex_magic[8] = {'C','G','P','T','E','X','\0','\0'};
+	static uint32_t const cgptex_version = 1;
+	static uint32_t const cgptex_endianness = 0x01020304;
+
+	bool image_save_file_cgptex(std::string const& filename, image_compressed_structure const& im, uint64_t source_hash)
+	{
+		cgptex_header header = {};
+		std::memcpy(header.magic, cgptex_magic, 8);
+		header.version = cgptex_version;
+		header.endianness = cgptex_endianness;
+		header.source_hash = source_hash;
+		header.width = uint32_t(im.width);
+		header.height = uint32_t(im.height);
+		header.format = (im.format == image_compression_format::bc1 ? 1 : 3);
+		header.level_count = uint32_t(im.level_count());
+
+		// Write in a temporary file, then rename: a reader never sees a partially written file
+		std::string const filename_tmp = filename + ".tmp";
+		{
+			std::ofstream stream(filename_tmp, std::ios::out | std::ios::binary | std::ios::trunc);
+			if (!stream.is_open())
+				return false;
+
+			stream.write(reinterpret_cast<char const*>(&header), sizeof(header));
+			for (numarray<unsigned char> const& level : im.levels)
+				stream.write(reinterpret_cast<char const*>(level.data.data()), level.size());
+			if (!stream.good()) {
+				stream.close();
+				std::remove(filename_tmp.c_str());
+				return false;
+			}
+		}
+
+		std::remove(filename.c_str()); // rename doesn't replace an existing file on Windows
+		if (std::rename(filename_tmp.c_str(), filename.c_str()) != 0) {
+			std::remove(filename_tmp.c_str());
+			return false;
+		}
+		return true;
+	}
+
+	bool image_load_file_cgptex(std::string const& filename, image_compressed_structure& im, uint64_t source_hash)
+	{
+		if (!check_file_exist(filename) || file_get_size(filename) < sizeof(cgptex_header))
+			return false;
+
+		file_mapping_structure file;
+		file.open(filename);
+
+		cgptex_header header;
+		std::memcpy(&header, file.data, sizeof(header));
+		bool const valid_header = std::memcmp(header.magic, cgptex_magic, 8) == 0
+			&& header.version == cgptex_version
+			&& header.endianness == cgptex_endianness
+			&& (header.format == 1 || header.format == 3)
+			&& header.width > 0 && header.height > 0 && header.level_count > 0 && header.level_count <= 32;
+		if (!valid_header || header.source_hash != source_hash)
+			return false;
+
+		image_compressed_structure loaded;
+		loaded.width = int(header.width);
+		loaded.height = int(header.height);
+		loaded.format = (header.format == 1 ? image_compression_format::bc1 : image_compression_format::bc3);
+
+		size_t file_size = sizeof(cgptex_header);
+		for (int k = 0; k < int(header.level_count); ++k)
+			file_size += size_t(block_count(loaded.level_width(k))) * block_count(loaded.level_height(k)) * loaded.block_size();
+		if (file_size != file.size)
+			return false;
+
+		char const* it = file.data + sizeof(cgptex_header);
+		loaded.levels.resize(header.level_count);
+		for (int k = 0; k < int(header.level_count); ++k) {
+			size_t const size = size_t(block_count(loaded.level_width(k))) * block_count(loaded.level_height(k)) * loaded.block_size();
+			unsigned char const* begin = reinterpret_cast<unsigned char const*>(it);
+			loaded.levels[k].data.assign(begin, begin + size);
+			it += size;
+		}
+
+		im = std::move(loaded);
+		return true;
+	}
+
+	image_compressed_structure image_load_file_compressed(std::string const& filename)
+	{
+#ifndef CGP_NO_TEXTURE_CACHE
+		// Reuse the compressed file if it has been generated from the same content
+		assert_file_exist(filename);
+		std::string const filename_cache = filename + ".cgptex";
+		uint64_t const source_hash = file_content_hash(filename);
+
+		image_compressed_structure im;
+		if (image_load_file_cgptex(filename_cache, im, source_hash))
+			return im;
+
+		im = image_compress(image_load_file(filename));
+		image_save_file_cgptex(filename_cache, im, source_hash); // the cache is optional: ignore write failure (ex. read-only directory)
+		return im;
+#else
+		return image_compress(image_load_file(filename));
+#endif
+	}
+}
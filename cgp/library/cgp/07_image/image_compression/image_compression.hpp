@@ -0,0 +1,52 @@
+#pragma once
+
+#include "../image.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cgp
+{
+	// Block compression formats (S3TC): 4x4 pixels blocks of 8 octets (bc1: rgb) or 16 octets (bc3: rgba)
+	enum class image_compression_format { bc1, bc3 };
+
+	// Image compressed by blocks, with its mipmap levels (level 0: full resolution)
+	struct image_compressed_structure
+	{
+		int width = 0;
+		int height = 0;
+		image_compression_format format = image_compression_format::bc1;
+		std::vector<numarray<unsigned char> > levels; // blocks of each level, ordered row by row
+
+		int level_count() const;
+		int level_width(int level) const;
+		int level_height(int level) const;
+
+		// Size in octets of a block (8 for bc1, 16 for bc3)
+		int block_size() const;
+		// Size in octets of all the levels
+		size_t bytes() const;
+	};
+
+	// Compress an image: bc1 if the image is rgb or fully opaque, bc3 otherwise
+	//  is_mipmap: the levels down to 1x1 are computed with a box filter and compressed as well
+	image_compressed_structure image_compress(image_structure const& im, bool is_mipmap = true);
+
+	// Decompress one level of a compressed image into an rgba image
+	image_structure image_decompress(image_compressed_structure const& im, int level = 0);
+
+	/** Save a compressed image in the binary format .cgptex
+	 * source_hash identifies the content of the file the image has been generated from (see file_content_hash).
+	 * Return false if the file cannot be written. */
+	bool image_save_file_cgptex(std::string const& filename, image_compressed_structure const& im, uint64_t source_hash);
+
+	/** Load a compressed image stored as .cgptex
+	 * Return false (im is unchanged) if the file doesn't exist, has been written by another version, or from another source content. */
+	bool image_load_file_cgptex(std::string const& filename, image_compressed_structure& im, uint64_t source_hash);
+
+	/** Load an image file (.png, .jpg) compressed with all its mipmap levels
+	 * The compressed image is stored next to the file (filename.cgptex) and reloaded directly as long as the content
+	 * of the file is unchanged: the compression is only done at the first run. */
+	image_compressed_structure image_load_file_compressed(std::string const& filename);
+}
@@ -0,0 +1,104 @@
+#include "cgp/07_image/image_compression/image_compression.hpp"
+#include "cgp/01_base/base.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(__linux__) || defined(__EMSCRIPTEN__)
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#endif
+
+namespace cgp_test
+{
+	// Largest difference between the components of two rgba images
+	static int max_difference(cgp::image_structure const& a, cgp::image_structure const& b)
+	{
+		int difference = 0;
+		for (size_t k = 0; k < a.data.size(); ++k)
+			difference = std::max(difference, std::abs(int(a.data[k]) - int(b.data[k])));
+		return difference;
+	}
+
+	static cgp::image_structure gradient_image(int width, int height, cgp::image_color_type color_type)
+	{
+		int const s = (color_type == cgp::image_color_type::rgba ? 4 : 3);
+		cgp::image_structure im;
+		im.width = width;
+		im.height = height;
+		im.color_type = color_type;
+		im.data.resize(s * width * height);
+		for (int ky = 0; ky < height; ++ky) {
+			for (int kx = 0; kx < width; ++kx) {
+				unsigned char* pixel = &im.data[s * (kx + width * ky)];
+				pixel[0] = (unsigned char)(40 + 2 * kx);
+				pixel[1] = (unsigned char)(200 - 3 * ky);
+				pixel[2] = (unsigned char)(100 + kx + ky);
+				if (s == 4)
+					pixel[3] = (unsigned char)(255 - 2 * kx - ky);
+			}
+		}
+		return im;
+	}
+
+	void test_image_compression()
+	{
+		// Smooth rgb image with a size that is not a multiple of the block size
+		{
+			cgp::image_structure const im = gradient_image(37, 21, cgp::image_color_type::rgb);
+			cgp::image_compressed_structure const compressed = cgp::image_compress(im);
+			assert_cgp_no_msg(compressed.format == cgp::image_compression_format::bc1);
+
+			// Levels down to 1x1: 37x21, 18x10, 9x5, 4x2, 2x1, 1x1
+			assert_cgp_no_msg(compressed.level_count() == 6);
+			assert_cgp_no_msg(compressed.level_width(2) == 9 && compressed.level_height(2) == 5);
+			assert_cgp_no_msg(compressed.levels[0].size() == size_t(10 * 6 * 8));
+			assert_cgp_no_msg(compressed.levels[5].size() == size_t(8));
+
+			// Expected error: quantization of the end points (565) and of the interpolation along the block
+			cgp::image_structure const decompressed = cgp::image_decompress(compressed, 0);
+			assert_cgp_no_msg(decompressed.width == 37 && decompressed.height == 21);
+			cgp::image_structure expected = gradient_image(37, 21, cgp::image_color_type::rgba);
+			for (size_t k = 3; k < expected.data.size(); k += 4)
+				expected.data[k] = 255;
+			assert_cgp_no_msg(max_difference(decompressed, expected) <= 8);
+
+			// No compression of the mipmap levels
+			cgp::image_compressed_structure const single_level = cgp::image_compress(im, false);
+			assert_cgp_no_msg(single_level.level_count() == 1);
+		}
+
+		// Uniform color: only the 565 quantization
+		{
+			cgp::image_structure im = gradient_image(8, 8, cgp::image_color_type::rgb);
+			for (size_t k = 0; k < im.data.size(); k += 3) {
+				im.data[k] = 201; im.data[k + 1] = 17; im.data[k + 2] = 90;
+			}
+			cgp::image_structure const decompressed = cgp::image_decompress(cgp::image_compress(im));
+			for (size_t k = 0; k < decompressed.data.size(); k += 4) {
+				assert_cgp_no_msg(std::abs(int(decompressed.data[k]) - 201) <= 4);
+				assert_cgp_no_msg(std::abs(int(decompressed.data[k + 1]) - 17) <= 2);
+				assert_cgp_no_msg(std::abs(int(decompressed.data[k + 2]) - 90) <= 4);
+				assert_cgp_no_msg(decompressed.data[k + 3] == 255);
+			}
+		}
+
+		// Transparent rgba image: bc3, the alpha is interpolated between 8 values per block
+		{
+			cgp::image_structure const im = gradient_image(16, 12, cgp::image_color_type::rgba);
+			cgp::image_compressed_structure const compressed = cgp::image_compress(im);
+			assert_cgp_no_msg(compressed.format == cgp::image_compression_format::bc3);
+			assert_cgp_no_msg(compressed.levels[0].size() == size_t(4 * 3 * 16));
+
+			cgp::image_structure const decompressed = cgp::image_decompress(compressed, 0);
+			assert_cgp_no_msg(max_difference(decompressed, im) <= 8);
+		}
+
+		// Opaque rgba image: bc1
+		{
+			cgp::image_structure im = gradient_image(8, 4, cgp::image_color_type::rgba);
+			for (size_t k = 3; k < im.data.size(); k += 4)
+				im.data[k] = 255;
+			assert_cgp_no_msg(cgp::image_compress(im).format == cgp::image_compression_format::bc1);
+		}
+	}
+}
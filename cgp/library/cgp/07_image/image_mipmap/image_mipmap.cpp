@@ -0,0 +1,170 @@
+#include "image_mipmap.hpp"
+
+#include "cgp/01_base/base.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace cgp
+{
+	// Number of octets per pixel
+	static int pixel_size(image_color_type color_type)
+	{
+		return color_type == image_color_type::rgba ? 4 : 3;
+	}
+
+	int image_mipmap_level_count(int width, int height)
+	{
+		int count = 1;
+		while (width > 1 || height > 1) {
+			width = std::max(1, width / 2);
+			height = std::max(1, height / 2);
+			count++;
+		}
+		return count;
+	}
+
+
+	// ****************************** //
+	// Box filter
+	// ****************************** //
+
+	// Average of 2x2 pixels (the last row/column of an odd size is dropped)
+	static void downsample_box(image_structure const& in, image_structure& out)
+	{
+		int const d = pixel_size(in.color_type);
+		int const width = in.width;
+		int const height = in.height;
+		int const w = out.width;
+		int const h = out.height;
+		unsigned char const* data_in = ptr(in.data);
+		unsigned char* data_out = &out.data.data[0];
+
+		#pragma omp parallel for schedule(static) if(h>1 && w*h>16384)
+		for (int ky = 0; ky < h; ++ky) {
+			unsigned char const* row0 = data_in + size_t(d) * width * std::min(2 * ky, height - 1);
+			unsigned char const* row1 = data_in + size_t(d) * width * std::min(2 * ky + 1, height - 1);
+			unsigned char* row_out = data_out + size_t(d) * w * ky;
+			for (int kx = 0; kx < w; ++kx) {
+				int const x0 = d * std::min(2 * kx, width - 1);
+				int const x1 = d * std::min(2 * kx + 1, width - 1);
+				for (int c = 0; c < d; ++c) {
+					int const sum = row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+					row_out[d * kx + c] = (unsigned char)((sum + 2) / 4);
+				}
+			}
+		}
+	}
+
+
+	// ****************************** //
+	// Kaiser filter
+	// ****************************** //
+
+	// The output pixel k is centered between the input pixels 2k and 2k+1: the taps are the input pixels 2k-3 to 2k+4
+	static int const kaiser_taps = 8;
+
+	// Modified Bessel function of the first kind, order 0
+	static double bessel_i0(double x)
+	{
+		double sum = 1.0;
+		double term = 1.0;
+		for (int k = 1; k < 32; ++k) {
+			term *= (x / (2.0 * k)) * (x / (2.0 * k));
+			sum += term;
+		}
+		return sum;
+	}
+
+	// Normalized weights of the taps: sinc with the cutoff of the half resolution, windowed by a Kaiser window (alpha=4)
+	static void kaiser_weights(float weights[kaiser_taps])
+	{
+		double const pi = 3.14159265358979323846;
+		double const alpha = 4.0;
+		double const radius = kaiser_taps / 2.0; // in input pixels
+
+		double sum = 0.0;
+		double w[kaiser_taps];
+		for (int j = 0; j < kaiser_taps; ++j) {
+			double const t = j - (kaiser_taps - 1) / 2.0; // distance to the center, in input pixels
+			double const sinc = std::sin(pi * t / 2.0) / (pi * t / 2.0);
+			double const u = t / radius;
+			double const window = bessel_i0(alpha * std::sqrt(1.0 - u * u)) / bessel_i0(alpha);
+			w[j] = sinc * window;
+			sum += w[j];
+		}
+		for (int j = 0; j < kaiser_taps; ++j)
+			weights[j] = float(w[j] / sum);
+	}
+
+	// Separable filter: for each output row, the 8 input rows are combined (vertical pass), then the 8 columns of this row (horizontal pass)
+	static void downsample_kaiser(image_structure const& in, image_structure& out)
+	{
+		float weights[kaiser_taps];
+		kaiser_weights(weights);
+
+		int const d = pixel_size(in.color_type);
+		int const width = in.width;
+		int const height = in.height;
+		int const w = out.width;
+		int const h = out.height;
+		unsigned char const* data_in = ptr(in.data);
+		unsigned char* data_out = &out.data.data[0];
+
+		#pragma omp parallel for schedule(static) if(h>1 && w*h>4096)
+		for (int ky = 0; ky < h; ++ky) {
+			std::vector<float> row(size_t(d) * width, 0.0f);
+			for (int j = 0; j < kaiser_taps; ++j) {
+				int const y = std::min(std::max(2 * ky - 3 + j, 0), height - 1);
+				unsigned char const* row_in = data_in + size_t(d) * width * y;
+				float const weight = weights[j];
+				for (int k = 0; k < d * width; ++k)
+					row[k] += weight * row_in[k];
+			}
+
+			unsigned char* row_out = data_out + size_t(d) * w * ky;
+			for (int kx = 0; kx < w; ++kx) {
+				float value[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+				for (int j = 0; j < kaiser_taps; ++j) {
+					int const x = std::min(std::max(2 * kx - 3 + j, 0), width - 1);
+					for (int c = 0; c < d; ++c)
+						value[c] += weights[j] * row[d * x + c];
+				}
+				// The negative lobes of the sinc can overshoot
+				for (int c = 0; c < d; ++c)
+					row_out[d * kx + c] = (unsigned char)std::min(255, std::max(0, int(value[c] + 0.5f)));
+			}
+		}
+	}
+
+
+	image_structure image_mipmap_downsample(image_structure const& im, image_mipmap_filter filter)
+	{
+		assert_cgp(im.width > 0 && im.height > 0, "Cannot compute the mipmap level of an empty image");
+
+		image_structure out;
+		out.width = std::max(1, im.width / 2);
+		out.height = std::max(1, im.height / 2);
+		out.color_type = im.color_type;
+		out.data.resize(size_t(pixel_size(im.color_type)) * out.width * out.height);
+
+		if (filter == image_mipmap_filter::kaiser)
+			downsample_kaiser(im, out);
+		else
+			downsample_box(im, out);
+		return out;
+	}
+
+	std::vector<image_structure> image_mipmap_chain(image_structure im, image_mipmap_filter filter)
+	{
+		std::vector<image_structure> levels;
+		levels.reserve(image_mipmap_level_count(im.width, im.height));
+		levels.push_back(std::move(im));
+		while (levels.back().width > 1 || levels.back().height > 1) {
+			image_structure next = image_mipmap_downsample(levels.back(), filter);
+			levels.push_back(std::move(next));
+		}
+		return levels;
+	}
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "../image.hpp"
+
+#include <vector>
+
+namespace cgp
+{
+	/** Filter used to compute a mipmap level from the previous one
+	 *  - box: average of 2x2 pixels (same result as the usual glGenerateMipmap)
+	 *  - kaiser: Kaiser-windowed sinc over 8x8 pixels, sharper levels with less aliasing (about 8 times slower) */
+	enum class image_mipmap_filter { box, kaiser };
+
+	// Number of mipmap levels of an image, down to 1x1
+	int image_mipmap_level_count(int width, int height);
+
+	// Next mipmap level of an image: size (max(1,width/2), max(1,height/2)), same color type
+	//  The rows are computed in parallel (OpenMP) on large images.
+	image_structure image_mipmap_downsample(image_structure const& im, image_mipmap_filter filter = image_mipmap_filter::box);
+
+	// All the mipmap levels of an image (level 0: the image itself, down to 1x1)
+	//  The image is taken by value: use std::move to avoid the copy of the level 0.
+	std::vector<image_structure> image_mipmap_chain(image_structure im, image_mipmap_filter filter = image_mipmap_filter::box);
+}
@@ -0,0 +1,88 @@
+#include "cgp/07_image/image_mipmap/image_mipmap.hpp"
+#include "cgp/01_base/base.hpp"
+
+#include <cstdlib>
+
+#if defined(__linux__) || defined(__EMSCRIPTEN__)
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#endif
+
+namespace cgp_test
+{
+	static cgp::image_structure image_of_size(int width, int height, cgp::image_color_type color_type)
+	{
+		int const d = (color_type == cgp::image_color_type::rgba ? 4 : 3);
+		cgp::image_structure im;
+		im.width = width;
+		im.height = height;
+		im.color_type = color_type;
+		im.data.resize(d * width * height);
+		return im;
+	}
+
+	void test_image_mipmap()
+	{
+		// Number of levels
+		assert_cgp_no_msg(cgp::image_mipmap_level_count(37, 21) == 6);
+		assert_cgp_no_msg(cgp::image_mipmap_level_count(8, 1) == 4);
+		assert_cgp_no_msg(cgp::image_mipmap_level_count(1, 1) == 1);
+
+		// Box filter: rounded average of 2x2 pixels, the last column of an odd size is dropped
+		{
+			cgp::image_structure im = image_of_size(5, 4, cgp::image_color_type::rgb);
+			for (size_t k = 0; k < im.data.size(); ++k)
+				im.data[k] = (unsigned char)((13 * k + 5) % 256);
+
+			cgp::image_structure const next = cgp::image_mipmap_downsample(im);
+			assert_cgp_no_msg(next.width == 2 && next.height == 2 && next.color_type == cgp::image_color_type::rgb);
+			for (int y = 0; y < 2; ++y) {
+				for (int x = 0; x < 2; ++x) {
+					for (int c = 0; c < 3; ++c) {
+						int const sum = im.data[3 * (2 * x + 5 * 2 * y) + c] + im.data[3 * (2 * x + 1 + 5 * 2 * y) + c]
+							+ im.data[3 * (2 * x + 5 * (2 * y + 1)) + c] + im.data[3 * (2 * x + 1 + 5 * (2 * y + 1)) + c];
+						assert_cgp_no_msg(next.data[3 * (x + 2 * y) + c] == (sum + 2) / 4);
+					}
+				}
+			}
+
+			// Chain down to 1x1: 5x4, 2x2, 1x1
+			std::vector<cgp::image_structure> const chain = cgp::image_mipmap_chain(im);
+			assert_cgp_no_msg(chain.size() == 3);
+			assert_cgp_no_msg(chain[0].data.data == im.data.data);
+			assert_cgp_no_msg(chain[1].data.data == next.data.data);
+			assert_cgp_no_msg(chain[2].width == 1 && chain[2].height == 1);
+		}
+
+		// Kaiser filter: the weights are normalized, a uniform image stays uniform
+		{
+			cgp::image_structure im = image_of_size(13, 7, cgp::image_color_type::rgba);
+			for (size_t k = 0; k < im.data.size(); ++k)
+				im.data[k] = (unsigned char)(k % 4 == 3 ? 128 : 200);
+			std::vector<cgp::image_structure> const chain = cgp::image_mipmap_chain(im, cgp::image_mipmap_filter::kaiser);
+			assert_cgp_no_msg(chain.size() == 4);
+			for (size_t level = 1; level < chain.size(); ++level)
+				for (size_t k = 0; k < chain[level].data.size(); ++k)
+					assert_cgp_no_msg(chain[level].data[k] == (k % 4 == 3 ? 128 : 200));
+		}
+
+		// Kaiser filter: symmetric weights, a linear ramp is sampled at the center of the output pixels (away from the borders)
+		{
+			int const N = 60;
+			cgp::image_structure im = image_of_size(N, N, cgp::image_color_type::rgb);
+			for (int y = 0; y < N; ++y)
+				for (int x = 0; x < N; ++x)
+					for (int c = 0; c < 3; ++c)
+						im.data[3 * (x + N * y) + c] = (unsigned char)(c == 0 ? 4 * x : (c == 1 ? 4 * y : 100));
+
+			cgp::image_structure const next = cgp::image_mipmap_downsample(im, cgp::image_mipmap_filter::kaiser);
+			for (int y = 2; y < N / 2 - 2; ++y) {
+				for (int x = 2; x < N / 2 - 2; ++x) {
+					// Center of the output pixel x: 2x+0.5 in the input pixels
+					assert_cgp_no_msg(std::abs(int(next.data[3 * (x + N / 2 * y) + 0]) - (8 * x + 2)) <= 1);
+					assert_cgp_no_msg(std::abs(int(next.data[3 * (x + N / 2 * y) + 1]) - (8 * y + 2)) <= 1);
+					assert_cgp_no_msg(next.data[3 * (x + N / 2 * y) + 2] == 100);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,104 @@
+#include "cgp/07_image/image.hpp"
+#include "cgp/01_base/base.hpp"
+
+#if defined(__linux__) || defined(__EMSCRIPTEN__)
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#endif
+
+namespace cgp_test
+{
+	// Image with a distinct value for each component of each pixel
+	static cgp::image_structure numbered_image(int width, int height, cgp::image_color_type color_type)
+	{
+		int const d = (color_type == cgp::image_color_type::rgba ? 4 : 3);
+		cgp::image_structure im;
+		im.width = width;
+		im.height = height;
+		im.color_type = color_type;
+		im.data.resize(d * width * height);
+		for (int k = 0; k < d * width * height; ++k)
+			im.data[k] = (unsigned char)((7 * k + 3) % 251);
+		return im;
+	}
+
+	static bool same_image(cgp::image_structure const& a, cgp::image_structure const& b)
+	{
+		return a.width == b.width && a.height == b.height && a.color_type == b.color_type && a.data.data == b.data.data;
+	}
+
+	// Component kd of the pixel (x,y)
+	static unsigned char component(cgp::image_structure const& im, int x, int y, int kd)
+	{
+		int const d = (im.color_type == cgp::image_color_type::rgba ? 4 : 3);
+		return im.data[d * (x + im.width * y) + kd];
+	}
+
+	static void test_image_transform_type(cgp::image_color_type color_type)
+	{
+		int const d = (color_type == cgp::image_color_type::rgba ? 4 : 3);
+
+		// Size larger than a tile of the copy, and not a multiple of it
+		int const W = 45;
+		int const H = 37;
+		cgp::image_structure const im = numbered_image(W, H, color_type);
+
+		cgp::image_structure const mh = im.mirror_horizontal();
+		cgp::image_structure const mv = im.mirror_vertical();
+		cgp::image_structure const ccw = im.rotate_90_degrees_counterclockwise();
+		cgp::image_structure const cw = im.rotate_90_degrees_clockwise();
+		assert_cgp_no_msg(ccw.width == H && ccw.height == W);
+		assert_cgp_no_msg(cw.width == H && cw.height == W);
+		for (int y = 0; y < H; ++y) {
+			for (int x = 0; x < W; ++x) {
+				for (int kd = 0; kd < d; ++kd) {
+					unsigned char const value = component(im, x, y, kd);
+					assert_cgp_no_msg(component(mh, W - 1 - x, y, kd) == value);
+					assert_cgp_no_msg(component(mv, x, H - 1 - y, kd) == value);
+					assert_cgp_no_msg(component(ccw, y, W - 1 - x, kd) == value);
+					assert_cgp_no_msg(component(cw, H - 1 - y, x, kd) == value);
+				}
+			}
+		}
+
+		// Sub-image, and chained views (single copy at the end)
+		cgp::image_structure const sub = im.subimage(3, 5, 20, 31);
+		assert_cgp_no_msg(sub.width == 17 && sub.height == 26);
+		assert_cgp_no_msg(component(sub, 0, 0, 0) == component(im, 3, 5, 0));
+		assert_cgp_no_msg(component(sub, 16, 25, d - 1) == component(im, 19, 30, d - 1));
+		assert_cgp_no_msg(same_image(im.view().subimage(3, 5, 20, 31).mirror_vertical().rotate_90_degrees_clockwise().to_image(), sub.mirror_vertical().rotate_90_degrees_clockwise()));
+		assert_cgp_no_msg(same_image(im.view().mirror_horizontal().mirror_horizontal().to_image(), im));
+
+		// Split
+		cgp::image_structure const grid = numbered_image(12, 9, color_type);
+		std::vector<cgp::image_structure> const parts = cgp::image_split_grid(grid, 4, 3);
+		std::vector<cgp::image_view_structure> const views = cgp::image_split_grid_view(grid, 4, 3);
+		assert_cgp_no_msg(parts.size() == 12 && views.size() == 12);
+		assert_cgp_no_msg(same_image(parts[7], grid.subimage(6, 3, 9, 6)));
+		assert_cgp_no_msg(views[7].data == grid.view().pixel(6, 3));
+		assert_cgp_no_msg(same_image(views[7].to_image(), parts[7]));
+
+		// In place variants (square and non-square images)
+		int const sizes[2][2] = { {W, H}, {33, 33} };
+		for (int ks = 0; ks < 2; ++ks) {
+			cgp::image_structure const ref = numbered_image(sizes[ks][0], sizes[ks][1], color_type);
+			cgp::image_structure tmp = ref;
+			tmp.mirror_horizontal_in_place();
+			assert_cgp_no_msg(same_image(tmp, ref.mirror_horizontal()));
+			tmp = ref;
+			tmp.mirror_vertical_in_place();
+			assert_cgp_no_msg(same_image(tmp, ref.mirror_vertical()));
+			tmp = ref;
+			tmp.rotate_90_degrees_counterclockwise_in_place();
+			assert_cgp_no_msg(same_image(tmp, ref.rotate_90_degrees_counterclockwise()));
+			tmp = ref;
+			tmp.rotate_90_degrees_clockwise_in_place();
+			assert_cgp_no_msg(same_image(tmp, ref.rotate_90_degrees_clockwise()));
+		}
+	}
+
+	void test_image_transform()
+	{
+		test_image_transform_type(cgp::image_color_type::rgb);
+		test_image_transform_type(cgp::image_color_type::rgba);
+	}
+}
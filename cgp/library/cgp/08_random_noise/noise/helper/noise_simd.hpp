@@ -0,0 +1,363 @@
+#pragma once
+
+// Internal helper of noise.cpp: simplex noise evaluated on several points at once (SIMD lanes)
+//
+// The kernels are written once over a "pack" of values, with three implementations of the pack:
+//  - noise_pack_avx2  : 8 lanes, when the library is compiled with AVX2 enabled (ex. -mavx2 or /arch:AVX2)
+//  - noise_pack_sse2  : 4 lanes, available on every x86-64 compiler
+//  - noise_pack_scalar: 1 lane, fallback for the other architectures
+// noise_pack is the best one available at compile time.
+//
+// The kernels follow the steps of snoise2/snoise3 (third_party/simplexnoise) in single precision: the results are
+// equal to the scalar functions up to float rounding.
+
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CGP_NOISE_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CGP_NOISE_SSE2
+#endif
+
+// Permutation table of the scalar simplex noise (third_party/src/simplexnoise/simplexnoise1234.cpp)
+extern unsigned char perm[512];
+
+namespace cgp
+{
+namespace detail
+{
+
+    // Permutation table as int (used by the gather instructions)
+    inline int const* noise_permutation_table()
+    {
+        struct table_structure {
+            int value[512];
+            table_structure() { for (int k = 0; k < 512; ++k) value[k] = perm[k]; }
+        };
+        static table_structure const table;
+        return table.value;
+    }
+
+
+    /* ************************************************** */
+    /*           Scalar                                   */
+    /* ************************************************** */
+
+    struct noise_pack_scalar
+    {
+        static int const width = 1;
+        typedef float F; // float values
+        typedef int I;   // int values, or masks (all bits set = true)
+
+        static F load(float const* p) { return *p; }
+        static void store(float* p, F a) { *p = a; }
+        static F set(float a) { return a; }
+        static I set_int(int a) { return a; }
+
+        static F to_float(I a) { return float(a); }
+        // Same rounding as FASTFLOOR of the scalar noise (including its value for negative integers)
+        static I fast_floor(F a) { return a > 0 ? int(a) : int(a) - 1; }
+
+        static I greater(F a, F b) { return a > b ? -1 : 0; }
+        static I greater_equal(F a, F b) { return a >= b ? -1 : 0; }
+        static I equal(I a, I b) { return a == b ? -1 : 0; }
+        static I and_not(I a, I b) { return ~a & b; }       // (not a) and b
+        static F select(I mask, F a, F b) { return mask ? a : b; }
+        static F negate_if(I mask, F a) { return mask ? -a : a; }
+        static F max(F a, F b) { return a > b ? a : b; }
+
+        static I permutation(I index) { return perm[index]; }
+    };
+
+
+#if defined(CGP_NOISE_SSE2)
+
+    /* ************************************************** */
+    /*           SSE2                                     */
+    /* ************************************************** */
+
+    struct noise_pack_sse2
+    {
+        static int const width = 4;
+        struct F { __m128 v; };
+        struct I { __m128i v; };
+
+        static F load(float const* p) { return { _mm_loadu_ps(p) }; }
+        static void store(float* p, F a) { _mm_storeu_ps(p, a.v); }
+        static F set(float a) { return { _mm_set1_ps(a) }; }
+        static I set_int(int a) { return { _mm_set1_epi32(a) }; }
+
+        static F to_float(I a) { return { _mm_cvtepi32_ps(a.v) }; }
+        static I fast_floor(F a)
+        {
+            // truncation, minus one where a<=0
+            __m128i const t = _mm_cvttps_epi32(a.v);
+            __m128i const non_positive = _mm_castps_si128(_mm_cmple_ps(a.v, _mm_setzero_ps()));
+            return { _mm_add_epi32(t, non_positive) };
+        }
+
+        static I greater(F a, F b) { return { _mm_castps_si128(_mm_cmpgt_ps(a.v, b.v)) }; }
+        static I greater_equal(F a, F b) { return { _mm_castps_si128(_mm_cmpge_ps(a.v, b.v)) }; }
+        static I equal(I a, I b) { return { _mm_cmpeq_epi32(a.v, b.v) }; }
+        static I and_not(I a, I b) { return { _mm_andnot_si128(a.v, b.v) }; }
+        static F select(I mask, F a, F b)
+        {
+            __m128 const m = _mm_castsi128_ps(mask.v);
+            return { _mm_or_ps(_mm_and_ps(m, a.v), _mm_andnot_ps(m, b.v)) };
+        }
+        static F negate_if(I mask, F a)
+        {
+            __m128i const sign = _mm_and_si128(mask.v, _mm_set1_epi32(int(0x80000000)));
+            return { _mm_xor_ps(a.v, _mm_castsi128_ps(sign)) };
+        }
+        static F max(F a, F b) { return { _mm_max_ps(a.v, b.v) }; }
+
+        static I permutation(I index)
+        {
+            alignas(16) int k[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(k), index.v);
+            return { _mm_setr_epi32(perm[k[0]], perm[k[1]], perm[k[2]], perm[k[3]]) };
+        }
+    };
+
+    inline noise_pack_sse2::F operator+(noise_pack_sse2::F a, noise_pack_sse2::F b) { return { _mm_add_ps(a.v, b.v) }; }
+    inline noise_pack_sse2::F operator-(noise_pack_sse2::F a, noise_pack_sse2::F b) { return { _mm_sub_ps(a.v, b.v) }; }
+    inline noise_pack_sse2::F operator*(noise_pack_sse2::F a, noise_pack_sse2::F b) { return { _mm_mul_ps(a.v, b.v) }; }
+    inline noise_pack_sse2::I operator+(noise_pack_sse2::I a, noise_pack_sse2::I b) { return { _mm_add_epi32(a.v, b.v) }; }
+    inline noise_pack_sse2::I operator&(noise_pack_sse2::I a, noise_pack_sse2::I b) { return { _mm_and_si128(a.v, b.v) }; }
+    inline noise_pack_sse2::I operator|(noise_pack_sse2::I a, noise_pack_sse2::I b) { return { _mm_or_si128(a.v, b.v) }; }
+
+    typedef noise_pack_sse2 noise_pack;
+
+#elif defined(CGP_NOISE_AVX2)
+
+    /* ************************************************** */
+    /*           AVX2                                     */
+    /* ************************************************** */
+
+    struct noise_pack_avx2
+    {
+        static int const width = 8;
+        struct F { __m256 v; };
+        struct I { __m256i v; };
+
+        static F load(float const* p) { return { _mm256_loadu_ps(p) }; }
+        static void store(float* p, F a) { _mm256_storeu_ps(p, a.v); }
+        static F set(float a) { return { _mm256_set1_ps(a) }; }
+        static I set_int(int a) { return { _mm256_set1_epi32(a) }; }
+
+        static F to_float(I a) { return { _mm256_cvtepi32_ps(a.v) }; }
+        static I fast_floor(F a)
+        {
+            // truncation, minus one where a<=0
+            __m256i const t = _mm256_cvttps_epi32(a.v);
+            __m256i const non_positive = _mm256_castps_si256(_mm256_cmp_ps(a.v, _mm256_setzero_ps(), _CMP_LE_OQ));
+            return { _mm256_add_epi32(t, non_positive) };
+        }
+
+        static I greater(F a, F b) { return { _mm256_castps_si256(_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)) }; }
+        static I greater_equal(F a, F b) { return { _mm256_castps_si256(_mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ)) }; }
+        static I equal(I a, I b) { return { _mm256_cmpeq_epi32(a.v, b.v) }; }
+        static I and_not(I a, I b) { return { _mm256_andnot_si256(a.v, b.v) }; }
+        static F select(I mask, F a, F b) { return { _mm256_blendv_ps(b.v, a.v, _mm256_castsi256_ps(mask.v)) }; }
+        static F negate_if(I mask, F a)
+        {
+            __m256i const sign = _mm256_and_si256(mask.v, _mm256_set1_epi32(int(0x80000000)));
+            return { _mm256_xor_ps(a.v, _mm256_castsi256_ps(sign)) };
+        }
+        static F max(F a, F b) { return { _mm256_max_ps(a.v, b.v) }; }
+
+        static I permutation(I index) { return { _mm256_i32gather_epi32(noise_permutation_table(), index.v, 4) }; }
+    };
+
+    inline noise_pack_avx2::F operator+(noise_pack_avx2::F a, noise_pack_avx2::F b) { return { _mm256_add_ps(a.v, b.v) }; }
+    inline noise_pack_avx2::F operator-(noise_pack_avx2::F a, noise_pack_avx2::F b) { return { _mm256_sub_ps(a.v, b.v) }; }
+    inline noise_pack_avx2::F operator*(noise_pack_avx2::F a, noise_pack_avx2::F b) { return { _mm256_mul_ps(a.v, b.v) }; }
+    inline noise_pack_avx2::I operator+(noise_pack_avx2::I a, noise_pack_avx2::I b) { return { _mm256_add_epi32(a.v, b.v) }; }
+    inline noise_pack_avx2::I operator&(noise_pack_avx2::I a, noise_pack_avx2::I b) { return { _mm256_and_si256(a.v, b.v) }; }
+    inline noise_pack_avx2::I operator|(noise_pack_avx2::I a, noise_pack_avx2::I b) { return { _mm256_or_si256(a.v, b.v) }; }
+
+    typedef noise_pack_avx2 noise_pack;
+
+#else
+
+    typedef noise_pack_scalar noise_pack;
+
+#endif
+
+
+    /* ************************************************** */
+    /*           Kernels                                  */
+    /* ************************************************** */
+
+    // Noise contribution of a simplex corner: max(r2-d^2,0)^4 * gradient
+    template <typename P>
+    typename P::F noise_simplex_corner(typename P::F r2, typename P::F d2, typename P::F gradient)
+    {
+        typename P::F t = P::max(r2 - d2, P::set(0.0f));
+        t = t * t;
+        return t * t * gradient;
+    }
+
+    // Same as grad2 of the scalar noise
+    template <typename P>
+    typename P::F noise_simplex_gradient(typename P::I hash, typename P::F x, typename P::F y)
+    {
+        typedef typename P::I I;
+        I const use_y = P::equal(hash & P::set_int(4), P::set_int(4)); // h>=4 (h = hash&7)
+        typename P::F const u = P::select(use_y, y, x);
+        typename P::F const v = P::select(use_y, x, y);
+        return P::negate_if(P::equal(hash & P::set_int(1), P::set_int(1)), u)
+            + P::negate_if(P::equal(hash & P::set_int(2), P::set_int(2)), P::set(2.0f) * v);
+    }
+
+    // Same as grad3 of the scalar noise
+    template <typename P>
+    typename P::F noise_simplex_gradient(typename P::I hash, typename P::F x, typename P::F y, typename P::F z)
+    {
+        typedef typename P::I I;
+        I const h = hash & P::set_int(15);
+        I const h_ge_8 = P::equal(h & P::set_int(8), P::set_int(8));
+        I const h_lt_4 = P::equal(h & P::set_int(12), P::set_int(0));
+        I const h_12_14 = P::equal(h & P::set_int(13), P::set_int(12)); // h==12 || h==14
+        typename P::F const u = P::select(h_ge_8, y, x);
+        typename P::F const v = P::select(h_lt_4, y, P::select(h_12_14, x, z));
+        return P::negate_if(P::equal(h & P::set_int(1), P::set_int(1)), u)
+            + P::negate_if(P::equal(h & P::set_int(2), P::set_int(2)), v);
+    }
+
+    // Simplex noise in 2D, in [-1,1] (snoise2)
+    template <typename P>
+    typename P::F noise_simplex(typename P::F x, typename P::F y)
+    {
+        typedef typename P::F F;
+        typedef typename P::I I;
+        float const F2 = 0.366025403f;
+        float const G2 = 0.211324865f;
+
+        // Skew the input space to find the simplex cell
+        F const s = (x + y) * P::set(F2);
+        I const i = P::fast_floor(x + s);
+        I const j = P::fast_floor(y + s);
+        F const t = P::to_float(i + j) * P::set(G2);
+        F const x0 = x - (P::to_float(i) - t);
+        F const y0 = y - (P::to_float(j) - t);
+
+        // Lower triangle (1,0) if x0>y0, upper triangle (0,1) otherwise
+        I const lower = P::greater(x0, y0);
+        I const one = P::set_int(1);
+        I const i1 = lower & one;
+        I const j1 = P::and_not(lower, one);
+
+        F const x1 = x0 - P::to_float(i1) + P::set(G2);
+        F const y1 = y0 - P::to_float(j1) + P::set(G2);
+        F const x2 = x0 - P::set(1.0f - 2.0f * G2);
+        F const y2 = y0 - P::set(1.0f - 2.0f * G2);
+
+        I const ii = i & P::set_int(255);
+        I const jj = j & P::set_int(255);
+        I const h0 = P::permutation(ii + P::permutation(jj));
+        I const h1 = P::permutation(ii + i1 + P::permutation(jj + j1));
+        I const h2 = P::permutation(ii + one + P::permutation(jj + one));
+
+        F const r2 = P::set(0.5f);
+        F const n0 = noise_simplex_corner<P>(r2, x0 * x0 + y0 * y0, noise_simplex_gradient<P>(h0, x0, y0));
+        F const n1 = noise_simplex_corner<P>(r2, x1 * x1 + y1 * y1, noise_simplex_gradient<P>(h1, x1, y1));
+        F const n2 = noise_simplex_corner<P>(r2, x2 * x2 + y2 * y2, noise_simplex_gradient<P>(h2, x2, y2));
+
+        return P::set(40.0f) * (n0 + n1 + n2);
+    }
+
+    // Simplex noise in 3D, in [-1,1] (snoise3)
+    template <typename P>
+    typename P::F noise_simplex(typename P::F x, typename P::F y, typename P::F z)
+    {
+        typedef typename P::F F;
+        typedef typename P::I I;
+        float const F3 = 0.333333333f;
+        float const G3 = 0.166666667f;
+
+        // Skew the input space to find the simplex cell
+        F const s = (x + y + z) * P::set(F3);
+        I const i = P::fast_floor(x + s);
+        I const j = P::fast_floor(y + s);
+        I const k = P::fast_floor(z + s);
+        F const t = P::to_float(i + j + k) * P::set(G3);
+        F const x0 = x - (P::to_float(i) - t);
+        F const y0 = y - (P::to_float(j) - t);
+        F const z0 = z - (P::to_float(k) - t);
+
+        // Second and third corners of the simplex, from the order of x0, y0, z0 (same choices as the branches of snoise3)
+        I const xy = P::greater_equal(x0, y0);
+        I const yz = P::greater_equal(y0, z0);
+        I const xz = P::greater_equal(x0, z0);
+        I const one = P::set_int(1);
+        I const i1 = xy & xz & one;
+        I const j1 = P::and_not(xy, yz) & one;
+        I const k1 = P::and_not(xz | yz, one);
+        I const i2 = (xy | xz) & one;
+        I const j2 = P::and_not(P::and_not(yz, xy), one);
+        I const k2 = P::and_not(xz & yz, one);
+
+        F const x1 = x0 - P::to_float(i1) + P::set(G3);
+        F const y1 = y0 - P::to_float(j1) + P::set(G3);
+        F const z1 = z0 - P::to_float(k1) + P::set(G3);
+        F const x2 = x0 - P::to_float(i2) + P::set(2.0f * G3);
+        F const y2 = y0 - P::to_float(j2) + P::set(2.0f * G3);
+        F const z2 = z0 - P::to_float(k2) + P::set(2.0f * G3);
+        F const x3 = x0 - P::set(1.0f - 3.0f * G3);
+        F const y3 = y0 - P::set(1.0f - 3.0f * G3);
+        F const z3 = z0 - P::set(1.0f - 3.0f * G3);
+
+        I const ii = i & P::set_int(255);
+        I const jj = j & P::set_int(255);
+        I const kk = k & P::set_int(255);
+        I const h0 = P::permutation(ii + P::permutation(jj + P::permutation(kk)));
+        I const h1 = P::permutation(ii + i1 + P::permutation(jj + j1 + P::permutation(kk + k1)));
+        I const h2 = P::permutation(ii + i2 + P::permutation(jj + j2 + P::permutation(kk + k2)));
+        I const h3 = P::permutation(ii + one + P::permutation(jj + one + P::permutation(kk + one)));
+
+        F const r2 = P::set(0.6f);
+        F const n0 = noise_simplex_corner<P>(r2, x0 * x0 + y0 * y0 + z0 * z0, noise_simplex_gradient<P>(h0, x0, y0, z0));
+        F const n1 = noise_simplex_corner<P>(r2, x1 * x1 + y1 * y1 + z1 * z1, noise_simplex_gradient<P>(h1, x1, y1, z1));
+        F const n2 = noise_simplex_corner<P>(r2, x2 * x2 + y2 * y2 + z2 * z2, noise_simplex_gradient<P>(h2, x2, y2, z2));
+        F const n3 = noise_simplex_corner<P>(r2, x3 * x3 + y3 * y3 + z3 * z3, noise_simplex_gradient<P>(h3, x3, y3, z3));
+
+        return P::set(32.0f) * (n0 + n1 + n2 + n3);
+    }
+
+    // Sum of the octaves, as noise_perlin(vec2) and noise_perlin(vec3)
+    template <typename P>
+    typename P::F noise_perlin_pack(typename P::F x, typename P::F y, int octave, float persistency, float frequency_gain)
+    {
+        typename P::F value = P::set(0.0f);
+        float a = 1.0f;
+        float f = 1.0f;
+        for (int k = 0; k < octave; k++) {
+            typename P::F const n = noise_simplex<P>(x * P::set(f), y * P::set(f));
+            value = value + P::set(a) * (P::set(0.5f) + P::set(0.5f) * n);
+            f *= frequency_gain;
+            a *= persistency;
+        }
+        return value;
+    }
+
+    template <typename P>
+    typename P::F noise_perlin_pack(typename P::F x, typename P::F y, typename P::F z, int octave, float persistency, float frequency_gain)
+    {
+        typename P::F value = P::set(0.0f);
+        float a = 1.0f;
+        float f = 1.0f;
+        for (int k = 0; k < octave; k++) {
+            typename P::F const n = noise_simplex<P>(x * P::set(f), y * P::set(f), z * P::set(f));
+            value = value + P::set(a) * (P::set(0.5f) + P::set(0.5f) * n);
+            f *= frequency_gain;
+            a *= persistency;
+        }
+        return value;
+    }
+
+}
+}
@@ -2,6 +2,9 @@
 
 #include "third_party/src/simplexnoise/simplexnoise1234.hpp"
 #include "cgp/01_base/base.hpp"
+#include "helper/noise_simd.hpp"
+
+#include <algorithm>
 
 namespace cgp
 {
@@ -50,4 +53,164 @@ namespace cgp
         return value;
     }
 
-}
\ No newline at end of file
+
+
+    // Batch evaluation
+    // ******************************************** //
+
+    namespace
+    {
+        typedef detail::noise_pack pack;
+
+        // Number of points processed together by a thread (coordinates stored in local buffers)
+        int const noise_chunk_size = 256;
+
+        // values[k] = noise at (x[k],y[k]) for k<N<=noise_chunk_size
+        void noise_perlin_chunk(float* values, float const* x, float const* y, int N, int octave, float persistency, float frequency_gain)
+        {
+            int const W = pack::width;
+            int k = 0;
+            for (; k + W <= N; k += W)
+                pack::store(values + k, detail::noise_perlin_pack<pack>(pack::load(x + k), pack::load(y + k), octave, persistency, frequency_gain));
+
+            // Last incomplete pack: padded with the last point
+            if (k < N) {
+                float xp[W], yp[W], vp[W];
+                for (int i = 0; i < W; ++i) {
+                    int const idx = std::min(k + i, N - 1);
+                    xp[i] = x[idx];
+                    yp[i] = y[idx];
+                }
+                pack::store(vp, detail::noise_perlin_pack<pack>(pack::load(xp), pack::load(yp), octave, persistency, frequency_gain));
+                for (int i = 0; k + i < N; ++i)
+                    values[k + i] = vp[i];
+            }
+        }
+
+        void noise_perlin_chunk(float* values, float const* x, float const* y, float const* z, int N, int octave, float persistency, float frequency_gain)
+        {
+            int const W = pack::width;
+            int k = 0;
+            for (; k + W <= N; k += W)
+                pack::store(values + k, detail::noise_perlin_pack<pack>(pack::load(x + k), pack::load(y + k), pack::load(z + k), octave, persistency, frequency_gain));
+
+            if (k < N) {
+                float xp[W], yp[W], zp[W], vp[W];
+                for (int i = 0; i < W; ++i) {
+                    int const idx = std::min(k + i, N - 1);
+                    xp[i] = x[idx];
+                    yp[i] = y[idx];
+                    zp[i] = z[idx];
+                }
+                pack::store(vp, detail::noise_perlin_pack<pack>(pack::load(xp), pack::load(yp), pack::load(zp), octave, persistency, frequency_gain));
+                for (int i = 0; k + i < N; ++i)
+                    values[k + i] = vp[i];
+            }
+        }
+
+        // Coordinate of the sample k among N regularly spaced in [a,b]
+        float noise_sample_coordinate(int k, int N, float a, float b)
+        {
+            float const u = N > 1 ? k / (N - 1.0f) : 0.0f;
+            return a + u * (b - a);
+        }
+    }
+
+    void noise_perlin(grid_2D<float>& values, vec2 const& p_min, vec2 const& p_max, int octave, float persistency, float frequency_gain)
+    {
+        int const Nx = values.dimension.x;
+        int const Ny = values.dimension.y;
+        float* data = values.data.data.data();
+
+        #pragma omp parallel for schedule(static) if(Ny>1 && Nx*Ny>4096)
+        for (int ky = 0; ky < Ny; ++ky) {
+            float x[noise_chunk_size], y[noise_chunk_size];
+            float const y_row = noise_sample_coordinate(ky, Ny, p_min.y, p_max.y);
+            for (int kx0 = 0; kx0 < Nx; kx0 += noise_chunk_size) {
+                int const N = std::min(noise_chunk_size, Nx - kx0);
+                for (int k = 0; k < N; ++k) {
+                    x[k] = noise_sample_coordinate(kx0 + k, Nx, p_min.x, p_max.x);
+                    y[k] = y_row;
+                }
+                noise_perlin_chunk(data + kx0 + Nx * ky, x, y, N, octave, persistency, frequency_gain);
+            }
+        }
+    }
+
+    void noise_perlin(grid_3D<float>& values, vec3 const& p_min, vec3 const& p_max, int octave, float persistency, float frequency_gain)
+    {
+        int const Nx = values.dimension.x;
+        int const Ny = values.dimension.y;
+        int const Nz = values.dimension.z;
+        int const N_row = Ny * Nz;
+        float* data = values.data.data.data();
+
+        #pragma omp parallel for schedule(static) if(N_row>1 && Nx*N_row>4096)
+        for (int row = 0; row < N_row; ++row) {
+            float x[noise_chunk_size], y[noise_chunk_size], z[noise_chunk_size];
+            int const ky = row % Ny;
+            int const kz = row / Ny;
+            float const y_row = noise_sample_coordinate(ky, Ny, p_min.y, p_max.y);
+            float const z_row = noise_sample_coordinate(kz, Nz, p_min.z, p_max.z);
+            for (int kx0 = 0; kx0 < Nx; kx0 += noise_chunk_size) {
+                int const N = std::min(noise_chunk_size, Nx - kx0);
+                for (int k = 0; k < N; ++k) {
+                    x[k] = noise_sample_coordinate(kx0 + k, Nx, p_min.x, p_max.x);
+                    y[k] = y_row;
+                    z[k] = z_row;
+                }
+                noise_perlin_chunk(data + kx0 + Nx * row, x, y, z, N, octave, persistency, frequency_gain);
+            }
+        }
+    }
+
+    void noise_perlin(float* values, vec2 const* p, int N, int octave, float persistency, float frequency_gain)
+    {
+        int const N_chunk = (N + noise_chunk_size - 1) / noise_chunk_size;
+
+        #pragma omp parallel for schedule(static) if(N>4096)
+        for (int chunk = 0; chunk < N_chunk; ++chunk) {
+            float x[noise_chunk_size], y[noise_chunk_size];
+            int const k0 = chunk * noise_chunk_size;
+            int const N_local = std::min(noise_chunk_size, N - k0);
+            for (int k = 0; k < N_local; ++k) {
+                x[k] = p[k0 + k].x;
+                y[k] = p[k0 + k].y;
+            }
+            noise_perlin_chunk(values + k0, x, y, N_local, octave, persistency, frequency_gain);
+        }
+    }
+
+    void noise_perlin(float* values, vec3 const* p, int N, int octave, float persistency, float frequency_gain)
+    {
+        int const N_chunk = (N + noise_chunk_size - 1) / noise_chunk_size;
+
+        #pragma omp parallel for schedule(static) if(N>4096)
+        for (int chunk = 0; chunk < N_chunk; ++chunk) {
+            float x[noise_chunk_size], y[noise_chunk_size], z[noise_chunk_size];
+            int const k0 = chunk * noise_chunk_size;
+            int const N_local = std::min(noise_chunk_size, N - k0);
+            for (int k = 0; k < N_local; ++k) {
+                x[k] = p[k0 + k].x;
+                y[k] = p[k0 + k].y;
+                z[k] = p[k0 + k].z;
+            }
+            noise_perlin_chunk(values + k0, x, y, z, N_local, octave, persistency, frequency_gain);
+        }
+    }
+
+    numarray<float> noise_perlin(numarray<vec2> const& p, int octave, float persistency, float frequency_gain)
+    {
+        numarray<float> values(p.size());
+        noise_perlin(values.data.data(), p.data.data(), int(p.size()), octave, persistency, frequency_gain);
+        return values;
+    }
+
+    numarray<float> noise_perlin(numarray<vec3> const& p, int octave, float persistency, float frequency_gain)
+    {
+        numarray<float> values(p.size());
+        noise_perlin(values.data.data(), p.data.data(), int(p.size()), octave, persistency, frequency_gain);
+        return values;
+    }
+
+}
@@ -1,10 +1,29 @@
 #pragma once
 
 #include "cgp/05_vec/vec.hpp"
+#include "cgp/04_grid_container/grid/grid.hpp"
 
 namespace cgp
 {
 	float noise_perlin(float x,       int octave=5, float persistency=0.3f, float frequency_gain=2.0f);
 	float noise_perlin(vec2 const& p, int octave=5, float persistency=0.3f, float frequency_gain=2.0f);
 	float noise_perlin(vec3 const& p, int octave=5, float persistency=0.3f, float frequency_gain=2.0f);
-}
\ No newline at end of file
+
+	/** Batch evaluation of noise_perlin over many points
+	 * Same values as calling noise_perlin(p) on each point (up to float rounding), but several points are computed at once
+	 * using the SIMD instructions (SSE2, or AVX2 if enabled at compilation), and the rows are distributed over the threads (OpenMP).
+	 * Note: the 3D simplex noise is slightly discontinuous across the simplex boundaries. For points exactly on a boundary
+	 *  (ex. regular lattices with round coordinates) the rounding may select the neighboring simplex: difference up to ~1e-3. */
+
+	// Fill the grid with the noise at the samples of the rectangle [p_min,p_max]:
+	//  values(kx,ky) = noise_perlin( p_min + {kx/(Nx-1), ky/(Ny-1)} * (p_max-p_min) )
+	void noise_perlin(grid_2D<float>& values, vec2 const& p_min, vec2 const& p_max, int octave=5, float persistency=0.3f, float frequency_gain=2.0f);
+	// Fill the grid with the noise at the samples of the box [p_min,p_max]
+	void noise_perlin(grid_3D<float>& values, vec3 const& p_min, vec3 const& p_max, int octave=5, float persistency=0.3f, float frequency_gain=2.0f);
+
+	// values[k] = noise_perlin(p[k]) for the N points p
+	void noise_perlin(float* values, vec2 const* p, int N, int octave=5, float persistency=0.3f, float frequency_gain=2.0f);
+	void noise_perlin(float* values, vec3 const* p, int N, int octave=5, float persistency=0.3f, float frequency_gain=2.0f);
+	numarray<float> noise_perlin(numarray<vec2> const& p, int octave=5, float persistency=0.3f, float frequency_gain=2.0f);
+	numarray<float> noise_perlin(numarray<vec3> const& p, int octave=5, float persistency=0.3f, float frequency_gain=2.0f);
+}
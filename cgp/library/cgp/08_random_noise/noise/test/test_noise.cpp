@@ -0,0 +1,68 @@
+#include "cgp/08_random_noise/noise/noise.hpp"
+
+#include <cmath>
+
+#if defined(__linux__) || defined(__EMSCRIPTEN__)
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#endif
+
+namespace cgp_test
+{
+
+	void test_noise()
+	{
+		// The batch evaluation is computed in single precision: same values as the scalar one up to rounding
+		float const tolerance = 1e-4f;
+
+		// Grid 2D (including negative coordinates and a size that is not a multiple of the SIMD width)
+		{
+			cgp::vec2 const p_min = { -3.7f, -1.2f };
+			cgp::vec2 const p_max = { 5.1f, 2.9f };
+			cgp::grid_2D<float> values(67, 41);
+			cgp::noise_perlin(values, p_min, p_max, 6, 0.4f, 2.1f);
+			for (int ky = 0; ky < 41; ++ky) {
+				for (int kx = 0; kx < 67; ++kx) {
+					cgp::vec2 const u = { kx / 66.0f, ky / 40.0f };
+					float const expected = cgp::noise_perlin(p_min + u * (p_max - p_min), 6, 0.4f, 2.1f);
+					assert_cgp_no_msg(std::abs(values(kx, ky) - expected) < tolerance);
+				}
+			}
+		}
+
+		// Grid 3D
+		//  (coordinates chosen away from the exact simplex boundaries, where the rounding may select the neighboring simplex)
+		{
+			cgp::vec3 const p_min = { -3.17f, 0.291f, -2.53f };
+			cgp::vec3 const p_max = { 2.3f, 1.87f, 0.71f };
+			cgp::grid_3D<float> values(13, 9, 11);
+			cgp::noise_perlin(values, p_min, p_max, 4, 0.35f, 2.0f);
+			for (int kz = 0; kz < 11; ++kz) {
+				for (int ky = 0; ky < 9; ++ky) {
+					for (int kx = 0; kx < 13; ++kx) {
+						cgp::vec3 const u = { kx / 12.0f, ky / 8.0f, kz / 10.0f };
+						float const expected = cgp::noise_perlin(p_min + u * (p_max - p_min), 4, 0.35f, 2.0f);
+						assert_cgp_no_msg(std::abs(values(kx, ky, kz) - expected) < tolerance);
+					}
+				}
+			}
+		}
+
+		// Points
+		{
+			cgp::numarray<cgp::vec2> p2;
+			cgp::numarray<cgp::vec3> p3;
+			for (int k = 0; k < 1001; ++k) {
+				float const t = 0.37f * k - 150.0f;
+				p2.push_back({ t, std::sin(t) * 20.0f });
+				p3.push_back({ std::cos(t) * 10.0f, t, 0.01f * t * t });
+			}
+			cgp::numarray<float> const v2 = cgp::noise_perlin(p2);
+			cgp::numarray<float> const v3 = cgp::noise_perlin(p3);
+			for (int k = 0; k < 1001; ++k) {
+				assert_cgp_no_msg(std::abs(v2[k] - cgp::noise_perlin(p2[k])) < tolerance);
+				assert_cgp_no_msg(std::abs(v3[k] - cgp::noise_perlin(p3[k])) < tolerance);
+			}
+		}
+	}
+
+}
@@ -3,9 +3,23 @@
 
 
 #include <set>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace cgp
 {
+	static int omp_max_threads()
+	{
+#ifdef _OPENMP
+		return omp_get_max_threads();
+#else
+		return 1;
+#endif
+	}
+
 	mesh& mesh::fill_empty_field()
 	{
 		size_t const N = position.size();
@@ -45,7 +59,8 @@ namespace cgp
 	}
 
 
-	void normal_per_vertex(numarray<vec3> const& position, numarray<uint3> const& connectivity, numarray<vec3>& normals, bool invert)
+	// Sequential version: the normal of each triangle is directly accumulated in its vertices
+	static void normal_per_vertex_sequential(numarray<vec3> const& position, numarray<uint3> const& connectivity, numarray<vec3>& normals, bool invert)
 	{
 		size_t const N = position.size();
 		if(normals.size()!=N)
@@ -87,8 +102,6 @@ namespace cgp
 					for(unsigned int idx : face)
 						normals.at(idx) += n_unit;
 				}
-
-
 			}
 		}
 
@@ -103,8 +116,133 @@ namespace cgp
 
 		// Invert normals if asked
 		if(invert) for(auto& n : normals) n = -n;
+	}
+
+	void normal_per_vertex(numarray<vec3> const& position, numarray<uint3> const& connectivity, numarray<vec3>& normals, bool invert)
+	{
+		int const N = int(position.size());
+		int const N_tri = int(connectivity.size());
+
+		// The parallel version needs the adjacency of the vertices: only worth it with several threads and large meshes
+		if (omp_max_threads() == 1 || N_tri <= 4096) {
+			normal_per_vertex_sequential(position, connectivity, normals, invert);
+			return;
+		}
+
+		normals.resize(N);
+
+		// Unit normal of each triangle (independent per triangle)
+		//  (only if the triangle is not degenerated: norm of edges>0, edges not aligned)
+		numarray<vec3> face_normal(N_tri);
+		std::vector<char> face_valid(N_tri);
+		#pragma omp parallel for schedule(static) if(N_tri>4096)
+		for (int k_tri = 0; k_tri < N_tri; ++k_tri)
+		{
+			uint3 const& face = connectivity.at(k_tri);
+			face_valid[k_tri] = 0;
+			if (get<0>(face) >= unsigned(N) || get<1>(face) >= unsigned(N) || get<2>(face) >= unsigned(N))
+				continue; // reported below
+
+			vec3 const& p0 = position.at(get<0>(face));
+			vec3 const& p1 = position.at(get<1>(face));
+			vec3 const& p2 = position.at(get<2>(face));
+
+			// compute normal of the triangle
+			vec3 const p10 = p1-p0;
+			vec3 const p20 = p2-p0;
+
+			float const L10 = norm(p10);
+			float const L20 = norm(p20);
+
+			if (L10 > 1e-6f && L20 > 1e-6f)
+			{
+				vec3 const n = cross(p10/L10, p20/L20);
+				float const Ln = norm(n);
+
+				if (Ln > 1e-6f)
+				{
+					face_normal.at(k_tri) = n/Ln;
+					face_valid[k_tri] = 1;
+				}
+			}
+		}
+
+		// Triangles adjacent to each vertex, in increasing order (compressed rows: adjacent[offset[k] .. offset[k+1]-1])
+		std::vector<int> offset(N+1, 0);
+		for (int k_tri = 0; k_tri < N_tri; ++k_tri)
+		{
+			uint3 const& face = connectivity.at(k_tri);
+
+			//sanity check
+			assert_cgp_no_msg(get<0>(face)<unsigned(N));
+			assert_cgp_no_msg(get<1>(face)<unsigned(N));
+			assert_cgp_no_msg(get<2>(face)<unsigned(N));
+
+			if (face_valid[k_tri])
+				for (unsigned int idx : face)
+					offset[idx+1]++;
+		}
+		for (int k = 0; k < N; ++k)
+			offset[k+1] += offset[k];
+
+		std::vector<int> adjacent(offset[N]);
+		std::vector<int> cursor(offset.begin(), offset.end()-1);
+		for (int k_tri = 0; k_tri < N_tri; ++k_tri)
+			if (face_valid[k_tri])
+				for (unsigned int idx : connectivity.at(k_tri))
+					adjacent[cursor[idx]++] = k_tri;
+
+		// Each vertex sums the normals of its triangles in the order of the triangles:
+		//  no concurrent write, and the same result as a sequential accumulation whatever the number of threads
+		#pragma omp parallel for schedule(static) if(N>4096)
+		for (int k = 0; k < N; ++k)
+		{
+			vec3 n = {0,0,0};
+			for (int j = offset[k]; j < offset[k+1]; ++j)
+				n += face_normal.at(adjacent[j]);
+
+			// Normalize all normals
+			float const L = norm(n);
+			if (L>1e-6f)
+				n /= L;
+
+			// Invert normals if asked
+			normals.at(k) = invert ? -n : n;
+		}
+	}
+
+	void normal_per_vertex_grid(numarray<vec3> const& position, int Nu, int Nv, numarray<vec3>& normals, bool invert)
+	{
+		assert_cgp(Nu>1 && Nv>1, "Grid sample must be >1");
+		assert_cgp(int(position.size())==Nu*Nv, "Number of positions doesn't match the grid size");
+		normals.resize(Nu*Nv);
+
+		float const sign = invert ? -1.0f : 1.0f;
+		#pragma omp parallel for schedule(static) if(Nu*Nv>4096)
+		for (int ku = 0; ku < Nu; ++ku)
+		{
+			// Centered differences inside the grid, one-sided on the borders
+			int const ku0 = ku>0 ? ku-1 : ku;
+			int const ku1 = ku<Nu-1 ? ku+1 : ku;
+			for (int kv = 0; kv < Nv; ++kv)
+			{
+				int const kv0 = kv>0 ? kv-1 : kv;
+				int const kv1 = kv<Nv-1 ? kv+1 : kv;
+
+				vec3 const dpdu = position.at(kv + Nv*ku1) - position.at(kv + Nv*ku0);
+				vec3 const dpdv = position.at(kv1 + Nv*ku) - position.at(kv0 + Nv*ku);
+				vec3 const n = cross(dpdu, dpdv);
+				float const L = norm(n);
+				normals.at(kv + Nv*ku) = L>1e-12f ? (sign/L)*n : vec3{0,0,0};
+			}
+		}
+	}
 
-			
+	numarray<vec3> normal_per_vertex_grid(numarray<vec3> const& position, int Nu, int Nv, bool invert)
+	{
+		numarray<vec3> normals;
+		normal_per_vertex_grid(position, Nu, Nv, normals, invert);
+		return normals;
 	}
 	numarray<vec3> normal_per_vertex(numarray<vec3> const& position, numarray<uint3> const& connectivity, bool invert)
 	{
@@ -56,12 +56,20 @@ namespace cgp
 	};
 
 	/** Compute automaticaly a per-vertex normal given a set of positions and their connectivity 
+	* The normal of a vertex is the normalized sum of the unit normals of its triangles, computed in parallel
+	*   (each vertex gathers its triangles in increasing order: the result doesn't depend on the number of threads)
 	* Version where the normal is passed as in/out argument (usefull in case of real-time update of the normals) 
 	*   allows to save time and avoid unecessary allocation if the normal vector has already the correct size.	*/
 	void normal_per_vertex(numarray<vec3> const& position, numarray<uint3> const& connectivity, numarray<vec3>& normals_to_fill, bool invert=false);
 	/** Compute automaticaly a per-vertex normal given a set of positions and their connectivity */
 	numarray<vec3> normal_per_vertex(numarray<vec3> const& position, numarray<uint3> const& connectivity, bool invert=false);
 
+	/** Per-vertex normal of a regular grid of Nu x Nv samples stored as position[kv + Nv*ku], computed by finite differences
+	* n = cross(dp/du, dp/dv) normalized, with u the direction of ku (use invert to get the opposite orientation)
+	* Faster than normal_per_vertex (no connectivity, no scatter): can be used for real-time deformation of grid surfaces */
+	void normal_per_vertex_grid(numarray<vec3> const& position, int Nu, int Nv, numarray<vec3>& normals_to_fill, bool invert=false);
+	numarray<vec3> normal_per_vertex_grid(numarray<vec3> const& position, int Nu, int Nv, bool invert=false);
+
 	/** Check if the mesh looks coherent (correct indexing and size of buffer, no degenerate triangle, etc) */
 	bool mesh_check(mesh const& m);
 
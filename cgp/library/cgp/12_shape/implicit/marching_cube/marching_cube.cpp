@@ -2,16 +2,16 @@
 
 #include "cgp/09_geometric_transformation/interpolation/interpolation.hpp"
 #include "helper/marching_cubes_lut.hpp"
-#include <unordered_map>
+
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace cgp
 {
 
-	// Helper structure to hash a pair of index (a,b) as a unique number
-	struct hash_edge {
-		size_t operator()(std::pair<int, int> const& key) const;
-	};
-
 	// Helper structure to store voxels information
 	struct cube_parameters {
 		std::array<size_t, 8> index;
@@ -19,62 +19,294 @@ namespace cgp
 		std::array<vec3, 8>   position;
 	};
 
+	static int omp_max_threads()
+	{
+#ifdef _OPENMP
+		return omp_get_max_threads();
+#else
+		return 1;
+#endif
+	}
+
+	static int omp_thread_index()
+	{
+#ifdef _OPENMP
+		return omp_get_thread_num();
+#else
+		return 0;
+#endif
+	}
+
 
 	mesh marching_cube(grid_3D<float> const& field, spatial_domain_grid_3D const& domain, float iso)
 	{
 		assert_cgp_no_msg(is_equal(field.dimension, domain.samples));
 
-		// Compute the marching cube
-		std::vector<vec3> position;
-		std::vector<marching_cube_relative_coordinates> relative;
-		int const N = marching_cube(position, field.data.data, domain, iso, &relative);
-
+		// Indexed marching cube: the vertices on the same voxel edge are shared
+		marching_cube_structure extractor;
+		extractor.extract(field, domain, iso);
 
-		// Compute the mesh with non-duplicated vertices
 		mesh m;
-		int const N_triangle = N / 3;
+		m.position = extractor.position;
+		m.normal = extractor.normal; // gradient of the field (not recomputed by fill_empty_field)
+		m.connectivity = extractor.connectivity;
 
-		// Storage avoiding to duplicate vertices at the same position if they are on the same voxel edge
-		std::unordered_map<std::pair<int, int>, int, hash_edge> unique_edge;
+		m.fill_empty_field();
+		return m;
+	}
 
-		for (int k_tri = 0; k_tri < N_triangle; ++k_tri) {
 
-			uint3 triangle_index;
-			for (int k = 0; k < 3; ++k) {
+	// Edges of the cube (same numbering as the look-up tables): direction (0:x, 1:y, 2:z) and offset of the first corner
+	namespace {
+		struct cube_edge { int direction; int ox, oy, oz; };
+		cube_edge const cube_edges[12] = {
+			{0, 0,0,0}, {1, 1,0,0}, {0, 0,1,0}, {1, 0,0,0},
+			{0, 0,0,1}, {1, 1,0,1}, {0, 0,1,1}, {1, 0,0,1},
+			{2, 0,0,0}, {2, 1,0,0}, {2, 1,1,0}, {2, 0,1,0} };
 
-				int const idx = 3 * k_tri + k;
+		int const no_vertex = -1;
+	}
 
-				// The indices of the edge of the current vertex
-				std::pair<int, int> const edge = { relative[3 * k_tri+k].k0, relative[3 * k_tri+k].k1 };
+	// Gradient of the field at the sample (kx,ky,kz) - centered differences, one-sided on the border
+	static vec3 field_gradient(grid_3D<float> const& field, int kx, int ky, int kz, vec3 const& voxel_length)
+	{
+		int3 const& N = field.dimension;
+		int const x0 = std::max(kx - 1, 0), x1 = std::min(kx + 1, N.x - 1);
+		int const y0 = std::max(ky - 1, 0), y1 = std::min(ky + 1, N.y - 1);
+		int const z0 = std::max(kz - 1, 0), z1 = std::min(kz + 1, N.z - 1);
+		float const* f = field.data.data.data();
+		return {
+			(f[x1 + N.x * (ky + N.y * kz)] - f[x0 + N.x * (ky + N.y * kz)]) / ((x1 - x0) * voxel_length.x),
+			(f[kx + N.x * (y1 + N.y * kz)] - f[kx + N.x * (y0 + N.y * kz)]) / ((y1 - y0) * voxel_length.y),
+			(f[kx + N.x * (ky + N.y * z1)] - f[kx + N.x * (ky + N.y * z0)]) / ((z1 - z0) * voxel_length.z) };
+	}
 
-				// Check if this edge has already been encountered
-				auto const it = unique_edge.find(edge);
+	void marching_cube_structure::extract(grid_3D<float> const& field, spatial_domain_grid_3D const& domain_arg, float iso_arg)
+	{
+		assert_cgp_no_msg(is_equal(field.dimension, domain_arg.samples));
+		assert_cgp(field.dimension.x >= 2 && field.dimension.y >= 2 && field.dimension.z >= 2, "Marching cube requires at least 2 samples in each direction");
+		assert_cgp(slab_size >= 1, "slab_size must be >= 1");
+
+		domain = domain_arg;
+		iso = iso_arg;
+		dimension = field.dimension;
+
+		// Split the layers of cubes in slabs
+		int const N_layer = dimension.z - 1;
+		int const N_slab = (N_layer + slab_size - 1) / slab_size;
+		slabs.resize(N_slab);
+		slabs_to_extract.resize(N_slab);
+		for (int k = 0; k < N_slab; ++k) {
+			slabs[k].layer_begin = k * slab_size;
+			slabs[k].layer_end = std::min((k + 1) * slab_size, N_layer);
+			slabs_to_extract[k] = k;
+		}
 
-				// if it is a new edge, add this vertex as a new one in the mesh
-				if (it == unique_edge.end()) {
-					int const idx_new_vertex = m.position.size(); // create a new vertex index
-					triangle_index[k] = idx_new_vertex; // set the current index to the triangle connectivity
-					m.position.push_back(position[idx]); // add this vertex in the mesh
-					unique_edge[edge] = idx_new_vertex; // add the edge in the unique structure for further check
-				}
-				// if the edge has already been encountered - only reuse the index in the connectivity but do not add the vertex again
-				else {
-					int const idx_existing_vertex = it->second;   // the index that has already be defined
-					triangle_index[k] = idx_existing_vertex;      // set this existing index in the triangle connectivity
+		extract_slabs(field);
+	}
+
+	void marching_cube_structure::update(grid_3D<float> const& field, int3 const& index_min, int3 const& index_max)
+	{
+		if (!is_equal(field.dimension, dimension) || slabs.empty()) {
+			extract(field, domain, iso);
+			return;
+		}
+
+		// A sample kz is used by the cubes of the layers kz-1 and kz, and by the normals (centered differences) of the layers kz-2 and kz+1
+		int const layer_min = index_min.z - 2;
+		int const layer_max = index_max.z + 1;
+		slabs_to_extract.clear();
+		for (int k = 0; k < int(slabs.size()); ++k)
+			if (slabs[k].layer_end > layer_min && slabs[k].layer_begin <= layer_max)
+				slabs_to_extract.push_back(k);
+
+		extract_slabs(field);
+	}
+
+	void marching_cube_structure::extract_slabs(grid_3D<float> const& field)
+	{
+		int const N_thread = omp_max_threads();
+		if (int(caches.size()) < N_thread)
+			caches.resize(N_thread);
+
+		int const N_slab = int(slabs.size());
+		int const N_extract = int(slabs_to_extract.size());
+		#pragma omp parallel for schedule(dynamic) if(N_extract>1)
+		for (int k = 0; k < N_extract; ++k) {
+			int const idx = slabs_to_extract[k];
+			extract_slab(field, slabs[idx], caches[omp_thread_index()], idx == N_slab - 1);
+		}
+		last_extracted_count = N_extract;
+
+		assemble();
+	}
+
+	void marching_cube_structure::extract_slab(grid_3D<float> const& field, slab_structure& slab, cache_structure& cache, bool last_slab) const
+	{
+		static std::array<std::array<int, 16>, 256> const triTable = marching_cube_lut_triTable();
+
+		int const Nx = dimension.x;
+		int const Ny = dimension.y;
+		int const N_plane = Nx * Ny;
+		float const* f = field.data.data.data();
+
+		vec3 const domain_min = domain.center - domain.length / 2.0f;
+		vec3 const voxel_length = domain.voxel_length();
+		int const stride[3] = { 1, Nx, N_plane };
+
+		slab.position.clear();
+		slab.normal.clear();
+		slab.triangle.clear();
+		slab.vertex_bottom.clear();
+
+		// Vertex index on the edges of the current layer (no_vertex if not created yet)
+		cache.plane[0].assign(2 * N_plane, no_vertex);
+		cache.plane[1].assign(2 * N_plane, no_vertex);
+		cache.vertical.resize(N_plane);
+		int bottom = 0;
+
+		for (int kz = slab.layer_begin; kz < slab.layer_end; ++kz) {
+			int const top = 1 - bottom;
+			std::fill(cache.plane[top].begin(), cache.plane[top].end(), no_vertex);
+			std::fill(cache.vertical.begin(), cache.vertical.end(), no_vertex);
+
+			// The vertices of the plane layer_end are created by the next slab
+			bool const top_deferred = (kz == slab.layer_end - 1) && !last_slab;
+
+			for (int ky = 0; ky < Ny - 1; ++ky) {
+				// The values of the face x+1 of a cube are the ones of the face x of the next cube
+				int const index_row = Nx * (ky + Ny * kz);
+				float value[8];
+				value[1] = f[index_row] - iso;
+				value[2] = f[index_row + Nx] - iso;
+				value[5] = f[index_row + N_plane] - iso;
+				value[6] = f[index_row + Nx + N_plane] - iso;
+				for (int kx = 0; kx < Nx - 1; ++kx) {
+					int const index_corner = index_row + kx;
+
+					value[0] = value[1];
+					value[3] = value[2];
+					value[4] = value[5];
+					value[7] = value[6];
+					value[1] = f[index_corner + 1] - iso;
+					value[2] = f[index_corner + 1 + Nx] - iso;
+					value[5] = f[index_corner + 1 + N_plane] - iso;
+					value[6] = f[index_corner + 1 + Nx + N_plane] - iso;
+
+					int type = 0;
+					for (int k = 0; k < 8; ++k)
+						if (value[k] < 0) type |= (1 << k);
+					if (type == 0 || type == 255)
+						continue;
+
+					std::array<int, 16> const& triangles = triTable[type];
+					int vertex[3];
+					for (int k = 0; triangles[k] != -1; k += 3) {
+						for (int i = 0; i < 3; ++i) {
+							cube_edge const& e = cube_edges[triangles[k + i]];
+							int const ex = kx + e.ox;
+							int const ey = ky + e.oy;
+
+							int* cached = nullptr;
+							int plane_edge = 0;
+							if (e.direction == 2)
+								cached = &cache.vertical[ex + Nx * ey];
+							else {
+								plane_edge = 2 * (ex + Nx * ey) + e.direction;
+								cached = &cache.plane[e.oz == 0 ? bottom : top][plane_edge];
+							}
+
+							if (*cached == no_vertex) {
+								if (e.oz == 1 && e.direction != 2 && top_deferred)
+									*cached = -(2 + plane_edge);
+								else {
+									// New vertex on the edge, always interpolated from its lower sample to its higher one
+									int const ez = kz + e.oz;
+									int const a = ex + Nx * (ey + Ny * ez);
+									int const b = a + stride[e.direction];
+									float const alpha = (iso - f[a]) / (f[b] - f[a]);
+
+									vec3 const p0 = { domain_min.x + ex * voxel_length.x, domain_min.y + ey * voxel_length.y, domain_min.z + ez * voxel_length.z };
+									vec3 p = p0;
+									p[e.direction] += alpha * voxel_length[e.direction];
+
+									int const bx = ex + (e.direction == 0), by = ey + (e.direction == 1), bz = ez + (e.direction == 2);
+									// The triangles are oriented towards the values lower than iso
+									vec3 const n = (alpha - 1) * field_gradient(field, ex, ey, ez, voxel_length) - alpha * field_gradient(field, bx, by, bz, voxel_length);
+									float const n_norm = norm(n);
+
+									*cached = int(slab.position.size());
+									slab.position.push_back(p);
+									slab.normal.push_back(n_norm > 1e-12f ? n / n_norm : vec3{ 0,0,1 });
+								}
+							}
+							vertex[i] = *cached;
+						}
+						slab.triangle.push_back({ vertex[0], vertex[1], vertex[2] });
+					}
 				}
 			}
-			m.connectivity.push_back(triangle_index); // add the new triangle
-			
-			
-		}
 
-		m.fill_empty_field();
-		return m;
+			// Keep the vertices of the bottom plane of the slab for the connection with the previous slab
+			if (kz == slab.layer_begin) {
+				std::vector<int> const& plane = cache.plane[bottom];
+				for (int k = 0; k < 2 * N_plane; ++k)
+					if (plane[k] >= 0)
+						slab.vertex_bottom.push_back({ k, plane[k] });
+			}
+
+			bottom = top;
+		}
 	}
 
+	void marching_cube_structure::assemble()
+	{
+		int const N_slab = int(slabs.size());
+
+		// Offsets of each slab in the output buffers
+		std::vector<int>& vertex_offset = assemble_offset[0];
+		std::vector<int>& triangle_offset = assemble_offset[1];
+		vertex_offset.resize(N_slab + 1);
+		triangle_offset.resize(N_slab + 1);
+		vertex_offset[0] = 0;
+		triangle_offset[0] = 0;
+		for (int k = 0; k < N_slab; ++k) {
+			vertex_offset[k + 1] = vertex_offset[k] + int(slabs[k].position.size());
+			triangle_offset[k + 1] = triangle_offset[k] + int(slabs[k].triangle.size());
+		}
 
-	size_t hash_edge::operator()(std::pair<int, int> const& key) const {
-		return std::hash<int>{}(key.first) ^ std::hash<int>{}(key.second);
+		position.resize(vertex_offset[N_slab]);
+		normal.resize(vertex_offset[N_slab]);
+		connectivity.resize(triangle_offset[N_slab]);
+
+		#pragma omp parallel for schedule(static) if(N_slab>1)
+		for (int k = 0; k < N_slab; ++k) {
+			slab_structure const& slab = slabs[k];
+			int const N_vertex = int(slab.position.size());
+			std::copy(slab.position.begin(), slab.position.end(), position.data.begin() + vertex_offset[k]);
+			std::copy(slab.normal.begin(), slab.normal.end(), normal.data.begin() + vertex_offset[k]);
+
+			int const N_triangle = int(slab.triangle.size());
+			for (int t = 0; t < N_triangle; ++t) {
+				int3 const& triangle = slab.triangle[t];
+				uint3& face = connectivity.at(triangle_offset[k] + t);
+				for (int i = 0; i < 3; ++i) {
+					int const local = triangle[i];
+					if (local >= 0) {
+						assert_cgp_no_msg(local < N_vertex);
+						face[i] = vertex_offset[k] + local;
+					}
+					else {
+						// Vertex on the top plane: owned by the next slab
+						std::vector<std::pair<int, int>> const& next = slabs[k + 1].vertex_bottom;
+						int const plane_edge = -local - 2;
+						auto const it = std::lower_bound(next.begin(), next.end(), std::make_pair(plane_edge, 0));
+						assert_cgp(it != next.end() && it->first == plane_edge, "Marching cube: missing vertex between two slabs");
+						face[i] = vertex_offset[k + 1] + it->second;
+					}
+				}
+			}
+		}
 	}
 
 
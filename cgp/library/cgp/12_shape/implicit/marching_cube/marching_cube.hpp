@@ -7,10 +7,69 @@
 namespace cgp {
 
 	/** A simple-to-use marching cube that takes as input a discrete field, a 3D domain, and the iso-value, and returns a mesh without duplicating the vertices at the same position. 
-	* A new mesh is created at each call which is good for single call, but not ideal for efficiency if used in the animation loop. */
+	* A new mesh is created at each call which is good for single call, but not ideal for efficiency if used in the animation loop (use marching_cube_structure instead). */
 	mesh marching_cube(grid_3D<float> const& field, spatial_domain_grid_3D const& domain, float iso);
 
 
+	/** Indexed marching cube with reusable buffers, adapted to fields modified at each frame (ex. interactive sculpting).
+	* - The cubes are split in slabs of slab_size layers along z, extracted in parallel.
+	*   Inside a slab, the vertices are shared between the cubes through caches of the vertex index on the edges of the
+	*   current layer (no hash map). The vertices lying on the plane between two slabs belong to the upper slab.
+	* - The result of each slab is kept: after a local modification of the field, update() only re-extracts the slabs
+	*   containing the modified samples.
+	* - The output (position, normal, connectivity) is written in the buffers of the structure, reused between the calls:
+	*   nothing is allocated once their capacity is large enough.
+	* The normals are given by the gradient of the field (oriented like the triangles). */
+	struct marching_cube_structure
+	{
+		// Output mesh - the vertices are shared between adjacent triangles
+		numarray<vec3> position;
+		numarray<vec3> normal;
+		numarray<uint3> connectivity;
+
+		// Number of layers of cubes per slab (set before the first extraction)
+		int slab_size = 8;
+
+		// Extract the complete iso-surface
+		void extract(grid_3D<float> const& field, spatial_domain_grid_3D const& domain, float iso);
+		// Re-extract the surface after a modification of the samples between index_min and index_max (included)
+		//  The domain and iso-value are the ones of the previous call to extract() (complete extraction if the dimension changed)
+		void update(grid_3D<float> const& field, int3 const& index_min, int3 const& index_max);
+
+		// Number of slabs extracted during the last call
+		int slab_extracted_count() const { return last_extracted_count; }
+
+	private:
+		struct slab_structure {
+			int layer_begin = 0; // cube layers [layer_begin, layer_end[ along z
+			int layer_end = 0;
+			std::vector<vec3> position;
+			std::vector<vec3> normal;
+			std::vector<int3> triangle;                     // local index of the vertices, or -(2+edge) for the vertices of the plane layer_end (owned by the next slab)
+			std::vector<std::pair<int, int>> vertex_bottom; // (edge, local index) of the vertices on the plane layer_begin, sorted by edge
+		};
+		struct cache_structure {
+			std::vector<int> plane[2]; // vertex index on the edges along x and y of the two planes of the current layer
+			std::vector<int> vertical; // vertex index on the edges along z of the current layer
+		};
+
+		std::vector<slab_structure> slabs;
+		std::vector<cache_structure> caches; // one per thread
+		std::vector<int> slabs_to_extract;
+		std::vector<int> assemble_offset[2]; // offsets of the vertices and triangles of each slab in the output
+
+		spatial_domain_grid_3D domain;
+		float iso = 0.0f;
+		int3 dimension = { 0,0,0 };
+		int last_extracted_count = 0;
+
+		void extract_slabs(grid_3D<float> const& field);
+		void extract_slab(grid_3D<float> const& field, slab_structure& slab, cache_structure& cache, bool last_slab) const;
+		void assemble();
+	};
+
+
+
 	struct marching_cube_relative_coordinates {
 		size_t k0;
 		size_t k1;
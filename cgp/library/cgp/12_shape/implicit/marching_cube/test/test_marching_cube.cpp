@@ -0,0 +1,102 @@
+#include "cgp/12_shape/implicit/marching_cube/marching_cube.hpp"
+#include "cgp/01_base/base.hpp"
+
+#include <map>
+#include <utility>
+
+#if defined(__linux__) || defined(__EMSCRIPTEN__)
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#endif
+
+namespace cgp_test
+{
+	// Field decreasing with the distance to the origin (larger inside the surface), sampled on the domain
+	static cgp::grid_3D<float> sphere_field(cgp::spatial_domain_grid_3D const& domain)
+	{
+		cgp::grid_3D<float> field(domain.samples);
+		for (int kz = 0; kz < domain.samples.z; ++kz)
+			for (int ky = 0; ky < domain.samples.y; ++ky)
+				for (int kx = 0; kx < domain.samples.x; ++kx)
+					field(kx, ky, kz) = 1.0f - cgp::norm(domain.position({ kx, ky, kz }));
+		return field;
+	}
+
+	void test_marching_cube()
+	{
+		// 23 layers of cubes: slabs of 4 layers, the last one is incomplete
+		cgp::spatial_domain_grid_3D const domain = cgp::spatial_domain_grid_3D::from_center_length({ 0,0,0 }, { 2,2,2 }, { 24,24,24 });
+		float const iso = 0.4f; // sphere of radius 0.6
+		cgp::grid_3D<float> field = sphere_field(domain);
+
+		cgp::marching_cube_structure extractor;
+		extractor.slab_size = 4;
+		extractor.extract(field, domain, iso);
+
+		// Closed surface with shared vertices: each edge is used by exactly two triangles
+		{
+			int const N_vertex = extractor.position.size();
+			int const N_triangle = extractor.connectivity.size();
+			assert_cgp_no_msg(N_triangle > 0);
+			assert_cgp_no_msg(extractor.normal.size() == N_vertex);
+
+			std::map<std::pair<unsigned int, unsigned int>, int> edge_count;
+			for (int k = 0; k < N_triangle; ++k) {
+				cgp::uint3 const& t = extractor.connectivity[k];
+				for (int i = 0; i < 3; ++i) {
+					unsigned int const a = t[i];
+					unsigned int const b = t[(i + 1) % 3];
+					assert_cgp_no_msg(a != b && a < unsigned(N_vertex) && b < unsigned(N_vertex));
+					edge_count[std::make_pair(std::min(a, b), std::max(a, b))]++;
+				}
+			}
+			for (auto const& it : edge_count)
+				assert_cgp_no_msg(it.second == 2);
+
+			// Closed surface of genus 0: V - E + F = 2
+			assert_cgp_no_msg(N_vertex - int(edge_count.size()) + N_triangle == 2);
+
+			// Vertices on the sphere, normals pointing outside, triangles oriented like the normals
+			for (int k = 0; k < N_vertex; ++k) {
+				cgp::vec3 const& p = extractor.position[k];
+				assert_cgp_no_msg(std::abs(cgp::norm(p) - 0.6f) < 0.02f);
+				assert_cgp_no_msg(cgp::dot(extractor.normal[k], p / cgp::norm(p)) > 0.9f);
+			}
+			for (int k = 0; k < N_triangle; ++k) {
+				cgp::uint3 const& t = extractor.connectivity[k];
+				cgp::vec3 const n = cgp::cross(extractor.position[t[1]] - extractor.position[t[0]], extractor.position[t[2]] - extractor.position[t[0]]);
+				assert_cgp_no_msg(cgp::dot(n, extractor.normal[t[0]] + extractor.normal[t[1]] + extractor.normal[t[2]]) >= 0.0f);
+			}
+		}
+
+		// The simple function returns the same mesh, with the normals of the extraction
+		{
+			cgp::marching_cube_structure direct; // default slab size, as in marching_cube()
+			direct.extract(field, domain, iso);
+			cgp::mesh const m = cgp::marching_cube(field, domain, iso);
+			assert_cgp_no_msg(is_equal(m.position, direct.position));
+			assert_cgp_no_msg(is_equal(m.normal, direct.normal));
+			assert_cgp_no_msg(is_equal(m.connectivity, direct.connectivity));
+		}
+
+		// update() after a local modification gives the same result as a complete extraction
+		{
+			cgp::int3 const index_min = { 3, 5, 9 };
+			cgp::int3 const index_max = { 12, 11, 14 };
+			for (int kz = index_min.z; kz <= index_max.z; ++kz)
+				for (int ky = index_min.y; ky <= index_max.y; ++ky)
+					for (int kx = index_min.x; kx <= index_max.x; ++kx)
+						field(kx, ky, kz) -= 0.15f;
+			extractor.update(field, index_min, index_max);
+			int const N_slab = (domain.samples.z - 1 + extractor.slab_size - 1) / extractor.slab_size;
+			assert_cgp_no_msg(extractor.slab_extracted_count() < N_slab);
+
+			cgp::marching_cube_structure reference;
+			reference.slab_size = 4;
+			reference.extract(field, domain, iso);
+
+			assert_cgp_no_msg(is_equal(extractor.position, reference.position));
+			assert_cgp_no_msg(is_equal(extractor.normal, reference.normal));
+			assert_cgp_no_msg(is_equal(extractor.connectivity, reference.connectivity));
+		}
+	}
+}
@@ -2,4 +2,5 @@
 
 #include "opengl_buffer/opengl_buffer.hpp"
 #include "vbo/vbo.hpp"
-#include "ebo/ebo.hpp"
\ No newline at end of file
+#include "ebo/ebo.hpp"
+#include "ubo/ubo.hpp"
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "ebo.hpp"
 #include "../../debug/debug.hpp"
+#include "../../state/opengl_state.hpp"
 
 namespace cgp
 {
@@ -7,6 +8,9 @@ namespace cgp
 	void opengl_ebo_structure::initialize_data_on_gpu(numarray<uint3> const& data)
 	{
 
+		// The element buffer binding is stored in the bound VAO: make sure it is not modified
+		opengl_state().bind_vertex_array(0);
+
 		glGenBuffers(1, &id); opengl_check;
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id); opengl_check;
 		glBufferData(GL_ELEMENT_ARRAY_BUFFER, GLsizeiptr(size_in_memory(data)), ptr(data), GL_DYNAMIC_DRAW); opengl_check;
@@ -0,0 +1,140 @@
+#include "ubo.hpp"
+#include "../../debug/debug.hpp"
+#include "cgp/01_base/base.hpp"
+
+#include <cstring>
+
+namespace cgp
+{
+	// std140 rules: scalars are aligned on 4 Bytes, vec2 on 8 Bytes, vec3/vec4/mat4 columns on 16 Bytes
+	template <> int opengl_ubo_structure::add_member<int>(std::string const& name)   { return add_member_generic(name, "int", 4, 4); }
+	template <> int opengl_ubo_structure::add_member<float>(std::string const& name) { return add_member_generic(name, "float", 4, 4); }
+	template <> int opengl_ubo_structure::add_member<vec2>(std::string const& name)  { return add_member_generic(name, "vec2", 8, 8); }
+	template <> int opengl_ubo_structure::add_member<vec3>(std::string const& name)  { return add_member_generic(name, "vec3", 16, 12); }
+	template <> int opengl_ubo_structure::add_member<vec4>(std::string const& name)  { return add_member_generic(name, "vec4", 16, 16); }
+	template <> int opengl_ubo_structure::add_member<mat4>(std::string const& name)  { return add_member_generic(name, "mat4", 16, 64); }
+
+	int opengl_ubo_structure::add_member_generic(std::string const& name, std::string const& glsl_type, int alignment, int size)
+	{
+		assert_cgp(id == 0, "The members of the uniform block must be declared before initialize_data_on_gpu");
+
+		int offset = 0;
+		if (!members.empty())
+			offset = members.back().offset + members.back().size;
+		offset = (offset + alignment - 1) / alignment * alignment;
+
+		members.push_back({ name, glsl_type, offset, size });
+
+		// The size of a block is a multiple of 16 Bytes
+		data.resize(((offset + size + 15) / 16) * 16, 0);
+		return int(members.size()) - 1;
+	}
+
+	void opengl_ubo_structure::initialize_data_on_gpu(std::string const& block_name_arg, GLuint binding_arg)
+	{
+		assert_cgp(!members.empty(), "Try to initialize an empty uniform block");
+		block_name = block_name_arg;
+		binding = binding_arg;
+
+		glGenBuffers(1, &id);                                                                          opengl_check;
+		glBindBuffer(GL_UNIFORM_BUFFER, id);                                                           opengl_check;
+		glBufferData(GL_UNIFORM_BUFFER, GLsizeiptr(data.size()), data.data(), GL_DYNAMIC_DRAW);        opengl_check;
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);                                                            opengl_check;
+		glBindBufferBase(GL_UNIFORM_BUFFER, binding, id);                                              opengl_check;
+
+		size = GLuint(members.size());
+		type = GL_UNIFORM_BUFFER;
+		details.size_byte = GLuint(data.size());
+		modified = false;
+	}
+
+	void opengl_ubo_structure::set_generic(int member, void const* value, int size_value)
+	{
+		assert_cgp(member >= 0 && member < int(members.size()), "Incorrect uniform block member index " + str(member));
+		member_structure const& m = members[member];
+		assert_cgp(m.size == size_value, "Incorrect type for the uniform block member " + m.name + " (" + m.glsl_type + ")");
+
+		unsigned char* destination = data.data() + m.offset;
+		if (std::memcmp(destination, value, size_value) != 0) {
+			std::memcpy(destination, value, size_value);
+			modified = true;
+		}
+	}
+
+	void opengl_ubo_structure::set(int member, int value)          { set_generic(member, &value, 4); }
+	void opengl_ubo_structure::set(int member, float value)        { set_generic(member, &value, 4); }
+	void opengl_ubo_structure::set(int member, vec2 const& value)  { set_generic(member, ptr(value), 8); }
+	void opengl_ubo_structure::set(int member, vec3 const& value)  { set_generic(member, ptr(value), 12); }
+	void opengl_ubo_structure::set(int member, vec4 const& value)  { set_generic(member, ptr(value), 16); }
+	void opengl_ubo_structure::set(int member, mat4 const& value)
+	{
+		// mat4 is stored row by row, std140 matrices column by column
+		mat4 const column_major = transpose(value);
+		set_generic(member, ptr(column_major), 64);
+	}
+
+	void opengl_ubo_structure::update()
+	{
+		if (!modified || id == 0)
+			return;
+
+		glBindBuffer(GL_UNIFORM_BUFFER, id);                                             opengl_check;
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, GLsizeiptr(data.size()), data.data());    opengl_check;
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);                                              opengl_check;
+		modified = false;
+	}
+
+	bool opengl_ubo_structure::use_in_shader(opengl_shader_structure const& shader) const
+	{
+		if (id == 0 || shader.id == 0)
+			return false;
+
+		if (shader.id >= shader_state.size())
+			shader_state.resize(shader.id + 1, 0);
+		char& state = shader_state[shader.id];
+		if (state != 0)
+			return state == 1;
+
+		// First use of this shader: link its block to the binding point
+		GLuint const block_index = glGetUniformBlockIndex(shader.id, block_name.c_str()); opengl_check;
+		if (block_index == GL_INVALID_INDEX) {
+			state = 2;
+			return false;
+		}
+		glUniformBlockBinding(shader.id, block_index, binding); opengl_check;
+
+		// Check that the layout declared in the shader matches the members
+		for (member_structure const& m : members) {
+			char const* name = m.name.c_str();
+			GLuint index = GL_INVALID_INDEX;
+			glGetUniformIndices(shader.id, 1, &name, &index); opengl_check;
+			if (index == GL_INVALID_INDEX)
+				continue; // member not used by this shader
+			GLint offset = -1;
+			glGetActiveUniformsiv(shader.id, 1, &index, GL_UNIFORM_OFFSET, &offset); opengl_check;
+			assert_cgp(offset == m.offset, "The uniform block " + block_name + " of the shader (id=" + str(shader.id) + ") doesn't match the expected layout: member " + m.name + " at offset " + str(offset) + " instead of " + str(m.offset) + ".\n Expected declaration:\n" + glsl_declaration());
+		}
+
+		state = 1;
+		return true;
+	}
+
+	std::string opengl_ubo_structure::glsl_declaration() const
+	{
+		std::string s = "layout(std140) uniform " + block_name + " {\n";
+		for (member_structure const& m : members)
+			s += "\t" + m.glsl_type + " " + m.name + ";\n";
+		s += "};\n";
+		return s;
+	}
+
+	void opengl_ubo_structure::clear()
+	{
+		opengl_gpu_buffer::clear();
+		members.clear();
+		data.clear();
+		shader_state.clear();
+		modified = true;
+	}
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "../opengl_buffer/opengl_buffer.hpp"
+#include "cgp/05_vec/vec.hpp"
+#include "cgp/06_mat/mat.hpp"
+#include "cgp/13_opengl/shaders/shaders.hpp"
+
+#include <string>
+#include <vector>
+
+namespace cgp
+{
+	/** Uniform Buffer Object storing a uniform block with the std140 layout
+	* The values are written in a CPU copy of the block, and sent to the GPU at once by update(). All the shaders declaring
+	* the block read the same buffer: values shared by many draw calls (ex. camera, light) are sent once instead of once per draw.
+	* Usage:
+	*   // declare the members in the same order as the GLSL block (see glsl_declaration())
+	*   int const member_view = ubo.add_member<mat4>("view");
+	*   ubo.initialize_data_on_gpu("environment_block", 1);
+	*   // once per frame
+	*   ubo.set(member_view, view_matrix);
+	*   ubo.update();
+	*   // at the draw call: the uniforms of the block don't need to be sent if the shader uses it
+	*   if (!ubo.use_in_shader(shader)) opengl_uniform(shader, "view", view_matrix); */
+	struct opengl_ubo_structure : opengl_gpu_buffer
+	{
+		struct member_structure {
+			std::string name;
+			std::string glsl_type;
+			int offset; // std140 offset in the block (in Byte)
+			int size;   // size in the block (in Byte)
+		};
+
+		std::string block_name;   // Name of the block in the shaders
+		GLuint binding = 0;       // Binding point of the buffer
+		std::vector<member_structure> members;
+		std::vector<unsigned char> data; // CPU copy of the block
+
+		// Declare a new member at the end of the block (before initialize_data_on_gpu) - return its index
+		//  Available types: int, float, vec2, vec3, vec4, mat4
+		template <typename T> int add_member(std::string const& name);
+
+		// Create the buffer and attach it to the binding point
+		void initialize_data_on_gpu(std::string const& block_name, GLuint binding);
+
+		// Set the value of a member in the CPU copy
+		void set(int member, int value);
+		void set(int member, float value);
+		void set(int member, vec2 const& value);
+		void set(int member, vec3 const& value);
+		void set(int member, vec4 const& value);
+		void set(int member, mat4 const& value);
+
+		// Send the CPU copy to the GPU (only if a value changed since the last update)
+		void update();
+
+		// Return true if the shader declares the block - it then reads the values from this buffer
+		//  The first call for a shader links its block to the binding point, and checks that its layout matches the members.
+		bool use_in_shader(opengl_shader_structure const& shader) const;
+
+		// GLSL declaration of the block corresponding to the members
+		std::string glsl_declaration() const;
+
+		void clear();
+
+	private:
+		bool modified = true;
+		mutable std::vector<char> shader_state; // per shader id: 0 = not checked yet, 1 = uses the block, 2 = doesn't use it
+
+		int add_member_generic(std::string const& name, std::string const& glsl_type, int alignment, int size);
+		void set_generic(int member, void const* value, int size);
+	};
+
+	template <> int opengl_ubo_structure::add_member<int>(std::string const& name);
+	template <> int opengl_ubo_structure::add_member<float>(std::string const& name);
+	template <> int opengl_ubo_structure::add_member<vec2>(std::string const& name);
+	template <> int opengl_ubo_structure::add_member<vec3>(std::string const& name);
+	template <> int opengl_ubo_structure::add_member<vec4>(std::string const& name);
+	template <> int opengl_ubo_structure::add_member<mat4>(std::string const& name);
+
+}
@@ -0,0 +1,75 @@
+#include "cgp/13_opengl/buffer/vbo/vbo.hpp"
+#include "cgp/01_base/base.hpp"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__linux__) || defined(__EMSCRIPTEN__)
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#endif
+
+namespace cgp_test
+{
+	// Reference conversion of a half float to float
+	static float half_to_float(uint16_t h)
+	{
+		int const sign = (h >> 15) ? -1 : 1;
+		int const exponent = (h >> 10) & 0x1f;
+		int const mantissa = h & 0x3ff;
+		if (exponent == 0)
+			return sign * std::ldexp(float(mantissa), -24);
+		if (exponent == 31)
+			return mantissa == 0 ? sign * INFINITY : NAN;
+		return sign * std::ldexp(float(mantissa + 1024), exponent - 25);
+	}
+
+	// Signed normalized 10 bits component k of a GL_INT_2_10_10_10_REV value
+	static float component_10(uint32_t packed, int k)
+	{
+		int32_t q = int32_t((packed >> (10 * k)) & 0x3ffu);
+		if (q >= 512)
+			q -= 1024;
+		return std::max(q / 511.0f, -1.0f);
+	}
+
+	void test_vbo_packing()
+	{
+		// Half float: exact values, rounding to nearest even, subnormals, overflow
+		{
+			assert_cgp_no_msg(cgp::opengl_pack_half_float(0.0f) == 0x0000);
+			assert_cgp_no_msg(cgp::opengl_pack_half_float(-0.0f) == 0x8000);
+			assert_cgp_no_msg(cgp::opengl_pack_half_float(1.0f) == 0x3c00);
+			assert_cgp_no_msg(cgp::opengl_pack_half_float(-2.0f) == 0xc000);
+			assert_cgp_no_msg(cgp::opengl_pack_half_float(0.5f) == 0x3800);
+			assert_cgp_no_msg(cgp::opengl_pack_half_float(65504.0f) == 0x7bff);
+			assert_cgp_no_msg(cgp::opengl_pack_half_float(1e6f) == 0x7c00);
+			assert_cgp_no_msg(cgp::opengl_pack_half_float(std::ldexp(1.0f, -24)) == 0x0001); // smallest subnormal
+			assert_cgp_no_msg(cgp::opengl_pack_half_float(std::ldexp(1.0f, -26)) == 0x0000); // rounded to 0
+			assert_cgp_no_msg(cgp::opengl_pack_half_float(1.0f + std::ldexp(1.0f, -11)) == 0x3c00); // halfway: even
+			assert_cgp_no_msg(cgp::opengl_pack_half_float(1.0f + 3 * std::ldexp(1.0f, -11)) == 0x3c02); // halfway: even
+
+			// Relative error of the representable range below 2^-11
+			for (int k = -2000; k <= 2000; ++k) {
+				float const x = k * 0.01234f;
+				float const y = half_to_float(cgp::opengl_pack_half_float(x));
+				assert_cgp_no_msg(std::abs(x - y) <= std::abs(x) * std::ldexp(1.0f, -11) + std::ldexp(1.0f, -25));
+			}
+		}
+
+		// 10:10:10:2 normals: error of the order of 1/1022 on each component, clamped in [-1,1]
+		{
+			for (int k = 0; k < 1000; ++k) {
+				float const theta = 0.0123f * k, phi = 0.0371f * k;
+				cgp::vec3 const n = { std::cos(theta) * std::sin(phi), std::sin(theta) * std::sin(phi), std::cos(phi) };
+				uint32_t const packed = cgp::opengl_pack_int_2_10_10_10(n);
+				for (int c = 0; c < 3; ++c)
+					assert_cgp_no_msg(std::abs(component_10(packed, c) - n[c]) <= 0.5f / 511.0f + 1e-6f);
+				assert_cgp_no_msg((packed >> 30) == 0);
+			}
+			uint32_t const packed = cgp::opengl_pack_int_2_10_10_10({ 2.0f, -3.0f, 0.0f });
+			assert_cgp_no_msg(component_10(packed, 0) == 1.0f);
+			assert_cgp_no_msg(component_10(packed, 1) == -1.0f);
+			assert_cgp_no_msg(component_10(packed, 2) == 0.0f);
+		}
+	}
+}
@@ -2,17 +2,21 @@
 #include "../../debug/debug.hpp"
 #include "cgp/01_base/base.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 namespace cgp
 {
 	static void warning_initialize_non_empty();
 
-	template <int N>
-	static GLuint opengl_buffer_data_initialize_generic(numarray<numarray_stack<float,N> > const& data, GLuint buffer_type, GLenum draw_type)
+	template <typename T>
+	static GLuint opengl_buffer_data_initialize_generic(numarray<T> const& data, GLuint buffer_type, GLenum draw_type)
 	{
 		GLuint vbo_index;
 		glGenBuffers(1, &vbo_index);                                                       opengl_check;
 		glBindBuffer(buffer_type, vbo_index);                                              opengl_check;
-		glBufferData(buffer_type, GLsizeiptr(size_in_memory(data)), ptr(data), draw_type); opengl_check;
+		glBufferData(buffer_type, GLsizeiptr(data.size() * sizeof(T)), ptr(data), draw_type); opengl_check;
 		glBindBuffer(buffer_type, 0);                                                      opengl_check;
 
 		return vbo_index;
@@ -63,6 +67,21 @@ namespace cgp
 		details.size_element = 4;
 		details.type_element = GL_FLOAT;
 	}
+	void opengl_vbo_structure::initialize_data_on_gpu(numarray<mat4> const& data, GLuint div)
+	{
+		if(id!=0){
+			warning_initialize_non_empty();
+		}
+
+		divisor = div;
+		id = opengl_buffer_data_initialize_generic(data, GL_ARRAY_BUFFER, GL_DYNAMIC_DRAW);
+		size = data.size();
+		type = GL_ARRAY_BUFFER;
+
+		details.size_byte = data.size() * sizeof(mat4);
+		details.size_element = 16;
+		details.type_element = GL_FLOAT;
+	}
 	void opengl_vbo_structure::update(numarray<vec2> const& data, int size_elements_update)
 	{
 		assert_cgp(size_elements_update <= data.size(), "Cannot update VBO with more elements than data");
@@ -98,8 +117,86 @@ namespace cgp
 	}
 
 
+	void opengl_vbo_structure::update(numarray<mat4> const& data, int size_elements_update)
+	{
+		assert_cgp(size_elements_update <= data.size(), "Cannot update VBO with more elements than data");
+		glBindBuffer(GL_ARRAY_BUFFER, id); opengl_check;
+		if (size_elements_update == -1) {
+			glBufferSubData(GL_ARRAY_BUFFER, 0, data.size() * sizeof(mat4), ptr(data));  opengl_check;
+		}
+		else {
+			glBufferSubData(GL_ARRAY_BUFFER, 0, 16 * sizeof(float) * size_elements_update, ptr(data));  opengl_check;
+		}
+	}
+
+
+	void opengl_vbo_structure::initialize_data_on_gpu(void const* data, GLuint size_byte, GLuint element_count, GLuint div)
+	{
+		if(id!=0){
+			warning_initialize_non_empty();
+		}
+
+		divisor = div;
+		glGenBuffers(1, &id);                                                              opengl_check;
+		glBindBuffer(GL_ARRAY_BUFFER, id);                                                 opengl_check;
+		glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(size_byte), data, GL_DYNAMIC_DRAW);       opengl_check;
+		glBindBuffer(GL_ARRAY_BUFFER, 0);                                                  opengl_check;
+		size = element_count;
+		type = GL_ARRAY_BUFFER;
+
+		// The layout of the elements is given by the calls to opengl_set_vao_location
+		details.size_byte = size_byte;
+		details.size_element = 0;
+		details.type_element = 0;
+	}
+	void opengl_vbo_structure::update(void const* data, GLuint size_byte)
+	{
+		assert_cgp(size_byte <= details.size_byte, "Cannot update VBO with more data than its size");
+		glBindBuffer(GL_ARRAY_BUFFER, id); opengl_check;
+		glBufferSubData(GL_ARRAY_BUFFER, 0, GLsizeiptr(size_byte), data);  opengl_check;
+	}
+
+
+	template <typename T>
+	static void opengl_buffer_update_generic(GLuint id, numarray_arena<T> const& data, int size_elements_update)
+	{
+		assert_cgp(size_elements_update <= data.size(), "Cannot update VBO with more elements than data");
+		int const N = size_elements_update == -1 ? data.size() : size_elements_update;
+		glBindBuffer(GL_ARRAY_BUFFER, id); opengl_check;
+		glBufferSubData(GL_ARRAY_BUFFER, 0, GLsizeiptr(N * sizeof(T)), data.data.data());  opengl_check;
+	}
+	void opengl_vbo_structure::update(numarray_arena<vec2> const& data, int size_elements_update)
+	{
+		opengl_buffer_update_generic(id, data, size_elements_update);
+	}
+	void opengl_vbo_structure::update(numarray_arena<vec3> const& data, int size_elements_update)
+	{
+		opengl_buffer_update_generic(id, data, size_elements_update);
+	}
+	void opengl_vbo_structure::update(numarray_arena<vec4> const& data, int size_elements_update)
+	{
+		opengl_buffer_update_generic(id, data, size_elements_update);
+	}
+	void opengl_vbo_structure::update(numarray_arena<mat4> const& data, int size_elements_update)
+	{
+		opengl_buffer_update_generic(id, data, size_elements_update);
+	}
+
+
 	void opengl_set_vao_location(opengl_vbo_structure const& vbo, GLuint location_index)
 	{
+		// mat4: one vec4 attribute per row
+		if (vbo.details.size_element == 16) {
+			vbo.bind();
+			for (GLuint k = 0; k < 4; ++k) {
+				glEnableVertexAttribArray(location_index + k); opengl_check
+				glVertexAttribPointer(location_index + k, 4, vbo.details.type_element, GL_FALSE, 16 * sizeof(float), reinterpret_cast<void*>(4 * sizeof(float) * k)); opengl_check
+				if (vbo.divisor>0) { glVertexAttribDivisor(location_index + k, vbo.divisor); opengl_check; }
+			}
+			vbo.unbind();
+			return;
+		}
+
 		vbo.bind();
 		glEnableVertexAttribArray(location_index); opengl_check
 		glVertexAttribPointer(location_index, vbo.details.size_element, vbo.details.type_element, GL_FALSE, 0, nullptr); opengl_check
@@ -108,6 +205,67 @@ namespace cgp
 	}
 
 
+	void opengl_set_vao_location(opengl_vbo_structure const& vbo, GLuint location_index, GLint size_element, GLenum type_element, bool normalized, GLuint offset, GLuint stride)
+	{
+		vbo.bind();
+		glEnableVertexAttribArray(location_index); opengl_check
+		glVertexAttribPointer(location_index, size_element, type_element, normalized ? GL_TRUE : GL_FALSE, GLsizei(stride), reinterpret_cast<void*>(size_t(offset))); opengl_check
+		vbo.unbind();
+		if (vbo.divisor>0) { glVertexAttribDivisor(location_index, vbo.divisor);                                         opengl_check; }
+	}
+
+
+	uint32_t opengl_pack_int_2_10_10_10(vec3 const& v)
+	{
+		// Signed normalized on 10 bits: [-1,1] -> [-511,511]
+		uint32_t packed = 0;
+		for (int k = 0; k < 3; ++k) {
+			float const c = std::min(std::max(v[k], -1.0f), 1.0f);
+			int32_t const q = int32_t(std::lround(c * 511.0f));
+			packed |= (uint32_t(q) & 0x3ffu) << (10 * k);
+		}
+		return packed; // w = 0
+	}
+
+	uint16_t opengl_pack_half_float(float x)
+	{
+		uint32_t f;
+		std::memcpy(&f, &x, sizeof(float));
+
+		uint32_t const sign = (f >> 16) & 0x8000u;
+		int32_t const exponent = int32_t((f >> 23) & 0xffu) - 127 + 15;
+		uint32_t mantissa = f & 0x7fffffu;
+
+		// Inf and NaN
+		if ((f & 0x7fffffffu) >= 0x7f800000u)
+			return uint16_t(sign | 0x7c00u | (mantissa != 0 ? 0x200u : 0u));
+		// Too large: Inf
+		if (exponent >= 31)
+			return uint16_t(sign | 0x7c00u);
+
+		// Round to nearest even on the bits that are dropped
+		if (exponent <= 0) {
+			// Subnormal half (or zero)
+			if (exponent < -10)
+				return uint16_t(sign);
+			mantissa |= 0x800000u;
+			int const shift = 14 - exponent;
+			uint32_t half = mantissa >> shift;
+			uint32_t const rest = mantissa & ((1u << shift) - 1);
+			uint32_t const halfway = 1u << (shift - 1);
+			if (rest > halfway || (rest == halfway && (half & 1u)))
+				half++;
+			return uint16_t(sign | half);
+		}
+
+		uint32_t half = sign | (uint32_t(exponent) << 10) | (mantissa >> 13);
+		uint32_t const rest = mantissa & 0x1fffu;
+		if (rest > 0x1000u || (rest == 0x1000u && (half & 1u)))
+			half++; // a carry in the exponent is the correct rounding (up to Inf)
+		return uint16_t(half);
+	}
+
+
 	static void warning_initialize_non_empty()
 	{
 		std::string warning = "\n";
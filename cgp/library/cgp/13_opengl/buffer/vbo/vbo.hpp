@@ -5,6 +5,7 @@
 #include "cgp/05_vec/vec.hpp"
 #include "cgp/06_mat/mat.hpp"
 
+#include <cstdint>
 
 
 namespace cgp
@@ -14,6 +15,8 @@ namespace cgp
 		void initialize_data_on_gpu(numarray<vec3> const& data, GLuint divisor = 0);
 		void initialize_data_on_gpu(numarray<vec2> const& data, GLuint divisor = 0);
 		void initialize_data_on_gpu(numarray<vec4> const& data, GLuint divisor = 0);
+		// A mat4 uses 4 consecutive locations (one per row, as mat4 is stored row by row)
+		void initialize_data_on_gpu(numarray<mat4> const& data, GLuint divisor = 0);
 
 		/** Re-write data on the VBO. (without re-allocation) in calling glBufferSubData
 		* - size_elements_update: 
@@ -22,11 +25,34 @@ namespace cgp
 		void update(numarray<vec2> const& data, int size_elements_update = -1);
 		void update(numarray<vec3> const& data, int size_elements_update = -1);
 		void update(numarray<vec4> const& data, int size_elements_update = -1);
+		void update(numarray<mat4> const& data, int size_elements_update = -1);
+
+		// Same as update() for a per-frame buffer
+		void update(numarray_arena<vec2> const& data, int size_elements_update = -1);
+		void update(numarray_arena<vec3> const& data, int size_elements_update = -1);
+		void update(numarray_arena<vec4> const& data, int size_elements_update = -1);
+		void update(numarray_arena<mat4> const& data, int size_elements_update = -1);
+
+		// Raw content of size_byte Bytes storing element_count elements (ex. interleaved vertex attributes)
+		//  The attributes are set with opengl_set_vao_location(vbo, location, ..., offset, stride)
+		void initialize_data_on_gpu(void const* data, GLuint size_byte, GLuint element_count, GLuint divisor = 0);
+		void update(void const* data, GLuint size_byte);
 
 		GLuint divisor;
 	};
 
-	/** Call glVertexAttribPointer and set the correspondance between VBO and the location in the shader */
+	/** Call glVertexAttribPointer and set the correspondance between VBO and the location in the shader 
+	*    A VBO of mat4 is set on the 4 locations [location_index, location_index+3] */
 	void opengl_set_vao_location(opengl_vbo_structure const& vbo, GLuint location_index);
 
+	/** Set an attribute stored in an interleaved VBO: size_element components of type type_element, at offset (in Byte) in each vertex of size stride (in Byte)
+	*    normalized: integer values are converted to [0,1] (unsigned) or [-1,1] (signed) */
+	void opengl_set_vao_location(opengl_vbo_structure const& vbo, GLuint location_index, GLint size_element, GLenum type_element, bool normalized, GLuint offset, GLuint stride);
+
+	// Compressed vertex attributes
+	//  opengl_pack_int_2_10_10_10: (x,y,z) in [-1,1] stored on 10 bits each, to be read as GL_INT_2_10_10_10_REV normalized (ex. normals)
+	//  opengl_pack_half_float: 16 bits floating point (GL_HALF_FLOAT) - 11 bits of precision (ex. uv, with |uv| of the order of 1)
+	uint32_t opengl_pack_int_2_10_10_10(vec3 const& v);
+	uint16_t opengl_pack_half_float(float x);
+
 }
@@ -44,18 +44,149 @@ namespace cgp
             return "UNKNOWN";
         }
     }
-	void check_opengl_error(std::string const& file, std::string const& function, int line)
+	void check_opengl_error(char const* file, char const* function, int line)
 	{
         GLenum error = glGetError();
         if( error !=GL_NO_ERROR )
         {
             std::string msg = "OpenGL ERROR detected\n"
-                    "\tFile "+file+"\n"
-                    "\tFunction "+function+"\n"
+                    "\tFile "+str(file)+"\n"
+                    "\tFunction "+str(function)+"\n"
                     "\tLine "+str(line)+"\n"
                     "\tOpenGL Error: "+opengl_error_to_string(error);
 
             error_cgp(msg);
         }
 	}
-}
\ No newline at end of file
+
+
+#ifdef CGP_NO_DEBUG
+	static opengl_check_mode check_mode = opengl_check_mode::sampled;
+#else
+	static opengl_check_mode check_mode = opengl_check_mode::per_call;
+#endif
+	bool detail::opengl_check_per_call_active = (check_mode == opengl_check_mode::per_call);
+
+
+	// KHR_debug callback (not available with WebGL)
+	// ********************************************** //
+#ifndef __EMSCRIPTEN__
+#ifndef GL_DEBUG_OUTPUT
+#define GL_DEBUG_OUTPUT 0x92E0
+#endif
+#ifndef GL_DEBUG_OUTPUT_SYNCHRONOUS
+#define GL_DEBUG_OUTPUT_SYNCHRONOUS 0x8242
+#endif
+#ifndef GL_DEBUG_TYPE_ERROR
+#define GL_DEBUG_TYPE_ERROR 0x824C
+#endif
+#ifndef GL_DEBUG_SEVERITY_NOTIFICATION
+#define GL_DEBUG_SEVERITY_NOTIFICATION 0x826B
+#endif
+
+	typedef void (APIENTRY* debug_message_callback_function)(GLDEBUGPROC callback, void const* user_parameter);
+	static debug_message_callback_function debug_message_callback = nullptr;
+
+	static void APIENTRY opengl_debug_output(GLenum, GLenum type, GLuint, GLenum severity, GLsizei, GLchar const* message, void const*)
+	{
+		if (severity == GL_DEBUG_SEVERITY_NOTIFICATION)
+			return;
+		std::string const kind = (type == GL_DEBUG_TYPE_ERROR ? "OpenGL ERROR (debug output): " : "OpenGL message (debug output): ");
+		warning_cgp(kind + str(message), "");
+	}
+#endif
+
+	bool opengl_check_load_debug_output(void* (*get_proc_address)(char const* name))
+	{
+#ifndef __EMSCRIPTEN__
+		char const* names[] = { "glDebugMessageCallback", "glDebugMessageCallbackKHR", "glDebugMessageCallbackARB" };
+		for (char const* name : names) {
+			debug_message_callback = reinterpret_cast<debug_message_callback_function>(get_proc_address(name));
+			if (debug_message_callback != nullptr)
+				break;
+		}
+		return debug_message_callback != nullptr;
+#else
+		currently_unused(get_proc_address);
+		return false;
+#endif
+	}
+
+	bool opengl_check_debug_output_available()
+	{
+#ifndef __EMSCRIPTEN__
+		return debug_message_callback != nullptr;
+#else
+		return false;
+#endif
+	}
+
+
+	// Check policy
+	// ********************************************** //
+	void opengl_check_set_mode(opengl_check_mode mode)
+	{
+		if (mode == opengl_check_mode::debug_output && !opengl_check_debug_output_available()) {
+			warning_cgp("OpenGL debug output (KHR_debug) is not available - use per call checks instead", "");
+			mode = opengl_check_mode::per_call;
+		}
+
+#ifndef __EMSCRIPTEN__
+		if (debug_message_callback != nullptr && mode != check_mode) {
+			if (mode == opengl_check_mode::debug_output) {
+				glEnable(GL_DEBUG_OUTPUT);
+				glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS); // messages are reported in the faulty call (allow to use a debugger)
+				debug_message_callback(opengl_debug_output, nullptr);
+			}
+			else if (check_mode == opengl_check_mode::debug_output) {
+				debug_message_callback(nullptr, nullptr);
+				glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+				glDisable(GL_DEBUG_OUTPUT);
+			}
+		}
+#endif
+
+		// Don't report on the new mode the errors that happened before
+		while (glGetError() != GL_NO_ERROR) {}
+
+		check_mode = mode;
+		detail::opengl_check_per_call_active = (mode == opengl_check_mode::per_call);
+	}
+
+	opengl_check_mode opengl_check_get_mode()
+	{
+		return check_mode;
+	}
+
+	char const* opengl_check_mode_name(opengl_check_mode mode)
+	{
+		switch (mode)
+		{
+		case opengl_check_mode::off:
+			return "Off";
+		case opengl_check_mode::sampled:
+			return "Sampled (per frame)";
+		case opengl_check_mode::per_call:
+			return "Per call";
+		case opengl_check_mode::debug_output:
+			return "Debug output (KHR_debug)";
+		default:
+			return "Unknown";
+		}
+	}
+
+	void opengl_check_frame()
+	{
+		if (check_mode != opengl_check_mode::sampled)
+			return;
+
+		GLenum const error = glGetError();
+		if (error == GL_NO_ERROR)
+			return;
+		while (glGetError() != GL_NO_ERROR) {}
+
+		// The faulty call is unknown: check after each call from now on to locate it
+		warning_cgp("OpenGL ERROR detected during the frame: " + opengl_error_to_string(error), "Switching to per call OpenGL checks to locate the error.");
+		opengl_check_set_mode(opengl_check_mode::per_call);
+	}
+}
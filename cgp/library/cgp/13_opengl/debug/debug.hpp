@@ -3,15 +3,41 @@
 #include "cgp/opengl_include.hpp"
 #include <string>
 
-#ifndef CGP_NO_DEBUG
-#define opengl_check {cgp::check_opengl_error(__FILE__, __func__, __LINE__);}
+// opengl_check: check the OpenGL errors after a call, depending on the current opengl_check_mode
+//  The macro is removed at compilation if CGP_NO_OPENGL_CHECK is defined (independently of CGP_NO_DEBUG).
+#ifndef CGP_NO_OPENGL_CHECK
+#define opengl_check {if(cgp::opengl_check_per_call()) {cgp::check_opengl_error(__FILE__, __func__, __LINE__);} }
 #else
 #define opengl_check {}
 #endif
 
 namespace cgp
 {
+	// Policy used to detect the OpenGL errors
+	//  - off: no check
+	//  - sampled: glGetError is called once per frame (see opengl_check_frame). On error, the mode switches to per_call to locate the faulty call.
+	//  - per_call: glGetError is called at each opengl_check (each glGetError is a synchronization point with the driver)
+	//  - debug_output: errors are reported by the driver through a KHR_debug callback (if available, otherwise per_call is used)
+	// The default mode is per_call, or sampled when CGP_NO_DEBUG is defined.
+	enum class opengl_check_mode { off, sampled, per_call, debug_output };
+
+	void opengl_check_set_mode(opengl_check_mode mode);
+	opengl_check_mode opengl_check_get_mode();
+	char const* opengl_check_mode_name(opengl_check_mode mode);
+
+	// To be called once per frame (used by the sampled mode)
+	void opengl_check_frame();
+
+	// Load the KHR_debug functions needed by the debug_output mode, using the function loader of the window/context
+	//  Return true if the callback is available.
+	bool opengl_check_load_debug_output(void* (*get_proc_address)(char const* name));
+	bool opengl_check_debug_output_available();
+
 	std::string opengl_info_display();
-	void check_opengl_error(const std::string& file, const std::string& function, int line);
-}
+	void check_opengl_error(char const* file, char const* function, int line);
 
+	namespace detail {
+		extern bool opengl_check_per_call_active;
+	}
+	inline bool opengl_check_per_call() { return detail::opengl_check_per_call_active; }
+}
@@ -1,6 +1,7 @@
 #include "fbo.hpp"
 
 #include "cgp/01_base/base.hpp"
+#include "../state/opengl_state.hpp"
 
 
 namespace cgp{
@@ -37,13 +38,13 @@ namespace cgp{
 			texture.format = GL_DEPTH_COMPONENT;
 			texture.texture_type = GL_TEXTURE_2D;
 			glGenTextures(1, &texture.id); opengl_check;
-			glBindTexture(GL_TEXTURE_2D, texture.id); opengl_check;
+			opengl_state().bind_texture(GL_TEXTURE_2D, texture.id); opengl_check;
 			glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, width, height, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, nullptr); opengl_check;
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST); opengl_check;
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST); opengl_check;
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE); opengl_check;
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE); opengl_check;
-			glBindTexture(GL_TEXTURE_2D, 0); opengl_check;
+			opengl_state().bind_texture(GL_TEXTURE_2D, 0); opengl_check;
 
 			
 
@@ -91,9 +92,9 @@ namespace cgp{
 			height = new_height;
 
 			if(mode==opengl_fbo_mode::image){
-				glBindTexture(GL_TEXTURE_2D, texture.id);
+				opengl_state().bind_texture(GL_TEXTURE_2D, texture.id);
 				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-				glBindTexture(GL_TEXTURE_2D, 0);
+				opengl_state().bind_texture(GL_TEXTURE_2D, 0);
 
 				glBindRenderbuffer(GL_RENDERBUFFER, depth_buffer_id);
 				glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT32F, width, height);
@@ -101,9 +102,9 @@ namespace cgp{
 				opengl_check;
 			}
 			else if(mode==opengl_fbo_mode::depth){
-				glBindTexture(GL_TEXTURE_2D, texture.id);
+				opengl_state().bind_texture(GL_TEXTURE_2D, texture.id);
 				glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
-				glBindTexture(GL_TEXTURE_2D, 0);
+				opengl_state().bind_texture(GL_TEXTURE_2D, 0);
 				opengl_check;
 			}
 
@@ -2,10 +2,14 @@
 
 #include "cgp/opengl_include.hpp"
 
+#include "state/opengl_state.hpp"
 #include "buffer/buffer.hpp"
 #include "debug/debug.hpp"
 #include "uniform/uniform.hpp"
 #include "shaders/shaders.hpp"
 #include "texture/texture.hpp"
+#include "texture_residency/texture_residency.hpp"
+#include "texture_loader/texture_loader.hpp"
+#include "texture_registry/texture_registry.hpp"
 #include "fbo/fbo.hpp"
 #include "emscripten/emscripten.hpp"
\ No newline at end of file
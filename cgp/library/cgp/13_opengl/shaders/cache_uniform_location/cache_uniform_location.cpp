@@ -4,47 +4,104 @@
 #include "cgp/13_opengl/debug/debug.hpp"
 
 #include <iostream>
+#include <unordered_map>
 
 
 namespace cgp
 {
-    GLint cache_uniform_location_structure::query(GLuint shaderID, std::string const& uniformName)
+    // Table of all the uniform names used so far: name <-> handle id
+    namespace
     {
-        // Sanity check
-        assert_cgp(shaderID != 0, "Try to query uniform " + uniformName + " on unspecified shader (shader index = 0).");
+        struct uniform_name_table_structure {
+            std::unordered_map<std::string, int> index;
+            std::vector<std::string> names;
+        };
 
-        // Check if shaderID is already recorded
-        auto shaderID_it = cache_data.find(shaderID);
+        uniform_name_table_structure& uniform_name_table()
+        {
+            static uniform_name_table_structure table;
+            return table;
+        }
 
-        // If new shader, then create an empty map
-        if (shaderID_it == cache_data.end())
-            cache_data[shaderID] = std::map<std::string, GLint>();
+        int uniform_name_id(std::string const& uniform_name)
+        {
+            uniform_name_table_structure& table = uniform_name_table();
+            auto const it = table.index.find(uniform_name);
+            if (it != table.index.end())
+                return it->second;
 
-        // Check if uniformName is already recorded
-        std::map<std::string, GLint>& cacheShaderQuery = cache_data[shaderID];
-        auto uniformLoc_it = cacheShaderQuery.find(uniformName);
+            int const id = int(table.names.size());
+            table.names.push_back(uniform_name);
+            table.index[uniform_name] = id;
+            return id;
+        }
 
-        // If found, return the cached value
-        if (uniformLoc_it != cacheShaderQuery.end())
-            return uniformLoc_it->second;
+        // Location not queried yet in the shader
+        GLint const location_unknown = -2;
+    }
 
-        // Else: the name is not found
-        // Then we query the location using glGetUniformLocation in the shader
-        GLint const location = glGetUniformLocation(shaderID, uniformName.c_str()); opengl_check;
+    opengl_uniform_handle::opengl_uniform_handle(std::string const& uniform_name)
+        :id(uniform_name_id(uniform_name))
+    {}
 
-        // Add the location in the cache system
-        //  Note: location == -1 if glGetUniformLocation cannot find the variable
-        cacheShaderQuery[uniformName] = location;
+    opengl_uniform_handle::opengl_uniform_handle(char const* uniform_name)
+        :id(uniform_name_id(uniform_name))
+    {}
 
+    std::string const& opengl_uniform_handle::name() const
+    {
+        assert_cgp_no_msg(id >= 0);
+        return uniform_name_table().names[id];
+    }
+
+
+    GLint cache_uniform_location_structure::query(GLuint shaderID, opengl_uniform_handle const& uniform)
+    {
+        // Sanity check
+        assert_cgp(shaderID != 0, "Try to query uniform " + uniform.name() + " on unspecified shader (shader index = 0).");
+        assert_cgp(uniform.id >= 0, "Try to query an empty uniform handle");
+
+        // Table of the shader (created at its first query)
+        if (shaderID >= location_table.size())
+            location_table.resize(shaderID + 1);
+        std::vector<GLint>& locations = location_table[shaderID];
+        if (uniform.id >= int(locations.size()))
+            locations.resize(uniform.id + 1, location_unknown);
+
+        // If found, return the cached value
+        GLint& location = locations[uniform.id];
+        if (location != location_unknown)
+            return location;
+
+        // Else: query the location using glGetUniformLocation in the shader, and add it in the cache
+        //  Note: location == -1 if glGetUniformLocation cannot find the variable
+        location = glGetUniformLocation(shaderID, uniform.name().c_str()); opengl_check;
         return location;
     }
 
+    GLint cache_uniform_location_structure::query(GLuint shaderID, std::string const& uniformName)
+    {
+        return query(shaderID, opengl_uniform_handle(uniformName));
+    }
+
+    void cache_uniform_location_structure::clear()
+    {
+        location_table.clear();
+    }
+
     std::string str(cache_uniform_location_structure const& cache)
     {
         std::string s;
-        for (auto it1 : cache.cache_data) {
-            for (auto it2 : it1.second) {
-                s += str(it1.first) + " : " + str(it2.first) + " -> " + str(it2.second) + "\n";
+        for (size_t shaderID = 0; shaderID < cache.location_table.size(); ++shaderID) {
+            std::vector<GLint> const& locations = cache.location_table[shaderID];
+            if (locations.empty())
+                continue;
+            for (size_t k = 0; k < locations.size(); ++k) {
+                if (locations[k] != location_unknown) {
+                    opengl_uniform_handle handle;
+                    handle.id = int(k);
+                    s += str(shaderID) + " : " + handle.name() + " -> " + str(locations[k]) + "\n";
+                }
             }
             s += "\n";
         }
@@ -57,4 +114,4 @@ namespace cgp
         return s;
     }
 
-}
\ No newline at end of file
+}
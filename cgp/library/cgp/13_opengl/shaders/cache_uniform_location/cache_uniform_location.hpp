@@ -3,25 +3,53 @@
 #include "cgp/opengl_include.hpp"
 
 #include <string>
-#include <map>
+#include <vector>
 
 namespace cgp
 {
-	// Caching system to store the correspondance between a uniform name and its location for a given shader
-	// Usage: location = cache_uniform_location.query(shaderID, uniformName)
+	// Handle designating a uniform variable by its name, independently of the shader
+	//  The name is converted once into an integer id (shared by all the handles with the same name), the locations are then
+	//  read in a flat table per shader without any string manipulation.
+	// Usage: declare the handle once, and use it at each draw call
+	//   static opengl_uniform_handle const uniform_model("model");
+	//   opengl_uniform(shader, uniform_model, model_matrix);
+	// Note: the handles must be created and used by the rendering thread only.
+	struct opengl_uniform_handle
+	{
+		// Index of the name in the table of uniform names (-1 for an empty handle)
+		int id = -1;
+
+		opengl_uniform_handle() = default;
+		explicit opengl_uniform_handle(std::string const& uniform_name);
+		explicit opengl_uniform_handle(char const* uniform_name);
+
+		// Name of the uniform variable
+		std::string const& name() const;
+	};
+
+
+	// Caching system to store the correspondance between a uniform and its location for a given shader
+	// Usage: location = cache_uniform_location.query(shaderID, uniform_handle)
+	//    or: location = cache_uniform_location.query(shaderID, uniformName)
 	struct cache_uniform_location_structure
 	{
-		std::map<GLuint, std::map<std::string, GLint> > cache_data;
+		// Location of the uniforms for each shader: location_table[shaderID][handle.id]
+		//  (the shader ids given by OpenGL are small integers)
+		std::vector<std::vector<GLint> > location_table;
 
 		// Return the location of the uniform in the shader designated by shaderID and update the caching system
 		//  Query glGetUniformLocation the first time the variable is queried and save it.
 		//  The following times, the variable is read from the cache without requiring access to glGetUniformLocation (that can slow down rendering pipeline)
-		//  If uniformName is not found return (and cache) the value -1.
+		//  If the uniform is not found return (and cache) the value -1.
+		GLint query(GLuint shaderID, opengl_uniform_handle const& uniform);
+		// Same query from the name of the uniform (the name is converted into a handle at each call)
 		GLint query(GLuint shaderID, std::string const& uniformName);
 
+		// Remove all the cached locations
+		void clear();
 	};
 
 	std::string str(cache_uniform_location_structure const& cache);
 	std::ostream& operator<<(std::ostream& s, cache_uniform_location_structure const& cache);
 
-}
\ No newline at end of file
+}
@@ -68,9 +68,14 @@ namespace cgp
         return cache_uniform_location.query(id, uniform_name);
     }
 
+    GLint opengl_shader_structure::query_uniform_location(opengl_uniform_handle const& uniform) const
+    {
+        return cache_uniform_location.query(id, uniform);
+    }
+
     void opengl_shader_structure::clear_cache_uniform_location()
     {
-        cache_uniform_location.cache_data.clear();
+        cache_uniform_location.clear();
     }
     std::string opengl_shader_structure::debug_dump_cache_uniform_location()
     {
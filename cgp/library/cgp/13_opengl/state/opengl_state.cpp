@@ -0,0 +1,125 @@
+#include "opengl_state.hpp"
+#include "../debug/debug.hpp"
+
+namespace cgp
+{
+	opengl_state_structure::opengl_state_structure()
+	{
+		invalidate();
+	}
+
+	void opengl_state_structure::use_program(GLuint program)
+	{
+		if (program == current_program) {
+			counters.program_binds_avoided++;
+			return;
+		}
+		glUseProgram(program); opengl_check;
+		current_program = program;
+		counters.program_binds++;
+	}
+
+	void opengl_state_structure::active_texture(GLuint unit)
+	{
+		if (unit == current_unit) {
+			counters.active_texture_avoided++;
+			return;
+		}
+		glActiveTexture(GL_TEXTURE0 + unit); opengl_check;
+		current_unit = unit;
+		counters.active_texture_changes++;
+	}
+
+	GLuint* opengl_state_structure::texture_slot(GLuint unit, GLenum target)
+	{
+		if (unit >= GLuint(texture_unit_max))
+			return nullptr;
+		if (target == GL_TEXTURE_2D)
+			return &texture_2d[unit];
+		if (target == GL_TEXTURE_CUBE_MAP)
+			return &texture_cube_map[unit];
+		return nullptr;
+	}
+
+	void opengl_state_structure::bind_texture(GLenum target, GLuint texture)
+	{
+		// The active unit is unknown after invalidate(): the binding can't be tracked
+		GLuint* slot = current_unit == unknown ? nullptr : texture_slot(current_unit, target);
+		if (slot != nullptr && *slot == texture) {
+			counters.texture_binds_avoided++;
+			return;
+		}
+		glBindTexture(target, texture); opengl_check;
+		if (slot != nullptr)
+			*slot = texture;
+		counters.texture_binds++;
+	}
+
+	void opengl_state_structure::bind_texture(GLuint unit, GLenum target, GLuint texture)
+	{
+		GLuint* slot = texture_slot(unit, target);
+		if (slot != nullptr && *slot == texture) {
+			counters.texture_binds_avoided++;
+			return;
+		}
+		active_texture(unit);
+		bind_texture(target, texture);
+	}
+
+	void opengl_state_structure::bind_vertex_array(GLuint vao)
+	{
+		if (vao == current_vertex_array) {
+			counters.vertex_array_binds_avoided++;
+			return;
+		}
+		glBindVertexArray(vao); opengl_check;
+		current_vertex_array = vao;
+		counters.vertex_array_binds++;
+	}
+
+	void opengl_state_structure::forget_program(GLuint program)
+	{
+		// A deleted program stays in use until another one is installed: only the id can't be trusted anymore
+		if (program == current_program)
+			current_program = unknown;
+	}
+
+	void opengl_state_structure::forget_texture(GLuint texture)
+	{
+		for (int k = 0; k < texture_unit_max; ++k) {
+			if (texture_2d[k] == texture)
+				texture_2d[k] = 0;
+			if (texture_cube_map[k] == texture)
+				texture_cube_map[k] = 0;
+		}
+	}
+
+	void opengl_state_structure::forget_vertex_array(GLuint vao)
+	{
+		if (vao == current_vertex_array)
+			current_vertex_array = 0;
+	}
+
+	void opengl_state_structure::invalidate()
+	{
+		current_program = unknown;
+		current_vertex_array = unknown;
+		current_unit = unknown;
+		for (int k = 0; k < texture_unit_max; ++k) {
+			texture_2d[k] = unknown;
+			texture_cube_map[k] = unknown;
+		}
+	}
+
+	void opengl_state_structure::end_frame()
+	{
+		counters_previous = counters;
+		counters = counters_structure();
+	}
+
+	opengl_state_structure& opengl_state()
+	{
+		static opengl_state_structure state;
+		return state;
+	}
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "cgp/opengl_include.hpp"
+
+#include <cstddef>
+
+namespace cgp
+{
+	/** Shadow copy of the OpenGL bindings (program, active texture unit, textures, vertex array)
+	 * The bind functions only call OpenGL when the value differs from the one already bound: consecutive draw calls
+	 * sharing a shader/texture/VAO don't rebind them. All the binds of cgp go through this structure.
+	 * - Code changing these bindings with direct OpenGL calls must call invalidate() afterwards.
+	 * - Deleting a bound object resets the binding to 0 in OpenGL: call the corresponding forget_xxx() function.
+	 * Only valid for the OpenGL context of the render thread. */
+	struct opengl_state_structure
+	{
+		struct counters_structure
+		{
+			size_t program_binds = 0;              // Calls to glUseProgram
+			size_t program_binds_avoided = 0;      // glUseProgram skipped as the program was already in use
+			size_t texture_binds = 0;              // Calls to glBindTexture
+			size_t texture_binds_avoided = 0;      // glBindTexture skipped as the texture was already bound
+			size_t active_texture_changes = 0;     // Calls to glActiveTexture
+			size_t active_texture_avoided = 0;     // glActiveTexture skipped as the unit was already active
+			size_t vertex_array_binds = 0;         // Calls to glBindVertexArray
+			size_t vertex_array_binds_avoided = 0; // glBindVertexArray skipped as the VAO was already bound
+		};
+
+		// Counters since the last call to end_frame(), and counters of the previous frame
+		counters_structure counters;
+		counters_structure counters_previous;
+
+		void use_program(GLuint program);
+		// Activate the texture unit GL_TEXTURE0+unit
+		void active_texture(GLuint unit);
+		// Bind a texture on the active unit (target: GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP)
+		void bind_texture(GLenum target, GLuint texture);
+		// Activate the unit, and bind the texture on it
+		void bind_texture(GLuint unit, GLenum target, GLuint texture);
+		void bind_vertex_array(GLuint vao);
+
+		// Current values (as seen by this structure)
+		GLuint program() const { return current_program; }
+		GLuint vertex_array() const { return current_vertex_array; }
+
+		// To be called after the deletion of an OpenGL object
+		void forget_program(GLuint program);
+		void forget_texture(GLuint texture);
+		void forget_vertex_array(GLuint vao);
+
+		// Consider all the bindings as unknown: the next bind functions call OpenGL
+		void invalidate();
+
+		// Store the counters of the frame in counters_previous, and restart them
+		void end_frame();
+
+		opengl_state_structure();
+
+	private:
+		static constexpr int texture_unit_max = 16;
+		static constexpr GLuint unknown = ~GLuint(0);
+
+		GLuint current_program;
+		GLuint current_vertex_array;
+		GLuint current_unit;
+		GLuint texture_2d[texture_unit_max];
+		GLuint texture_cube_map[texture_unit_max];
+
+		GLuint* texture_slot(GLuint unit, GLenum target);
+	};
+
+	// Binding state of the OpenGL context of the render thread
+	opengl_state_structure& opengl_state();
+}
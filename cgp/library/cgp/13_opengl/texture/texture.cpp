@@ -1,6 +1,7 @@
 #include "texture.hpp"
 
 #include "cgp/01_base/base.hpp"
+#include "../state/opengl_state.hpp"
 
 namespace cgp
 {
@@ -48,7 +49,7 @@ namespace cgp
         // Create texture
         GLuint id = 0;
         glGenTextures(1, &id); opengl_check;
-        glBindTexture(texture_type, id); opengl_check;
+        opengl_state().bind_texture(texture_type, id); opengl_check;
 
         glTexImage2D(texture_type, 0, format, width, height, 0, gl_format, data_type, data); opengl_check;
 
@@ -63,7 +64,7 @@ namespace cgp
         glTexParameteri(texture_type, GL_TEXTURE_MIN_FILTER, texture_min_filter); opengl_check;
         
 
-        glBindTexture(texture_type, 0); opengl_check;
+        opengl_state().bind_texture(texture_type, 0); opengl_check;
 
         assert_cgp(glIsTexture(id), "Incorrect texture id");
         return id;
@@ -72,16 +73,17 @@ namespace cgp
     void opengl_texture_image_structure::bind() const
     {
         assert_cgp(id!=0, "Incorrect texture id");
-        glBindTexture(texture_type, id); opengl_check;
+        opengl_state().bind_texture(texture_type, id); opengl_check;
     }
     void opengl_texture_image_structure::unbind() const
     {
-        glBindTexture(texture_type, 0); opengl_check;
+        opengl_state().bind_texture(texture_type, 0); opengl_check;
     }
     void opengl_texture_image_structure::clear()
     {
         assert_cgp(id != 0, "Cannot clear texture, ID=0");
         glDeleteTextures(1, &id);
+        opengl_state().forget_texture(id);
         *this = opengl_texture_image_structure();
     }
 
@@ -111,6 +113,100 @@ namespace cgp
         initialize_texture_2d_on_gpu(im, wrap_s, wrap_t, is_mipmap, texture_mag_filter, texture_min_filter);
     }
 
+    void opengl_texture_image_structure::initialize_texture_2d_on_gpu(std::vector<image_structure> const& mipmap_levels, GLint wrap_s, GLint wrap_t, GLint texture_mag_filter, GLint texture_min_filter)
+    {
+        assert_cgp(mipmap_levels.size() > 0, "Empty mipmap levels");
+        image_structure const& im = mipmap_levels[0];
+
+        // Store parameters
+        width = im.width;
+        height = im.height;
+        format = (im.color_type==image_color_type::rgba ? GL_RGBA8 : GL_RGB8);
+        texture_type = GL_TEXTURE_2D;
+        GLenum const gl_format = format_to_data_type(format);
+
+        glGenTextures(1, &id); opengl_check;
+        opengl_state().bind_texture(texture_type, id); opengl_check;
+
+        int const level_count = int(mipmap_levels.size());
+        for (int level = 0; level < level_count; ++level) {
+            image_structure const& level_image = mipmap_levels[level];
+            glTexImage2D(texture_type, level, format, level_image.width, level_image.height, 0, gl_format, GL_UNSIGNED_BYTE, ptr(level_image.data)); opengl_check;
+        }
+        glTexParameteri(texture_type, GL_TEXTURE_MAX_LEVEL, level_count - 1); opengl_check;
+
+        glTexParameteri(texture_type, GL_TEXTURE_WRAP_S, wrap_s); opengl_check;
+        glTexParameteri(texture_type, GL_TEXTURE_WRAP_T, wrap_t); opengl_check;
+        glTexParameteri(texture_type, GL_TEXTURE_MAG_FILTER, texture_mag_filter); opengl_check;
+        glTexParameteri(texture_type, GL_TEXTURE_MIN_FILTER, texture_min_filter); opengl_check;
+
+        opengl_state().bind_texture(texture_type, 0); opengl_check;
+    }
+
+    bool opengl_texture_compression_available()
+    {
+        static int available = -1; // unknown until the first call (requires a context)
+        if (available == -1) {
+            available = 0;
+            GLint extension_count = 0;
+            glGetIntegerv(GL_NUM_EXTENSIONS, &extension_count); opengl_check;
+            for (GLint k = 0; k < extension_count && available == 0; ++k) {
+                char const* name = reinterpret_cast<char const*>(glGetStringi(GL_EXTENSIONS, GLuint(k)));
+                std::string const extension = (name != nullptr ? name : "");
+                // GL_EXT_texture_compression_s3tc on desktop, WEBGL_compressed_texture_s3tc on WebGL
+                if (extension.find("texture_compression_s3tc") != std::string::npos || extension.find("compressed_texture_s3tc") != std::string::npos)
+                    available = 1;
+            }
+        }
+        return available == 1;
+    }
+
+    GLint opengl_compressed_format(image_compression_format format)
+    {
+        return format == image_compression_format::bc1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    }
+
+    void opengl_texture_image_structure::initialize_texture_2d_on_gpu(image_compressed_structure const& im, GLint wrap_s, GLint wrap_t, bool is_mipmap, GLint texture_mag_filter, GLint texture_min_filter)
+    {
+        assert_cgp(im.level_count() > 0, "Empty compressed image");
+        bool const is_compressed = opengl_texture_compression_available();
+
+        // Store parameters
+        width = im.width;
+        height = im.height;
+        format = is_compressed ? opengl_compressed_format(im.format) : GL_RGBA8;
+        texture_type = GL_TEXTURE_2D;
+
+        glGenTextures(1, &id); opengl_check;
+        opengl_state().bind_texture(texture_type, id); opengl_check;
+
+        // The mipmap levels are given by the image (no glGenerateMipmap)
+        int const level_count = is_mipmap ? im.level_count() : 1;
+        for (int level = 0; level < level_count; ++level) {
+            if (is_compressed) {
+                glCompressedTexImage2D(texture_type, level, format, im.level_width(level), im.level_height(level), 0, GLsizei(im.levels[level].size()), ptr(im.levels[level])); opengl_check;
+            }
+            else {
+                image_structure const level_image = image_decompress(im, level);
+                glTexImage2D(texture_type, level, format, level_image.width, level_image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, ptr(level_image.data)); opengl_check;
+            }
+        }
+        glTexParameteri(texture_type, GL_TEXTURE_MAX_LEVEL, level_count - 1); opengl_check;
+
+        glTexParameteri(texture_type, GL_TEXTURE_WRAP_S, wrap_s); opengl_check;
+        glTexParameteri(texture_type, GL_TEXTURE_WRAP_T, wrap_t); opengl_check;
+        glTexParameteri(texture_type, GL_TEXTURE_MAG_FILTER, texture_mag_filter); opengl_check;
+        glTexParameteri(texture_type, GL_TEXTURE_MIN_FILTER, texture_min_filter); opengl_check;
+
+        opengl_state().bind_texture(texture_type, 0); opengl_check;
+    }
+
+    void opengl_texture_image_structure::load_and_initialize_compressed_texture_2d_on_gpu(std::string const& filename, GLint wrap_s, GLint wrap_t, bool is_mipmap, GLint texture_mag_filter, GLint texture_min_filter)
+    {
+        image_compressed_structure const im = image_load_file_compressed(filename);
+        initialize_texture_2d_on_gpu(im, wrap_s, wrap_t, is_mipmap, texture_mag_filter, texture_min_filter);
+    }
+
     void opengl_texture_image_structure::initialize_texture_2d_on_gpu(grid_2D<vec3> const& im, GLint wrap_s, GLint wrap_t, bool is_mippmap, GLint texture_mag_filter, GLint texture_min_filter)
     {
         // Store parameters
@@ -162,7 +258,7 @@ namespace cgp
         
         // Send images to GPU as cubemap
         glGenTextures(1, &id);
-        glBindTexture(texture_type, id);
+        opengl_state().bind_texture(texture_type, id);
 
         GLenum const gl_format = format_to_data_type(format);    // expect GL_RGB or GL_RGBA
         GLenum const gl_component = format_to_component(format); // expect GL_UNISNGED_BYTE
@@ -185,7 +281,7 @@ namespace cgp
         glTexParameteri(texture_type, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 
 
-        glBindTexture(texture_type, 0);
+        opengl_state().bind_texture(texture_type, 0);
     }
 
 
@@ -193,20 +289,20 @@ namespace cgp
     {
         assert_cgp(glIsTexture(id), "Incorrect texture id");
 
-        glBindTexture(texture_type, id);
+        opengl_state().bind_texture(texture_type, id);
         glTexSubImage2D(texture_type, 0, 0, 0, GLsizei(im.dimension.x), GLsizei(im.dimension.y), format_to_data_type(format), format_to_component(format), ptr(im.data));
         glGenerateMipmap(texture_type);
-        glBindTexture(texture_type, 0);
+        opengl_state().bind_texture(texture_type, 0);
     }
 
     void opengl_texture_image_structure::update(image_structure const& im)
     {
         assert_cgp(glIsTexture(id), "Incorrect texture id");
 
-        glBindTexture(texture_type, id);
+        opengl_state().bind_texture(texture_type, id);
         glTexSubImage2D(texture_type, 0, 0, 0, GLsizei(im.width), GLsizei(im.height), format_to_data_type(format), format_to_component(format), ptr(im.data));
         glGenerateMipmap(texture_type);
-        glBindTexture(texture_type, 0);
+        opengl_state().bind_texture(texture_type, 0);
     }
 
     //void opengl_texture_image_structure::update(GLuint texture_id, grid_2D<vec3> const& im)
@@ -233,7 +329,7 @@ namespace cgp
     {
         GLuint id = 0;
         glGenTextures(1,&id); opengl_check;
-        glBindTexture(GL_TEXTURE_2D,id); opengl_check;
+        opengl_state().bind_texture(GL_TEXTURE_2D,id); opengl_check;
 
         // Send texture on GPU
         if(im.color_type==image_color_type::rgba){
@@ -251,7 +347,7 @@ namespace cgp
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); opengl_check;
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR); opengl_check;
 
-        glBindTexture(GL_TEXTURE_2D,0); opengl_check;
+        opengl_state().bind_texture(GL_TEXTURE_2D,0); opengl_check;
 
         return id;
     }
@@ -259,7 +355,7 @@ namespace cgp
     {
         GLuint id = 0;
         glGenTextures(1,&id); opengl_check;
-        glBindTexture(GL_TEXTURE_2D,id); opengl_check;
+        opengl_state().bind_texture(GL_TEXTURE_2D,id); opengl_check;
 
         // Send texture on GPU
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, GLsizei(im.dimension.x), GLsizei(im.dimension.y), 0, GL_RGB, GL_FLOAT, ptr(im.data)); opengl_check;
@@ -272,7 +368,7 @@ namespace cgp
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 
-        glBindTexture(GL_TEXTURE_2D,0);
+        opengl_state().bind_texture(GL_TEXTURE_2D,0);
 
         return id;
     }
@@ -280,10 +376,10 @@ namespace cgp
     {
         assert_cgp(glIsTexture(texture_id), "Incorrect texture id");
 
-        glBindTexture(GL_TEXTURE_2D, texture_id);
+        opengl_state().bind_texture(GL_TEXTURE_2D, texture_id);
         glTexSubImage2D(GL_TEXTURE_2D, 0, 0,0, GLsizei(im.dimension.x), GLsizei(im.dimension.y), GL_RGB, GL_FLOAT, ptr(im.data));
         glGenerateMipmap(GL_TEXTURE_2D);
-        glBindTexture(GL_TEXTURE_2D,0);
+        opengl_state().bind_texture(GL_TEXTURE_2D,0);
     }
 
 
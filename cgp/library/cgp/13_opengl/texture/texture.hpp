@@ -7,6 +7,13 @@
 #include "cgp/07_image/image.hpp"
 
 
+// S3TC formats (EXT_texture_compression_s3tc), not part of the OpenGL core headers
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
 
 
 namespace cgp
@@ -18,7 +25,7 @@ namespace cgp
 		int width;  // image width
 		int height; // image height
 
-		GLint format; // GL_RGB8, GL_RGBA8, GL_RGBF32
+		GLint format; // GL_RGB8, GL_RGBA8, GL_RGBF32, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
 
 		GLenum texture_type; // = GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP
 
@@ -40,6 +47,17 @@ namespace cgp
 		// Initialize a GL_TEXTURE_2D from an image
 		void initialize_texture_2d_on_gpu(image_structure const& im, GLint wrap_s = GL_CLAMP_TO_EDGE, GLint wrap_t = GL_CLAMP_TO_EDGE, bool is_mipmap = true, GLint texture_mag_filter = GL_LINEAR, GLint texture_min_filter = GL_LINEAR_MIPMAP_LINEAR);
 
+		// Initialize a GL_TEXTURE_2D from its mipmap levels computed on the CPU (see image_mipmap_chain) instead of glGenerateMipmap
+		void initialize_texture_2d_on_gpu(std::vector<image_structure> const& mipmap_levels, GLint wrap_s = GL_CLAMP_TO_EDGE, GLint wrap_t = GL_CLAMP_TO_EDGE, GLint texture_mag_filter = GL_LINEAR, GLint texture_min_filter = GL_LINEAR_MIPMAP_LINEAR);
+
+		// Initialize a GL_TEXTURE_2D from a compressed image (is_mipmap: its mipmap levels are sent as well)
+		//  The levels are decompressed (GL_RGBA8) if the GPU doesn't support the S3TC formats
+		void initialize_texture_2d_on_gpu(image_compressed_structure const& im, GLint wrap_s = GL_CLAMP_TO_EDGE, GLint wrap_t = GL_CLAMP_TO_EDGE, bool is_mipmap = true, GLint texture_mag_filter = GL_LINEAR, GLint texture_min_filter = GL_LINEAR_MIPMAP_LINEAR);
+
+		// Shortcut to initialize a compressed GL_TEXTURE_2D from an image file
+		//  Similar to: initialize_texture_2d_on_gpu( image_load_file_compressed(filename), ...)
+		void load_and_initialize_compressed_texture_2d_on_gpu(std::string const& filename, GLint wrap_s = GL_CLAMP_TO_EDGE, GLint wrap_t = GL_CLAMP_TO_EDGE, bool is_mipmap = true, GLint texture_mag_filter = GL_LINEAR, GLint texture_min_filter = GL_LINEAR_MIPMAP_LINEAR);
+
 		// Initialize a GL_TEXTURE_2D from a float grid
 		void initialize_texture_2d_on_gpu(grid_2D<vec3> const& im, GLint wrap_s = GL_CLAMP_TO_EDGE, GLint wrap_t = GL_CLAMP_TO_EDGE, bool is_mipmap = true, GLint texture_mag_filter = GL_LINEAR, GLint texture_min_filter = GL_LINEAR_MIPMAP_LINEAR);
 
@@ -54,6 +72,11 @@ namespace cgp
 		void update(image_structure const& im);
 	};
 
+	// True if the GPU supports the S3TC compressed formats (bc1/bc3)
+	bool opengl_texture_compression_available();
+	// OpenGL internal format of a compressed image
+	GLint opengl_compressed_format(image_compression_format format);
+
 	// Read an image from file and initialize an opengl texture image from it
 	GLuint opengl_load_texture_image(std::string const& filename, GLint wrap_s = GL_CLAMP_TO_EDGE, GLint wrap_t = GL_CLAMP_TO_EDGE);
 
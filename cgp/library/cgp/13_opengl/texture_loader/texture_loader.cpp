@@ -0,0 +1,381 @@
+#include "texture_loader.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "../debug/debug.hpp"
+#include "../state/opengl_state.hpp"
+#include "../texture_residency/texture_residency.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <limits>
+#include <utility>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace cgp
+{
+	namespace detail
+	{
+		enum texture_load_status { texture_load_decoding = 0, texture_load_decoded, texture_load_ready, texture_load_failed };
+
+		struct texture_load_job
+		{
+			std::string filename;
+			bool is_mipmap;
+			bool is_compressed;
+			bool is_streamed; // the mipmap levels are given to opengl_texture_residency()
+			image_mipmap_filter mipmap_filter;
+
+			opengl_texture_image_structure texture;
+			std::vector<image_structure> levels; // decoded image and its mipmap levels, released after the upload
+			image_compressed_structure image_compressed; // used instead of image when is_compressed
+			std::atomic<int> status{ texture_load_decoding };
+			std::atomic<bool> discarded{ false }; // the texture is deleted: the upload is skipped
+		};
+
+		static void decode(texture_load_job& job)
+		{
+			try {
+				if (job.is_compressed) {
+					job.image_compressed = image_load_file_compressed(job.filename);
+					job.status = texture_load_decoded;
+				}
+				else {
+					image_structure im = image_load_file(job.filename);
+					if (im.width > 0 && im.height > 0) {
+						if (job.is_mipmap)
+							job.levels = image_mipmap_chain(std::move(im), job.mipmap_filter);
+						else
+							job.levels.push_back(std::move(im));
+						job.status = texture_load_decoded;
+					}
+					else
+						job.status = texture_load_failed;
+				}
+			}
+			catch (std::exception const&) {
+				job.status = texture_load_failed;
+			}
+		}
+	}
+
+	opengl_texture_image_structure const& opengl_texture_load_handle::texture() const
+	{
+		assert_cgp(job != nullptr, "Empty texture load handle");
+		return job->texture;
+	}
+	bool opengl_texture_load_handle::is_ready() const
+	{
+		return job != nullptr && job->status == detail::texture_load_ready;
+	}
+	bool opengl_texture_load_handle::has_failed() const
+	{
+		return job != nullptr && job->status == detail::texture_load_failed;
+	}
+
+
+	opengl_texture_load_handle opengl_texture_loader_structure::load_texture_2d(std::string const& filename, GLint wrap_s, GLint wrap_t, bool is_mipmap, GLint texture_mag_filter, GLint texture_min_filter)
+	{
+		std::shared_ptr<detail::texture_load_job> job = std::make_shared<detail::texture_load_job>();
+		job->filename = filename;
+		job->is_mipmap = is_mipmap;
+		job->is_compressed = use_compression && opengl_texture_compression_available();
+		job->is_streamed = stream_mipmaps && is_mipmap;
+		job->mipmap_filter = mipmap_filter;
+
+		// The texture is created now with a 1x1 placeholder: its id can be used right away
+		opengl_texture_image_structure& texture = job->texture;
+		texture.width = 1;
+		texture.height = 1;
+		texture.format = GL_RGBA8;
+		texture.texture_type = GL_TEXTURE_2D;
+
+		glGenTextures(1, &texture.id); opengl_check;
+		opengl_state().bind_texture(GL_TEXTURE_2D, texture.id);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder_color); opengl_check;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap_s); opengl_check;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap_t); opengl_check;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, texture_mag_filter); opengl_check;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texture_min_filter); opengl_check;
+		opengl_state().bind_texture(GL_TEXTURE_2D, 0);
+
+		if (workers.empty())
+			start_workers();
+
+		{
+			std::lock_guard<std::mutex> lock(jobs_mutex);
+			jobs.push_back(job);
+			pending++;
+		}
+		jobs_condition.notify_one();
+
+		opengl_texture_load_handle handle;
+		handle.job = job;
+		return handle;
+	}
+
+	int opengl_texture_loader_structure::upload(float budget_ms)
+	{
+		typedef std::chrono::steady_clock clock;
+		clock::time_point const start = clock::now();
+
+		int uploaded = 0;
+		while (true)
+		{
+			std::shared_ptr<detail::texture_load_job> job;
+			{
+				std::lock_guard<std::mutex> lock(jobs_mutex);
+				if (!decoded.empty()) {
+					job = decoded.front();
+					decoded.pop_front();
+				}
+				else if (workers.empty() && !jobs.empty()) {
+					// No worker thread (emscripten): the decoding is done here, within the same budget
+					job = jobs.front();
+					jobs.pop_front();
+				}
+			}
+			if (job == nullptr)
+				break;
+
+			if (job->status == detail::texture_load_decoding && !job->discarded)
+				detail::decode(*job);
+
+			if (job->discarded) {
+				job->levels.clear();
+				job->image_compressed = image_compressed_structure();
+			}
+			else if (job->status == detail::texture_load_failed) {
+				warning_cgp("Cannot load the texture (the placeholder is kept)", "Filename=" + job->filename);
+			}
+			else {
+				if (job->is_compressed)
+					upload_job_compressed(*job);
+				else
+					upload_job(*job);
+				uploaded++;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(jobs_mutex);
+				pending--;
+			}
+
+			double const elapsed_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+			if (elapsed_ms >= budget_ms)
+				break;
+		}
+
+		counters.upload_time_ms += std::chrono::duration<double, std::milli>(clock::now() - start).count();
+		return uploaded;
+	}
+
+	void opengl_texture_loader_structure::upload_job(detail::texture_load_job& job)
+	{
+		image_structure const& im = job.levels[0];
+		opengl_texture_image_structure& texture = job.texture;
+		texture.width = im.width;
+		texture.height = im.height;
+		texture.format = (im.color_type == image_color_type::rgba ? GL_RGBA8 : GL_RGB8);
+		GLenum const gl_format = (im.color_type == image_color_type::rgba ? GL_RGBA : GL_RGB);
+
+		if (job.is_streamed) {
+			opengl_texture_residency().add(texture, std::move(job.levels));
+			counters.textures_uploaded++;
+			counters.bytes_uploaded += opengl_texture_residency().resident_bytes(texture);
+			job.levels.clear();
+			job.status = detail::texture_load_ready;
+			return;
+		}
+
+		// The pixels go through a pixel buffer: glTexImage2D reads them from the buffer, the driver can transfer them asynchronously
+		//  A new storage is given at each upload (orphaning) to avoid waiting for the transfer of the previous image
+		//  All the levels are copied in the buffer, then sent one by one from their offset
+		int const level_count = int(job.levels.size());
+		size_t size = 0;
+		for (int level = 0; level < level_count; ++level)
+			size += job.levels[level].data.size();
+
+		if (pbo == 0) {
+			glGenBuffers(1, &pbo); opengl_check;
+		}
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo); opengl_check;
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, GLsizeiptr(size), NULL, GL_STREAM_DRAW); opengl_check;
+
+		opengl_state().bind_texture(GL_TEXTURE_2D, texture.id);
+		size_t offset = 0;
+		for (int level = 0; level < level_count; ++level) {
+			image_structure const& level_image = job.levels[level];
+			glBufferSubData(GL_PIXEL_UNPACK_BUFFER, GLintptr(offset), GLsizeiptr(level_image.data.size()), ptr(level_image.data)); opengl_check;
+			glTexImage2D(GL_TEXTURE_2D, level, texture.format, level_image.width, level_image.height, 0, gl_format, GL_UNSIGNED_BYTE, reinterpret_cast<void const*>(offset)); opengl_check;
+			offset += level_image.data.size();
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level_count - 1); opengl_check;
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0); opengl_check;
+		opengl_state().bind_texture(GL_TEXTURE_2D, 0);
+
+		counters.textures_uploaded++;
+		counters.bytes_uploaded += size;
+
+		job.levels.clear();
+		job.status = detail::texture_load_ready;
+	}
+
+	void opengl_texture_loader_structure::upload_job_compressed(detail::texture_load_job& job)
+	{
+		image_compressed_structure const& im = job.image_compressed;
+		opengl_texture_image_structure& texture = job.texture;
+		texture.width = im.width;
+		texture.height = im.height;
+		texture.format = opengl_compressed_format(im.format);
+
+		if (job.is_streamed) {
+			opengl_texture_residency().add(texture, std::move(job.image_compressed));
+			counters.textures_uploaded++;
+			counters.bytes_uploaded += opengl_texture_residency().resident_bytes(texture);
+			job.image_compressed = image_compressed_structure();
+			job.status = detail::texture_load_ready;
+			return;
+		}
+
+		// All the levels are copied in the pixel buffer, then sent one by one from their offset (no glGenerateMipmap)
+		int const level_count = job.is_mipmap ? im.level_count() : 1;
+		size_t size = 0;
+		for (int level = 0; level < level_count; ++level)
+			size += im.levels[level].size();
+
+		if (pbo == 0) {
+			glGenBuffers(1, &pbo); opengl_check;
+		}
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo); opengl_check;
+		glBufferData(GL_PIXEL_UNPACK_BUFFER, GLsizeiptr(size), NULL, GL_STREAM_DRAW); opengl_check;
+
+		opengl_state().bind_texture(GL_TEXTURE_2D, texture.id);
+		size_t offset = 0;
+		for (int level = 0; level < level_count; ++level) {
+			GLsizei const level_size = GLsizei(im.levels[level].size());
+			glBufferSubData(GL_PIXEL_UNPACK_BUFFER, GLintptr(offset), level_size, ptr(im.levels[level])); opengl_check;
+			glCompressedTexImage2D(GL_TEXTURE_2D, level, texture.format, im.level_width(level), im.level_height(level), 0, level_size, reinterpret_cast<void const*>(offset)); opengl_check;
+			offset += size_t(level_size);
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level_count - 1); opengl_check;
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0); opengl_check;
+		opengl_state().bind_texture(GL_TEXTURE_2D, 0);
+
+		counters.textures_uploaded++;
+		counters.bytes_uploaded += size;
+
+		job.image_compressed = image_compressed_structure();
+		job.status = detail::texture_load_ready;
+	}
+
+	void opengl_texture_loader_structure::finish()
+	{
+		while (pending_count() > 0)
+		{
+			upload(std::numeric_limits<float>::max());
+
+			std::unique_lock<std::mutex> lock(jobs_mutex);
+			decoded_condition.wait(lock, [this] { return !decoded.empty() || pending == 0 || workers.empty(); });
+		}
+	}
+
+	void opengl_texture_loader_structure::discard(opengl_texture_load_handle const& handle)
+	{
+		if (handle.job != nullptr)
+			handle.job->discarded = true;
+	}
+
+	int opengl_texture_loader_structure::pending_count() const
+	{
+		std::lock_guard<std::mutex> lock(jobs_mutex);
+		return pending;
+	}
+
+	void opengl_texture_loader_structure::end_frame()
+	{
+		counters_previous = counters;
+		counters = counters_structure();
+	}
+
+	void opengl_texture_loader_structure::start_workers()
+	{
+#ifndef __EMSCRIPTEN__
+		int count = thread_count;
+		if (count <= 0)
+			count = std::max(1, int(std::thread::hardware_concurrency()) - 1);
+		workers_stop = false;
+		for (int k = 0; k < count; ++k)
+			workers.push_back(std::thread(&opengl_texture_loader_structure::worker_loop, this));
+#endif
+	}
+
+	void opengl_texture_loader_structure::worker_loop()
+	{
+#ifdef _OPENMP
+		// The decoders already run in parallel: the OpenMP loops of the mipmaps and of the compression stay serial in each worker
+		omp_set_num_threads(1);
+#endif
+
+		while (true)
+		{
+			std::shared_ptr<detail::texture_load_job> job;
+			{
+				std::unique_lock<std::mutex> lock(jobs_mutex);
+				jobs_condition.wait(lock, [this] { return workers_stop || !jobs.empty(); });
+				if (workers_stop)
+					return;
+				job = jobs.front();
+				jobs.pop_front();
+			}
+
+			if (!job->discarded)
+				detail::decode(*job);
+
+			{
+				std::lock_guard<std::mutex> lock(jobs_mutex);
+				decoded.push_back(job);
+			}
+			decoded_condition.notify_all();
+		}
+	}
+
+	void opengl_texture_loader_structure::stop_workers()
+	{
+		join_workers();
+
+		if (pbo != 0) {
+			glDeleteBuffers(1, &pbo); opengl_check;
+			pbo = 0;
+		}
+	}
+
+	void opengl_texture_loader_structure::join_workers()
+	{
+		{
+			std::lock_guard<std::mutex> lock(jobs_mutex);
+			workers_stop = true;
+			pending -= int(jobs.size());
+			jobs.clear();
+		}
+		jobs_condition.notify_all();
+		for (std::thread& worker : workers)
+			worker.join();
+		workers.clear();
+	}
+
+	opengl_texture_loader_structure::~opengl_texture_loader_structure()
+	{
+		join_workers();
+	}
+
+	opengl_texture_loader_structure& opengl_texture_loader()
+	{
+		static opengl_texture_loader_structure loader;
+		return loader;
+	}
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "cgp/opengl_include.hpp"
+#include "../texture/texture.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cgp
+{
+	namespace detail { struct texture_load_job; }
+
+	// Handle on a texture requested to opengl_texture_loader_structure
+	struct opengl_texture_load_handle
+	{
+		// Texture usable immediately (the OpenGL id is final): its content is a 1x1 placeholder until the image is uploaded
+		//  Only this structure gets the width, height and format of the image at the upload. The copies (in mesh_drawable, etc.)
+		//  draw the image as they share the id, but keep the 1x1 placeholder metadata: read the size and format here.
+		opengl_texture_image_structure const& texture() const;
+
+		bool is_ready() const;   // The image is on the GPU
+		bool has_failed() const; // The image couldn't be decoded (the placeholder stays)
+
+		std::shared_ptr<detail::texture_load_job> job;
+	};
+
+	/** Asynchronous loading of 2D textures from image files (.png, .jpg)
+	 * load_texture_2d() creates the texture with a placeholder content and returns immediately. The file is decoded
+	 * on a pool of worker threads, with its mipmap levels (no glGenerateMipmap on the render thread), and the decoded images
+	 * are sent to the GPU through a pixel buffer object by upload(), called once per frame on the render thread: the uploads
+	 * stop once upload_budget_ms is spent.
+	 * The worker threads are started at the first request. */
+	struct opengl_texture_loader_structure
+	{
+		struct counters_structure
+		{
+			size_t textures_uploaded = 0; // Images sent to the GPU
+			size_t bytes_uploaded = 0;    // Size of the data sent (all the levels, or the coarse levels of the streamed textures)
+			double upload_time_ms = 0;    // Time spent in upload() on the render thread
+		};
+
+		// Counters since the last call to end_frame(), and counters of the previous frame
+		counters_structure counters;
+		counters_structure counters_previous;
+
+		float upload_budget_ms = 2.0f;  // Time allowed per frame for the uploads (at least one image is sent per call)
+		int thread_count = -1;          // Number of decoding threads (<=0: number of hardware threads - 1), read at the first request
+		unsigned char placeholder_color[4] = { 160, 160, 160, 255 };
+
+		// Load the files as compressed textures (bc1/bc3) with their mipmap levels, see image_load_file_compressed
+		//  Only applied if the GPU supports the S3TC formats (uncompressed GL_RGB8/GL_RGBA8 textures otherwise)
+		bool use_compression = false;
+
+		// Filter of the mipmap levels computed by the decoding threads (uncompressed textures)
+		image_mipmap_filter mipmap_filter = image_mipmap_filter::box;
+
+		// The mipmap levels are given to opengl_texture_residency(): only the coarse levels are sent at the upload,
+		//  the finer ones when the textured objects get closer to the camera (see opengl_texture_residency_structure)
+		bool stream_mipmaps = false;
+
+		// Request the loading of an image file as a GL_TEXTURE_2D (render thread)
+		opengl_texture_load_handle load_texture_2d(std::string const& filename, GLint wrap_s = GL_CLAMP_TO_EDGE, GLint wrap_t = GL_CLAMP_TO_EDGE, bool is_mipmap = true, GLint texture_mag_filter = GL_LINEAR, GLint texture_min_filter = GL_LINEAR_MIPMAP_LINEAR);
+
+		// Send the decoded images to the GPU within the time budget - returns the number of uploaded images (render thread)
+		int upload(float budget_ms);
+		int upload() { return upload(upload_budget_ms); }
+
+		// Block until all the requested textures are uploaded (render thread)
+		void finish();
+
+		// Drop the upload of a requested texture (to be called before deleting its OpenGL texture)
+		void discard(opengl_texture_load_handle const& handle);
+
+		// Number of requested textures not uploaded yet
+		int pending_count() const;
+
+		// Store the counters of the frame in counters_previous, and restart them
+		void end_frame();
+
+		// Stop and join the worker threads (the remaining requests are dropped), and release the pixel buffer
+		//  To be called by the render thread before the destruction of the OpenGL context (ex. at the end of the program).
+		//  The destructor only joins the threads: it may run after the destruction of the context.
+		void stop_workers();
+		~opengl_texture_loader_structure();
+
+	private:
+		std::vector<std::thread> workers;
+		bool workers_stop = false;
+
+		mutable std::mutex jobs_mutex;
+		std::condition_variable jobs_condition;     // new request, or stop
+		std::condition_variable decoded_condition;  // a request is decoded
+		std::deque<std::shared_ptr<detail::texture_load_job> > jobs;    // waiting for decoding
+		std::deque<std::shared_ptr<detail::texture_load_job> > decoded; // waiting for the upload
+		int pending = 0;
+
+		GLuint pbo = 0; // pixel buffer used for the uploads
+
+		void start_workers();
+		void join_workers();
+		void worker_loop();
+		void upload_job(detail::texture_load_job& job);
+		void upload_job_compressed(detail::texture_load_job& job);
+	};
+
+	// Texture loader of the render thread
+	opengl_texture_loader_structure& opengl_texture_loader();
+}
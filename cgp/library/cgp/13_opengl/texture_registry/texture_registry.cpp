@@ -0,0 +1,135 @@
+#include "texture_registry.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "../debug/debug.hpp"
+#include "../state/opengl_state.hpp"
+#include "../texture_residency/texture_residency.hpp"
+
+#include <algorithm>
+
+namespace cgp
+{
+	static std::string texture_key(std::string const& filename, GLint wrap_s, GLint wrap_t, bool is_mipmap, GLint texture_mag_filter, GLint texture_min_filter)
+	{
+		return filename + "|" + str(wrap_s) + "," + str(wrap_t) + "," + str(int(is_mipmap)) + "," + str(texture_mag_filter) + "," + str(texture_min_filter);
+	}
+
+	// Size of a level: blocks of 4x4 pixels for the compressed formats
+	static size_t texture_level_bytes(GLint format, int w, int h)
+	{
+		if (format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT)
+			return size_t((w + 3) / 4) * size_t((h + 3) / 4) * 8;
+		if (format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)
+			return size_t((w + 3) / 4) * size_t((h + 3) / 4) * 16;
+		return size_t(w) * size_t(h) * (format == GL_RGBA8 ? 4 : 3);
+	}
+
+	static size_t texture_bytes(opengl_texture_image_structure const& texture, bool is_mipmap)
+	{
+		size_t bytes = 0;
+		int w = texture.width;
+		int h = texture.height;
+		while (true) {
+			bytes += texture_level_bytes(texture.format, w, h);
+			if (!is_mipmap || (w == 1 && h == 1))
+				break;
+			w = std::max(1, w / 2);
+			h = std::max(1, h / 2);
+		}
+		return bytes;
+	}
+
+	opengl_texture_image_structure opengl_texture_registry_structure::acquire(std::string const& filename, GLint wrap_s, GLint wrap_t, bool is_mipmap, GLint texture_mag_filter, GLint texture_min_filter)
+	{
+		std::string const key = texture_key(filename, wrap_s, wrap_t, is_mipmap, texture_mag_filter, texture_min_filter);
+
+		auto it = entries.find(key);
+		if (it == entries.end()) {
+			entry_structure entry;
+			entry.handle = opengl_texture_loader().load_texture_2d(filename, wrap_s, wrap_t, is_mipmap, texture_mag_filter, texture_min_filter);
+			entry.is_mipmap = is_mipmap;
+			entry.references = 0;
+			it = entries.insert(std::make_pair(key, entry)).first;
+			key_of_texture[entry.handle.texture().id] = key;
+		}
+
+		it->second.references++;
+		return it->second.handle.texture();
+	}
+
+	void opengl_texture_registry_structure::release(opengl_texture_image_structure const& texture)
+	{
+		auto it_key = key_of_texture.find(texture.id);
+		if (it_key == key_of_texture.end()) {
+			warning_cgp("Release of a texture that isn't in the registry", "id=" + str(texture.id));
+			return;
+		}
+
+		auto it = entries.find(it_key->second);
+		assert_cgp_no_msg(it != entries.end());
+		it->second.references--;
+		if (it->second.references > 0)
+			return;
+
+		delete_texture(it->second);
+		entries.erase(it);
+		key_of_texture.erase(it_key);
+	}
+
+	opengl_texture_image_structure const& opengl_texture_registry_structure::texture(opengl_texture_image_structure const& copy) const
+	{
+		auto it_key = key_of_texture.find(copy.id);
+		assert_cgp(it_key != key_of_texture.end(), "Texture not in the registry (id=" + str(copy.id) + ")");
+		return entries.at(it_key->second).handle.texture();
+	}
+
+	int opengl_texture_registry_structure::reference_count(opengl_texture_image_structure const& texture) const
+	{
+		auto it_key = key_of_texture.find(texture.id);
+		if (it_key == key_of_texture.end())
+			return 0;
+		return entries.at(it_key->second).references;
+	}
+
+	int opengl_texture_registry_structure::size() const
+	{
+		return int(entries.size());
+	}
+
+	size_t opengl_texture_registry_structure::resident_bytes() const
+	{
+		size_t bytes = 0;
+		for (auto const& it : entries) {
+			opengl_texture_image_structure const& texture = it.second.handle.texture();
+			if (opengl_texture_residency().contains(texture))
+				bytes += opengl_texture_residency().resident_bytes(texture); // streamed mipmap levels
+			else
+				bytes += texture_bytes(texture, it.second.is_mipmap && it.second.handle.is_ready());
+		}
+		return bytes;
+	}
+
+	void opengl_texture_registry_structure::clear()
+	{
+		for (auto& it : entries)
+			delete_texture(it.second);
+		entries.clear();
+		key_of_texture.clear();
+	}
+
+	void opengl_texture_registry_structure::delete_texture(entry_structure& entry)
+	{
+		opengl_texture_loader().discard(entry.handle);
+		opengl_texture_residency().remove(entry.handle.texture());
+
+		GLuint const id = entry.handle.texture().id;
+		glDeleteTextures(1, &id); opengl_check;
+		opengl_state().forget_texture(id);
+	}
+
+	opengl_texture_registry_structure& opengl_texture_registry()
+	{
+		static opengl_texture_registry_structure registry;
+		return registry;
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "cgp/opengl_include.hpp"
+#include "../texture/texture.hpp"
+#include "../texture_loader/texture_loader.hpp"
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+namespace cgp
+{
+	/** Reference-counted textures shared between their users, keyed by the image file and the sampler parameters
+	 * The first acquire() of a (file, parameters) pair loads the texture through opengl_texture_loader(), the next ones
+	 * return the same OpenGL texture. Each acquire() must be balanced by a release(): the texture is deleted with its last reference.
+	 * The returned structures are plain copies (same id): they must not be cleared directly. Their width, height and format
+	 * are the ones of the 1x1 placeholder of the loader - texture() gives the structure updated at the upload. */
+	struct opengl_texture_registry_structure
+	{
+		// Shared texture of the image file with these sampler parameters (adds a reference)
+		opengl_texture_image_structure acquire(std::string const& filename, GLint wrap_s = GL_CLAMP_TO_EDGE, GLint wrap_t = GL_CLAMP_TO_EDGE, bool is_mipmap = true, GLint texture_mag_filter = GL_LINEAR, GLint texture_min_filter = GL_LINEAR_MIPMAP_LINEAR);
+
+		// Remove a reference on a texture given by acquire() - the texture is deleted when it was the last one
+		void release(opengl_texture_image_structure const& texture);
+
+		// Texture of the registry with the same id, with the width, height and format of the image once it is uploaded
+		opengl_texture_image_structure const& texture(opengl_texture_image_structure const& copy) const;
+
+		// Number of references on a texture (0 if it isn't in the registry)
+		int reference_count(opengl_texture_image_structure const& texture) const;
+
+		// Number of textures in the registry
+		int size() const;
+
+		// GPU memory used by the uploaded textures of the registry (mipmap levels included)
+		size_t resident_bytes() const;
+
+		// Delete all the textures of the registry, whatever their references
+		void clear();
+
+	private:
+		struct entry_structure
+		{
+			opengl_texture_load_handle handle;
+			bool is_mipmap;
+			int references;
+		};
+		std::map<std::string, entry_structure> entries; // key: filename and sampler parameters
+		std::map<GLuint, std::string> key_of_texture;   // texture id -> key in entries
+
+		void delete_texture(entry_structure& entry);
+	};
+
+	// Texture registry of the render thread
+	opengl_texture_registry_structure& opengl_texture_registry();
+}
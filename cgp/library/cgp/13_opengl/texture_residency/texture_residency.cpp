@@ -0,0 +1,285 @@
+#include "texture_residency.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "../debug/debug.hpp"
+#include "../state/opengl_state.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace cgp
+{
+	void opengl_texture_residency_structure::add(opengl_texture_image_structure const& texture, std::vector<image_structure> levels)
+	{
+		assert_cgp(levels.size() > 0, "Empty mipmap levels");
+
+		entry_structure entry;
+		entry.texture = texture;
+		entry.texture.width = levels[0].width;
+		entry.texture.height = levels[0].height;
+		entry.texture.format = (levels[0].color_type == image_color_type::rgba ? GL_RGBA8 : GL_RGB8);
+		entry.is_compressed = false;
+		entry.level_count = int(levels.size());
+		entry.levels = std::move(levels);
+		add_entry(entry);
+	}
+
+	void opengl_texture_residency_structure::add(opengl_texture_image_structure const& texture, image_compressed_structure levels)
+	{
+		assert_cgp(levels.level_count() > 0, "Empty compressed image");
+
+		if (!opengl_texture_compression_available()) {
+			std::vector<image_structure> decompressed;
+			for (int level = 0; level < levels.level_count(); ++level)
+				decompressed.push_back(image_decompress(levels, level));
+			add(texture, std::move(decompressed));
+			return;
+		}
+
+		entry_structure entry;
+		entry.texture = texture;
+		entry.texture.width = levels.width;
+		entry.texture.height = levels.height;
+		entry.texture.format = opengl_compressed_format(levels.format);
+		entry.is_compressed = true;
+		entry.level_count = levels.level_count();
+		entry.compressed = std::move(levels);
+		add_entry(entry);
+	}
+
+	void opengl_texture_residency_structure::add_entry(entry_structure& entry)
+	{
+		// The coarse levels: from the first one that fits in resident_size
+		int coarse_level = 0;
+		int w = entry.texture.width;
+		int h = entry.texture.height;
+		while (std::max(w, h) > resident_size && coarse_level < entry.level_count - 1) {
+			w = std::max(1, w / 2);
+			h = std::max(1, h / 2);
+			coarse_level++;
+		}
+		entry.coarse_level = coarse_level;
+		entry.resident_level = coarse_level;
+		entry.requested_level = float(entry.level_count);
+		entry.distance = std::numeric_limits<float>::max();
+
+		for (int level = entry.level_count - 1; level >= coarse_level; --level)
+			upload_level(entry, level);
+		opengl_state().bind_texture(GL_TEXTURE_2D, entry.texture.id);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, coarse_level); opengl_check;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, entry.level_count - 1); opengl_check;
+		opengl_state().bind_texture(GL_TEXTURE_2D, 0);
+
+		// The content given at the creation of the texture (ex. placeholder) is released
+		if (coarse_level > 0)
+			evict_levels(entry, 0, 1);
+
+		GLuint const id = entry.texture.id;
+		entries[id] = std::move(entry);
+	}
+
+	void opengl_texture_residency_structure::remove(opengl_texture_image_structure const& texture)
+	{
+		entries.erase(texture.id);
+	}
+
+	bool opengl_texture_residency_structure::contains(opengl_texture_image_structure const& texture) const
+	{
+		return entries.find(texture.id) != entries.end();
+	}
+
+	void opengl_texture_residency_structure::set_view(vec3 const& camera_position_arg, mat4 const& projection, int viewport_height)
+	{
+		camera_position = camera_position_arg;
+		// A perspective projection scales the y coordinates by 1/tan(fov/2) into [-1,1]
+		pixels_per_unit = projection(1, 1) * viewport_height / 2.0f;
+	}
+
+	void opengl_texture_residency_structure::request(opengl_texture_image_structure const& texture, vec3 const& center, float radius, float uv_density)
+	{
+		auto it = entries.find(texture.id);
+		if (it == entries.end())
+			return;
+		entry_structure& entry = it->second;
+
+		// Nearest point of the bounding sphere
+		float const distance = std::max(norm(center - camera_position) - radius, 0.01f);
+
+		// Level where a texel covers a pixel: 2^level texels of the level 0 per pixel (level 0 if the uv density is unknown)
+		float level = 0.0f;
+		if (uv_density > 0) {
+			float const texels_per_unit = uv_density * float(std::max(entry.texture.width, entry.texture.height));
+			float const pixels = pixels_per_unit / distance;
+			level = std::log2(texels_per_unit / pixels) + lod_bias;
+		}
+
+		entry.requested_level = std::min(entry.requested_level, level);
+		entry.distance = std::min(entry.distance, distance);
+	}
+
+	void opengl_texture_residency_structure::update()
+	{
+		typedef std::chrono::steady_clock clock;
+		clock::time_point const start = clock::now();
+
+		// Target levels from the requests
+		std::map<GLuint, int> target;
+		size_t total_bytes = 0;
+		for (auto& it : entries) {
+			entry_structure& entry = it.second;
+			int level = entry.coarse_level;
+			if (entry.requested_level < entry.level_count) {
+				level = std::min(entry.coarse_level, std::max(0, int(std::floor(entry.requested_level))));
+				// A finer resident level is kept until the request is half a level coarser (no eviction/upload at each frame around a level change)
+				if (entry.resident_level < level && entry.requested_level < entry.resident_level + 1.5f)
+					level = entry.resident_level;
+			}
+			target[it.first] = level;
+			total_bytes += bytes_from_level(entry, level);
+		}
+
+		// Over the budget: the farthest textures lose their finest level first
+		while (total_bytes > budget_bytes) {
+			entry_structure* farthest = nullptr;
+			for (auto& it : entries) {
+				if (target[it.first] < it.second.coarse_level && (farthest == nullptr || it.second.distance > farthest->distance))
+					farthest = &it.second;
+			}
+			if (farthest == nullptr)
+				break;
+			int& level = target[farthest->texture.id];
+			total_bytes -= level_bytes(*farthest, level);
+			level++;
+		}
+
+		// Eviction of the levels finer than the target
+		for (auto& it : entries) {
+			entry_structure& entry = it.second;
+			int const level = target[it.first];
+			if (entry.resident_level < level) {
+				opengl_state().bind_texture(GL_TEXTURE_2D, entry.texture.id);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level); opengl_check;
+				opengl_state().bind_texture(GL_TEXTURE_2D, 0);
+				evict_levels(entry, entry.resident_level, level);
+				counters.levels_evicted += size_t(level - entry.resident_level);
+				entry.resident_level = level;
+			}
+		}
+
+		// Uploads of the finer levels: nearest textures first, one level at a time (coarse to fine)
+		std::vector<entry_structure*> uploads;
+		for (auto& it : entries)
+			if (target[it.first] < it.second.resident_level)
+				uploads.push_back(&it.second);
+		std::sort(uploads.begin(), uploads.end(), [](entry_structure const* a, entry_structure const* b) { return a->distance < b->distance; });
+
+		bool is_budget_spent = false;
+		for (size_t k = 0; k < uploads.size() && !is_budget_spent; ++k) {
+			entry_structure& entry = *uploads[k];
+			while (entry.resident_level > target[entry.texture.id] && !is_budget_spent) {
+				int const level = entry.resident_level - 1;
+				upload_level(entry, level);
+				opengl_state().bind_texture(GL_TEXTURE_2D, entry.texture.id);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, level); opengl_check;
+				opengl_state().bind_texture(GL_TEXTURE_2D, 0);
+				entry.resident_level = level;
+				counters.levels_uploaded++;
+				counters.bytes_uploaded += level_bytes(entry, level);
+
+				double const elapsed_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+				is_budget_spent = (elapsed_ms >= upload_budget_ms);
+			}
+		}
+
+		// The requests are gathered again for the next update
+		for (auto& it : entries) {
+			it.second.requested_level = float(it.second.level_count);
+			it.second.distance = std::numeric_limits<float>::max();
+		}
+
+		counters.upload_time_ms += std::chrono::duration<double, std::milli>(clock::now() - start).count();
+	}
+
+	int opengl_texture_residency_structure::resident_level(opengl_texture_image_structure const& texture) const
+	{
+		auto it = entries.find(texture.id);
+		return it == entries.end() ? -1 : it->second.resident_level;
+	}
+
+	size_t opengl_texture_residency_structure::resident_bytes() const
+	{
+		size_t bytes = 0;
+		for (auto const& it : entries)
+			bytes += bytes_from_level(it.second, it.second.resident_level);
+		return bytes;
+	}
+
+	size_t opengl_texture_residency_structure::resident_bytes(opengl_texture_image_structure const& texture) const
+	{
+		auto it = entries.find(texture.id);
+		return it == entries.end() ? 0 : bytes_from_level(it->second, it->second.resident_level);
+	}
+
+	int opengl_texture_residency_structure::size() const
+	{
+		return int(entries.size());
+	}
+
+	void opengl_texture_residency_structure::end_frame()
+	{
+		counters_previous = counters;
+		counters = counters_structure();
+	}
+
+	void opengl_texture_residency_structure::clear()
+	{
+		entries.clear();
+	}
+
+	size_t opengl_texture_residency_structure::level_bytes(entry_structure const& entry, int level)
+	{
+		return entry.is_compressed ? entry.compressed.levels[level].size() : entry.levels[level].data.size();
+	}
+
+	size_t opengl_texture_residency_structure::bytes_from_level(entry_structure const& entry, int level)
+	{
+		size_t bytes = 0;
+		for (int k = level; k < entry.level_count; ++k)
+			bytes += level_bytes(entry, k);
+		return bytes;
+	}
+
+	void opengl_texture_residency_structure::upload_level(entry_structure& entry, int level)
+	{
+		opengl_state().bind_texture(GL_TEXTURE_2D, entry.texture.id);
+		if (entry.is_compressed) {
+			numarray<unsigned char> const& blocks = entry.compressed.levels[level];
+			glCompressedTexImage2D(GL_TEXTURE_2D, level, entry.texture.format, entry.compressed.level_width(level), entry.compressed.level_height(level), 0, GLsizei(blocks.size()), ptr(blocks)); opengl_check;
+		}
+		else {
+			image_structure const& im = entry.levels[level];
+			GLenum const gl_format = (im.color_type == image_color_type::rgba ? GL_RGBA : GL_RGB);
+			glTexImage2D(GL_TEXTURE_2D, level, entry.texture.format, im.width, im.height, 0, gl_format, GL_UNSIGNED_BYTE, ptr(im.data)); opengl_check;
+		}
+		opengl_state().bind_texture(GL_TEXTURE_2D, 0);
+	}
+
+	// Release the storage of the levels [level_begin, level_end[ - they are below GL_TEXTURE_BASE_LEVEL and never sampled
+	void opengl_texture_residency_structure::evict_levels(entry_structure& entry, int level_begin, int level_end)
+	{
+		opengl_state().bind_texture(GL_TEXTURE_2D, entry.texture.id);
+		for (int level = level_begin; level < level_end; ++level) {
+			glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr); opengl_check;
+		}
+		opengl_state().bind_texture(GL_TEXTURE_2D, 0);
+	}
+
+	opengl_texture_residency_structure& opengl_texture_residency()
+	{
+		static opengl_texture_residency_structure residency;
+		return residency;
+	}
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "cgp/opengl_include.hpp"
+#include "../texture/texture.hpp"
+
+#include "cgp/05_vec/vec.hpp"
+#include "cgp/06_mat/mat.hpp"
+
+#include <cstddef>
+#include <map>
+#include <vector>
+
+namespace cgp
+{
+	/** Streaming of the mipmap levels of 2D textures by distance to the camera, within a GPU memory budget
+	 * add() keeps the levels of a texture on the CPU and sends only the coarse ones (largest side <= resident_size). The finer
+	 * levels are sent when the objects using the texture get closer to the camera, and removed from the GPU when they are not
+	 * requested anymore. The texture keeps its OpenGL id: GL_TEXTURE_BASE_LEVEL is set to the finest resident level.
+	 * The finest levels requested by the nearest objects are kept first when the budget is exceeded.
+	 * At each frame (render thread):
+	 *   residency.set_view(camera_position, projection_matrix, viewport_height);
+	 *   residency.request(texture, center, radius, uv_density); // each textured object (see request_texture_residency for a mesh_drawable)
+	 *   residency.update(); // evict and upload the levels, from the requests since the last update */
+	struct opengl_texture_residency_structure
+	{
+		struct counters_structure
+		{
+			size_t levels_uploaded = 0; // Finer levels sent to the GPU
+			size_t levels_evicted = 0;  // Levels removed from the GPU
+			size_t bytes_uploaded = 0;  // Size of the levels sent
+			double upload_time_ms = 0;  // Time spent in update() on the render thread
+		};
+
+		// Counters since the last call to end_frame(), and counters of the previous frame
+		counters_structure counters;
+		counters_structure counters_previous;
+
+		size_t budget_bytes = size_t(64) * 1024 * 1024; // GPU memory allowed for the streamed textures (the coarse levels are always resident)
+		float upload_budget_ms = 1.0f; // Time allowed per frame for the uploads (at least one level is sent per update)
+		int resident_size = 128;       // The levels up to this size (largest side) are always resident
+		float lod_bias = 0.0f;         // Added to the requested level: >0 for coarser levels
+
+		// Take over the mipmap levels of a texture (level 0 first, down to 1x1) and send its coarse levels
+		//  The compressed levels are decompressed if the GPU doesn't support the S3TC formats.
+		void add(opengl_texture_image_structure const& texture, std::vector<image_structure> levels);
+		void add(opengl_texture_image_structure const& texture, image_compressed_structure levels);
+
+		// Stop the streaming of a texture (to be called before deleting it) - its resident levels stay on the GPU
+		void remove(opengl_texture_image_structure const& texture);
+		bool contains(opengl_texture_image_structure const& texture) const;
+
+		// Camera of the frame: the level needed by an object depends on its size in pixels on the screen
+		void set_view(vec3 const& camera_position, mat4 const& projection, int viewport_height);
+
+		/** Request the level of a texture needed to draw an object of bounding sphere (center, radius)
+		 * uv_density: texture coordinates per unit of length on the object (ex. 0.1 for a uv in [0,1] along 10 units)
+		 * The finest level requested since the last update is kept.
+		 * Only the id of the texture is used (the size comes from add()): a copy with the placeholder size of the loader is valid. */
+		void request(opengl_texture_image_structure const& texture, vec3 const& center, float radius, float uv_density);
+
+		// Send/remove the levels from the requests (render thread, once per frame): a texture without request keeps only its coarse levels
+		void update();
+
+		// Finest level of a texture on the GPU (-1 if the texture isn't streamed)
+		int resident_level(opengl_texture_image_structure const& texture) const;
+
+		// GPU memory used by the resident levels of all the streamed textures, or of one texture (0 if it isn't streamed)
+		size_t resident_bytes() const;
+		size_t resident_bytes(opengl_texture_image_structure const& texture) const;
+
+		// Number of streamed textures
+		int size() const;
+
+		// Store the counters of the frame in counters_previous, and restart them
+		void end_frame();
+
+		// Stop the streaming of all the textures
+		void clear();
+
+	private:
+		struct entry_structure
+		{
+			opengl_texture_image_structure texture;
+			std::vector<image_structure> levels;    // uncompressed levels
+			image_compressed_structure compressed;  // levels used instead if is_compressed
+			bool is_compressed;
+
+			int level_count;
+			int coarse_level;   // finest of the levels always resident
+			int resident_level; // finest level on the GPU
+			float requested_level; // finest level requested since the last update (level_count if none)
+			float distance;     // distance of the nearest request since the last update
+		};
+		std::map<GLuint, entry_structure> entries; // key: texture id
+
+		vec3 camera_position;
+		float pixels_per_unit = 1.0f; // size in pixels of a unit of length at distance 1 from the camera
+
+		void add_entry(entry_structure& entry);
+		static size_t level_bytes(entry_structure const& entry, int level);
+		static size_t bytes_from_level(entry_structure const& entry, int level);
+		void upload_level(entry_structure& entry, int level);
+		void evict_levels(entry_structure& entry, int level_begin, int level_end);
+	};
+
+	// Texture residency manager of the render thread
+	opengl_texture_residency_structure& opengl_texture_residency();
+}
@@ -30,6 +30,8 @@ namespace cgp
 
 
 
+	// Send a uniform variable designated by its name
+	//  For the uniforms sent at each draw call, prefer the version using an opengl_uniform_handle (no string lookup)
 	void opengl_uniform(opengl_shader_structure const& shader, std::string const& name, int value, bool expected = true);
 	void opengl_uniform(opengl_shader_structure const& shader, std::string const& name, GLuint value, bool expected = true);
 	void opengl_uniform(opengl_shader_structure const& shader, std::string const& name, float value, bool expected = true);
@@ -46,5 +48,22 @@ namespace cgp
 	void opengl_uniform(opengl_shader_structure const& shader, std::string const& name, mat3 const& m, bool expected = true);
 	void opengl_uniform(opengl_shader_structure const& shader, std::string const& name, mat2 const& m, bool expected = true);
 
+	// Send a uniform variable designated by a handle (see opengl_uniform_handle)
+	void opengl_uniform(opengl_shader_structure const& shader, opengl_uniform_handle const& uniform, int value, bool expected = true);
+	void opengl_uniform(opengl_shader_structure const& shader, opengl_uniform_handle const& uniform, GLuint value, bool expected = true);
+	void opengl_uniform(opengl_shader_structure const& shader, opengl_uniform_handle const& uniform, float value, bool expected = true);
+
+	void opengl_uniform(opengl_shader_structure const& shader, opengl_uniform_handle const& uniform, vec2 const& value, bool expected = true);
+	void opengl_uniform(opengl_shader_structure const& shader, opengl_uniform_handle const& uniform, vec3 const& value, bool expected = true);
+	void opengl_uniform(opengl_shader_structure const& shader, opengl_uniform_handle const& uniform, vec4 const& value, bool expected = true);
+
+	void opengl_uniform(opengl_shader_structure const& shader, opengl_uniform_handle const& uniform, float x, float y, bool expected = true);
+	void opengl_uniform(opengl_shader_structure const& shader, opengl_uniform_handle const& uniform, float x, float y, float z, bool expected = true);
+	void opengl_uniform(opengl_shader_structure const& shader, opengl_uniform_handle const& uniform, float x, float y, float z, float w, bool expected = true);
+
+	void opengl_uniform(opengl_shader_structure const& shader, opengl_uniform_handle const& uniform, mat4 const& m, bool expected = true);
+	void opengl_uniform(opengl_shader_structure const& shader, opengl_uniform_handle const& uniform, mat3 const& m, bool expected = true);
+	void opengl_uniform(opengl_shader_structure const& shader, opengl_uniform_handle const& uniform, mat2 const& m, bool expected = true);
+
 }
 
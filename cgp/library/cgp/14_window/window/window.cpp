@@ -101,6 +101,9 @@ namespace cgp
             std::cout<<"Failed to Init GLAD"<<std::endl;
             abort();
         }
+
+        // KHR_debug callback used by opengl_check_mode::debug_output (if the driver provides it)
+        opengl_check_load_debug_output([](char const* name) { return reinterpret_cast<void*>(glfwGetProcAddress(name)); });
 #endif
 
 
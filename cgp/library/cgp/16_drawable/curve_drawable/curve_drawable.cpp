@@ -42,9 +42,9 @@ namespace cgp
 
 		// Generate VAO
 		glGenVertexArrays(1, &vao); opengl_check;
-		glBindVertexArray(vao); opengl_check;
+		opengl_state().bind_vertex_array(vao);
 		opengl_set_vao_location(vbo_position, 0);
-		glBindVertexArray(0);
+		opengl_state().bind_vertex_array(0);
 
 	}
 
@@ -54,6 +54,7 @@ namespace cgp
 		vbo_position.clear(); opengl_check;
 
 		glDeleteVertexArrays(1, &vao); opengl_check;
+		opengl_state().forget_vertex_array(vao);
 		vao = 0;
 		shader.id = 0;
 		model = affine();
@@ -62,8 +63,10 @@ namespace cgp
 
 	void curve_drawable::send_opengl_uniform(bool expected) const
 	{
-		opengl_uniform(shader, "color", color, expected);
-		opengl_uniform(shader, "model", model.matrix(), expected);
+		static opengl_uniform_handle const uniform_color("color");
+		static opengl_uniform_handle const uniform_model("model");
+		opengl_uniform(shader, uniform_color, color, expected);
+		opengl_uniform(shader, uniform_model, model.matrix(), expected);
 	}
 
 
@@ -79,7 +82,7 @@ namespace cgp
 		// Set the current shader
 		// ********************************** //
 		assert_cgp(drawable.shader.id != 0, "Try to draw curve_drawable without shader");
-		glUseProgram(drawable.shader.id); opengl_check;
+		opengl_state().use_program(drawable.shader.id);
 
 		// Send uniforms for this shader
 		// ********************************** //
@@ -93,7 +96,7 @@ namespace cgp
 		// Prepare for draw call
 		// ********************************** //
 		int const N_points_display = N_points < 0 ? drawable.vbo_position.size : N_points;
-		glBindVertexArray(drawable.vao); opengl_check;
+		opengl_state().bind_vertex_array(drawable.vao);
 		if (drawable.display_type == curve_drawable_display_type::Curve) {
 			glDrawArrays(GL_LINE_STRIP, 0, N_points_display); opengl_check;
 		}
@@ -101,11 +104,7 @@ namespace cgp
 			glDrawArrays(GL_LINES, 0, N_points_display); opengl_check;
 		}
 
-
-		// Clean buffers
-		glBindVertexArray(0);
-		glUseProgram(0);
-		opengl_check;
+		// The program and VAO stay bound (see opengl_state())
 	}
 
 }
\ No newline at end of file
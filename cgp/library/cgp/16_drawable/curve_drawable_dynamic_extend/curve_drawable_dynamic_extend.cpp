@@ -48,9 +48,9 @@ namespace cgp
 			
 
 			// Update the VAO with the new VBO
-			glBindVertexArray(vao);     opengl_check
+			opengl_state().bind_vertex_array(vao);
 			opengl_set_vao_location(vbo_position, 0);
-			glBindVertexArray(0);       opengl_check
+			opengl_state().bind_vertex_array(0);
 
 		}
 
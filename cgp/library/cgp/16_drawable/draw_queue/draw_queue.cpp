@@ -0,0 +1,60 @@
+#include "draw_queue.hpp"
+
+#include <algorithm>
+
+namespace cgp
+{
+	void draw_queue_structure::push(mesh_drawable const& drawable, int instance_count)
+	{
+		if (drawable.vao == 0 || drawable.ebo_connectivity.size == 0)
+			return;
+
+		mat4 const model = drawable.hierarchy_transform_model.matrix() * drawable.supplementary_model_matrix * drawable.model.matrix();
+		elements.push_back({ &drawable, model, drawable.material, instance_count });
+	}
+
+	void draw_queue_structure::draw(environment_generic_structure const& environment, bool expected_uniforms)
+	{
+		int const N = int(elements.size());
+		order.resize(N);
+		for (int k = 0; k < N; ++k)
+			order[k] = k;
+
+		// Sort by shader, then texture, then VAO (stable: the calls sharing the same state stay in the order of push())
+		std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+			mesh_drawable const& da = *elements[a].drawable;
+			mesh_drawable const& db = *elements[b].drawable;
+			if (da.shader.id != db.shader.id)
+				return da.shader.id < db.shader.id;
+			if (da.texture.id != db.texture.id)
+				return da.texture.id < db.texture.id;
+			return da.vao < db.vao;
+		});
+
+		GLuint previous_shader = 0;
+		uniform_generic_structure const no_additional_uniforms;
+		for (int k = 0; k < N; ++k)
+		{
+			element_structure const& element = elements[order[k]];
+			mesh_drawable const& drawable = *element.drawable;
+
+			// The environment uniforms only need to be sent once per shader
+			bool const new_shader = (k == 0 || drawable.shader.id != previous_shader);
+			previous_shader = drawable.shader.id;
+
+			detail::draw_mesh_drawable(drawable, element.model, element.material, new_shader ? &environment : nullptr, element.instance_count, expected_uniforms, no_additional_uniforms, GL_TRIANGLES);
+		}
+
+		clear();
+	}
+
+	void draw_queue_structure::clear()
+	{
+		elements.clear();
+	}
+
+	int draw_queue_structure::size() const
+	{
+		return int(elements.size());
+	}
+}
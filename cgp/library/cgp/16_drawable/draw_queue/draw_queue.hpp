@@ -0,0 +1,40 @@
+#pragma once
+
+#include "cgp/16_drawable/mesh_drawable/mesh_drawable.hpp"
+
+#include <vector>
+
+namespace cgp
+{
+	/** Queue of opaque draw calls, reordered to minimize the changes of OpenGL state
+	 * The calls are recorded with push() and done by draw(), sorted by shader, then texture, then VAO: consecutive calls
+	 * sharing a state don't rebind it (see opengl_state()), and the environment uniforms are sent once per shader.
+	 * - The model matrix and the material are copied by push(): the mesh_drawable can be modified and pushed again.
+	 * - The mesh_drawable itself (buffers, textures) must remain valid and unchanged until draw().
+	 * - The order of the calls is not preserved: only for opaque elements drawn with depth test.
+	 * Usage:
+	 *   queue.push(terrain);
+	 *   for(...) { rock.model.translation = p; queue.push(rock); }
+	 *   queue.draw(environment); // draw and empty the queue */
+	struct draw_queue_structure
+	{
+		// Record a draw call of the drawable with its current model and material
+		void push(mesh_drawable const& drawable, int instance_count = 1);
+
+		// Do all the recorded draw calls sorted by state, and empty the queue
+		void draw(environment_generic_structure const& environment, bool expected_uniforms = true);
+
+		void clear();
+		int size() const;
+
+	private:
+		struct element_structure {
+			mesh_drawable const* drawable;
+			mat4 model;
+			material_mesh_drawable_phong material;
+			int instance_count;
+		};
+		std::vector<element_structure> elements;
+		std::vector<int> order; // index of the elements sorted by state
+	};
+}
@@ -9,5 +9,11 @@ namespace cgp
 	{
 	}
 
+	void environment_generic_structure::update_uniform_block()
+	{
+		if (uniform_block.id != 0)
+			uniform_block.update();
+	}
+
 
 }
\ No newline at end of file
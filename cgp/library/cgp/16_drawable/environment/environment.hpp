@@ -1,6 +1,7 @@
 #pragma once
 
 #include "cgp/13_opengl/shaders/shaders.hpp"
+#include "cgp/13_opengl/buffer/buffer.hpp"
 
 namespace cgp
 {
@@ -15,6 +16,15 @@ namespace cgp
 
 		// Override in the derived class the function send_opengl_uniform();
 		virtual void send_opengl_uniform(opengl_shader_structure const& shader, bool expected = default_expected_uniform) const;
+
+		// Optional uniform block storing the values constant over a frame (ex. camera, light)
+		//  Declare its members in the derived class before calling uniform_block.initialize_data_on_gpu().
+		//  The shaders declaring the block read the values from it, and send_opengl_uniform() can skip them (see uniform_block.use_in_shader()).
+		opengl_ubo_structure uniform_block;
+
+		// Fill the uniform block and send it to the GPU - to be called once per frame before the draw calls
+		//  The default version sends the block as it is (if it is initialized).
+		virtual void update_uniform_block();
 	};
 
 
@@ -9,17 +9,27 @@ namespace cgp
 {
 	void material_mesh_drawable_phong::send_opengl_uniform(opengl_shader_structure const& shader, bool expected) const
 	{
-		opengl_uniform(shader, "material.color", color, expected);
-		opengl_uniform(shader, "material.alpha", alpha, expected);
+		static opengl_uniform_handle const uniform_color("material.color");
+		static opengl_uniform_handle const uniform_alpha("material.alpha");
+		static opengl_uniform_handle const uniform_ambient("material.phong.ambient");
+		static opengl_uniform_handle const uniform_diffuse("material.phong.diffuse");
+		static opengl_uniform_handle const uniform_specular("material.phong.specular");
+		static opengl_uniform_handle const uniform_specular_exponent("material.phong.specular_exponent");
+		static opengl_uniform_handle const uniform_use_texture("material.texture_settings.use_texture");
+		static opengl_uniform_handle const uniform_texture_inverse_v("material.texture_settings.texture_inverse_v");
+		static opengl_uniform_handle const uniform_two_sided("material.texture_settings.two_sided");
 
-		opengl_uniform(shader, "material.phong.ambient", phong.ambient, expected);
-		opengl_uniform(shader, "material.phong.diffuse", phong.diffuse, expected);
-		opengl_uniform(shader, "material.phong.specular", phong.specular, expected);
-		opengl_uniform(shader, "material.phong.specular_exponent", phong.specular_exponent, expected);
+		opengl_uniform(shader, uniform_color, color, expected);
+		opengl_uniform(shader, uniform_alpha, alpha, expected);
 
-		opengl_uniform(shader, "material.texture_settings.use_texture", texture_settings.active, expected);
-		opengl_uniform(shader, "material.texture_settings.texture_inverse_v", texture_settings.inverse_v, expected);
-		opengl_uniform(shader, "material.texture_settings.two_sided", texture_settings.two_sided, expected);
+		opengl_uniform(shader, uniform_ambient, phong.ambient, expected);
+		opengl_uniform(shader, uniform_diffuse, phong.diffuse, expected);
+		opengl_uniform(shader, uniform_specular, phong.specular, expected);
+		opengl_uniform(shader, uniform_specular_exponent, phong.specular_exponent, expected);
+
+		opengl_uniform(shader, uniform_use_texture, texture_settings.active, expected);
+		opengl_uniform(shader, uniform_texture_inverse_v, texture_settings.inverse_v, expected);
+		opengl_uniform(shader, uniform_two_sided, texture_settings.two_sided, expected);
 	}
 
 }
\ No newline at end of file
@@ -2,6 +2,11 @@
 
 #include "cgp/01_base/base.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
 #if defined(__linux__) || defined(__EMSCRIPTEN__)
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 #endif
@@ -13,6 +18,91 @@ namespace cgp
 
 	static void warning_initialize_non_empty();
 
+	// Interleaved layout: position (12 Bytes), normal (4 Bytes), uv (4 Bytes), [color (12 Bytes)]
+	static GLuint interleaved_stride(bool color_constant)
+	{
+		return color_constant ? 20 : 32;
+	}
+
+	static bool is_same_color(vec3 const& a, vec3 const& b)
+	{
+		return a.x == b.x && a.y == b.y && a.z == b.z;
+	}
+
+	static bool is_color_constant(numarray<vec3> const& color)
+	{
+		int const N = color.size();
+		for (int k = 1; k < N; ++k)
+			if (!is_same_color(color[k], color[0]))
+				return false;
+		return true;
+	}
+
+	// Attribute locations of the interleaved VBO in the currently bound VAO
+	static void set_interleaved_vao_location(opengl_vbo_structure const& vbo, bool color_constant)
+	{
+		GLuint const stride = interleaved_stride(color_constant);
+		opengl_set_vao_location(vbo, 0, 3, GL_FLOAT, false, 0, stride);
+		opengl_set_vao_location(vbo, 1, 4, GL_INT_2_10_10_10_REV, true, 12, stride);
+		opengl_set_vao_location(vbo, 3, 2, GL_HALF_FLOAT, false, 16, stride);
+		if (!color_constant)
+			opengl_set_vao_location(vbo, 2, 3, GL_FLOAT, false, 20, stride);
+	}
+
+	static std::vector<unsigned char> pack_interleaved_vertices(mesh const& data, bool color_constant)
+	{
+		int const N = data.position.size();
+		GLuint const stride = interleaved_stride(color_constant);
+		std::vector<unsigned char> buffer(size_t(N) * stride);
+
+		for (int k = 0; k < N; ++k) {
+			unsigned char* vertex = &buffer[size_t(k) * stride];
+			uint32_t const normal = opengl_pack_int_2_10_10_10(data.normal[k]);
+			uint16_t const uv[2] = { opengl_pack_half_float(data.uv[k].x), opengl_pack_half_float(data.uv[k].y) };
+			std::memcpy(vertex, &data.position[k], 12);
+			std::memcpy(vertex + 12, &normal, 4);
+			std::memcpy(vertex + 16, uv, 4);
+			if (!color_constant)
+				std::memcpy(vertex + 20, &data.color[k], 12);
+		}
+		return buffer;
+	}
+
+	// Sphere centered on the bounding box of the positions
+	static void mesh_bounding_sphere(mesh const& data, vec3& center, float& radius)
+	{
+		vec3 p_min = data.position[0];
+		vec3 p_max = data.position[0];
+		for (int k = 1; k < data.position.size(); ++k) {
+			for (int c = 0; c < 3; ++c) {
+				p_min[c] = std::min(p_min[c], data.position[k][c]);
+				p_max[c] = std::max(p_max[c], data.position[k][c]);
+			}
+		}
+		center = (p_min + p_max) / 2.0f;
+		radius = 0.0f;
+		for (int k = 0; k < data.position.size(); ++k)
+			radius = std::max(radius, norm(data.position[k] - center));
+	}
+
+	// Ratio between the lengths in uv and on the mesh, from the area of the triangles in both spaces
+	static float mesh_uv_density(mesh const& data)
+	{
+		if (data.uv.size() != data.position.size())
+			return 0.0f;
+
+		double area = 0.0;
+		double area_uv = 0.0;
+		for (int k = 0; k < data.connectivity.size(); ++k) {
+			uint3 const& f = data.connectivity[k];
+			area += norm(cross(data.position[f[1]] - data.position[f[0]], data.position[f[2]] - data.position[f[0]]));
+			vec2 const e1 = data.uv[f[1]] - data.uv[f[0]];
+			vec2 const e2 = data.uv[f[2]] - data.uv[f[0]];
+			area_uv += std::abs(e1.x * e2.y - e1.y * e2.x);
+		}
+		return area > 0 ? float(std::sqrt(area_uv / area)) : 0.0f;
+	}
+
 	void mesh_drawable::initialize_data_on_gpu(mesh const& data, opengl_shader_structure const& shader_arg, opengl_texture_image_structure const& texture_arg)
 	{
 		// Error detection before sending the data to avoid unexpected behavior
@@ -21,7 +111,7 @@ namespace cgp
 		opengl_check;
 
 		// Check if this mesh_drawable is already initialized
-		if (vao != 0 || vbo_position.size != 0)
+		if (vao != 0 || vbo_position.size != 0 || vbo_interleaved.size != 0)
 			warning_initialize_non_empty();
 
 		if (data.position.size() == 0) {
@@ -42,15 +132,26 @@ namespace cgp
 		model = affine();
 		material = material_mesh_drawable_phong();
 		supplementary_model_matrix = mat4::build_identity();
+		mesh_bounding_sphere(data, bounding_sphere_center, bounding_sphere_radius);
+		uv_density = mesh_uv_density(data);
 
 
 		// Send the data to the GPU
 		// ******************************************** //
 
-		vbo_position.initialize_data_on_gpu(data.position);
-		vbo_normal.initialize_data_on_gpu(data.normal);
-		vbo_color.initialize_data_on_gpu(data.color);
-		vbo_uv.initialize_data_on_gpu(data.uv);
+		vertex_color_constant = false;
+		if (vertex_layout == mesh_drawable_vertex_layout::separate) {
+			vbo_position.initialize_data_on_gpu(data.position);
+			vbo_normal.initialize_data_on_gpu(data.normal);
+			vbo_color.initialize_data_on_gpu(data.color);
+			vbo_uv.initialize_data_on_gpu(data.uv);
+		}
+		else {
+			vertex_color_constant = is_color_constant(data.color);
+			vertex_color = data.color[0];
+			std::vector<unsigned char> const buffer = pack_interleaved_vertices(data, vertex_color_constant);
+			vbo_interleaved.initialize_data_on_gpu(buffer.data(), GLuint(buffer.size()), GLuint(data.position.size()));
+		}
 
 		ebo_connectivity.initialize_data_on_gpu(data.connectivity);
 
@@ -58,12 +159,64 @@ namespace cgp
 		// Generate VAO 
 		//   - Preset shader location for default mesh shaders {position:0, normal:1, color:2, uv:3}
 		glGenVertexArrays(1, &vao); opengl_check;
-		glBindVertexArray(vao); opengl_check;
-		opengl_set_vao_location(vbo_position, 0);
-		opengl_set_vao_location(vbo_normal, 1);
-		opengl_set_vao_location(vbo_color, 2);
-		opengl_set_vao_location(vbo_uv, 3);
-		glBindVertexArray(0); opengl_check;
+		opengl_state().bind_vertex_array(vao);
+		if (vertex_layout == mesh_drawable_vertex_layout::separate) {
+			opengl_set_vao_location(vbo_position, 0);
+			opengl_set_vao_location(vbo_normal, 1);
+			opengl_set_vao_location(vbo_color, 2);
+			opengl_set_vao_location(vbo_uv, 3);
+		}
+		else {
+			set_interleaved_vao_location(vbo_interleaved, vertex_color_constant);
+		}
+		opengl_state().bind_vertex_array(0);
+	}
+
+	void mesh_drawable::update_data_on_gpu(mesh const& data)
+	{
+		if (vertex_layout == mesh_drawable_vertex_layout::separate) {
+			vbo_position.update(data.position);
+			vbo_normal.update(data.normal);
+			vbo_color.update(data.color);
+			vbo_uv.update(data.uv);
+			return;
+		}
+
+		assert_cgp(int(vbo_interleaved.size) == data.position.size(), "update_data_on_gpu must keep the same number of vertices (" + str(vbo_interleaved.size) + ") instead of " + str(data.position.size()));
+		assert_cgp(!vertex_color_constant || (is_color_constant(data.color) && is_same_color(data.color[0], vertex_color)), "update_data_on_gpu with the interleaved layout must keep the same constant color");
+		std::vector<unsigned char> const buffer = pack_interleaved_vertices(data, vertex_color_constant);
+		vbo_interleaved.update(buffer.data(), GLuint(buffer.size()));
+	}
+
+	std::vector<unsigned char> mesh_drawable::pack_interleaved(mesh const& data)
+	{
+		return pack_interleaved_vertices(data, is_color_constant(data.color));
+	}
+
+	void mesh_drawable::update_interleaved_data_on_gpu(std::vector<unsigned char> const& buffer)
+	{
+		assert_cgp(vertex_layout == mesh_drawable_vertex_layout::interleaved_compressed, "update_interleaved_data_on_gpu requires the interleaved_compressed layout");
+		assert_cgp(buffer.size() == size_t(vbo_interleaved.size) * interleaved_stride(vertex_color_constant), "update_interleaved_data_on_gpu must keep the same number of vertices and the same constant color");
+		if (vbo_interleaved_back.id == 0) {
+			vbo_interleaved.update(buffer.data(), GLuint(buffer.size()));
+			return;
+		}
+
+		// Double buffer: fill the VBO that is not used by the previous draw calls, then point the VAO to it
+		vbo_interleaved_back.update(buffer.data(), GLuint(buffer.size()));
+		std::swap(vbo_interleaved, vbo_interleaved_back);
+		opengl_state().bind_vertex_array(vao);
+		set_interleaved_vao_location(vbo_interleaved, vertex_color_constant);
+		opengl_state().bind_vertex_array(0);
+	}
+
+	void mesh_drawable::initialize_interleaved_double_buffer()
+	{
+		assert_cgp(vertex_layout == mesh_drawable_vertex_layout::interleaved_compressed && vbo_interleaved.id != 0, "initialize_interleaved_double_buffer requires a mesh initialized with the interleaved_compressed layout");
+		if (vbo_interleaved_back.id != 0)
+			return;
+		GLuint const size_byte = vbo_interleaved.size * interleaved_stride(vertex_color_constant);
+		vbo_interleaved_back.initialize_data_on_gpu(nullptr, size_byte, vbo_interleaved.size);
 	}
 
 	template<typename T>
@@ -78,9 +231,9 @@ namespace cgp
 		supplementary_vbo[k].initialize_data_on_gpu(data, divisor);
 
 		// Update VAO (User responsability to not have conflicted location)
-		glBindVertexArray(vao); opengl_check;
+		opengl_state().bind_vertex_array(vao);
 		opengl_set_vao_location(supplementary_vbo[k], location_index);
-		glBindVertexArray(0); opengl_check;
+		opengl_state().bind_vertex_array(0);
 	}
 
 	template<typename T>
@@ -94,22 +247,47 @@ namespace cgp
     		std::cerr << "Error: No supplementary VBO exists at location index " << location_index << ". Initialize it first." << std::endl;
         	return;
     	}
-		supplementary_vbo[k].update(data, size_elements_update);
+		if (data.size() > int(supplementary_vbo[k].size)) {
+			GLuint const divisor = supplementary_vbo[k].divisor;
+			supplementary_vbo[k].clear();
+			supplementary_vbo[k].initialize_data_on_gpu(data, divisor);
+		}
+		else
+			supplementary_vbo[k].update(data, size_elements_update);
 
 		
 		// Update VAO (User responsability to not have conflicted location)
-		glBindVertexArray(vao); opengl_check;
+		opengl_state().bind_vertex_array(vao);
 		opengl_set_vao_location(supplementary_vbo[k], location_index);
-		glBindVertexArray(0); opengl_check;
+		opengl_state().bind_vertex_array(0);
+	}
+
+	template<typename T>
+	void mesh_drawable::update_supplementary_data_on_gpu(numarray_arena<T> const& data, GLuint location_index, int size_elements_update)
+	{
+		int k = location_index - 4;
+		if (location_index < 4 || k >= supplementary_vbo.size() || data.size() > int(supplementary_vbo[k].size)) {
+			// Errors and re-allocation of the VBO are handled by the numarray version
+			update_supplementary_data_on_gpu(numarray<T>(lazy(data)), location_index, size_elements_update);
+			return;
+		}
+		supplementary_vbo[k].update(data, size_elements_update);
 	}
 
 	template void mesh_drawable::initialize_supplementary_data_on_gpu(numarray<vec2> const& data, GLuint location_index, GLuint divisor);
 	template void mesh_drawable::initialize_supplementary_data_on_gpu(numarray<vec3> const& data, GLuint location_index, GLuint divisor);
 	template void mesh_drawable::initialize_supplementary_data_on_gpu(numarray<vec4> const& data, GLuint location_index, GLuint divisor);
+	template void mesh_drawable::initialize_supplementary_data_on_gpu(numarray<mat4> const& data, GLuint location_index, GLuint divisor);
 
 	template void mesh_drawable::update_supplementary_data_on_gpu(numarray<vec2> const& data, GLuint location_index, int size_elements_update);
 	template void mesh_drawable::update_supplementary_data_on_gpu(numarray<vec3> const& data, GLuint location_index, int size_elements_update);
 	template void mesh_drawable::update_supplementary_data_on_gpu(numarray<vec4> const& data, GLuint location_index, int size_elements_update);
+	template void mesh_drawable::update_supplementary_data_on_gpu(numarray<mat4> const& data, GLuint location_index, int size_elements_update);
+
+	template void mesh_drawable::update_supplementary_data_on_gpu(numarray_arena<vec2> const& data, GLuint location_index, int size_elements_update);
+	template void mesh_drawable::update_supplementary_data_on_gpu(numarray_arena<vec3> const& data, GLuint location_index, int size_elements_update);
+	template void mesh_drawable::update_supplementary_data_on_gpu(numarray_arena<vec4> const& data, GLuint location_index, int size_elements_update);
+	template void mesh_drawable::update_supplementary_data_on_gpu(numarray_arena<mat4> const& data, GLuint location_index, int size_elements_update);
 	
 	void mesh_drawable::clear()
 	{
@@ -117,12 +295,16 @@ namespace cgp
 		vbo_normal.clear();
 		vbo_color.clear();
 		vbo_uv.clear();
+		vbo_interleaved.clear();
+		vbo_interleaved_back.clear();
 		for(int k=0; k<supplementary_vbo.size(); ++k)
 			supplementary_vbo[k].clear();
 		ebo_connectivity.clear();
 		
-		if(vao!=0)
+		if (vao != 0) {
 			glDeleteVertexArrays(1, &vao);
+			opengl_state().forget_vertex_array(vao);
+		}
 		vao = 0;
 
 		shader = opengl_shader_structure();
@@ -130,6 +312,10 @@ namespace cgp
 		material = material_mesh_drawable_phong();
 		texture = opengl_texture_image_structure();
 		supplementary_texture.clear();
+		vertex_color_constant = false;
+		bounding_sphere_center = vec3();
+		bounding_sphere_radius = 0.0f;
+		uv_density = 0.0f;
 
 		opengl_check;
 	}
@@ -148,13 +334,19 @@ namespace cgp
 
 
 	void draw(mesh_drawable const& drawable, environment_generic_structure const& environment, int instance_count, bool expected_uniforms, uniform_generic_structure const& additional_uniforms, GLenum draw_mode)
+	{
+		mat4 const model_shader = drawable.hierarchy_transform_model.matrix() * drawable.supplementary_model_matrix * drawable.model.matrix();
+		detail::draw_mesh_drawable(drawable, model_shader, drawable.material, &environment, instance_count, expected_uniforms, additional_uniforms, draw_mode);
+	}
+
+	void detail::draw_mesh_drawable(mesh_drawable const& drawable, mat4 const& model_shader, material_mesh_drawable_phong const& material, environment_generic_structure const* environment, int instance_count, bool expected_uniforms, uniform_generic_structure const& additional_uniforms, GLenum draw_mode)
 	{
 		opengl_check;
 		// Initial clean check
 		// ********************************** //
 		// If there is not vertices or not triangles, returns
 		//  (no error + does not display anything)
-		if (drawable.vbo_position.size == 0 || drawable.ebo_connectivity.size == 0)
+		if (drawable.vao == 0 || drawable.ebo_connectivity.size == 0)
 			return;
 
 		assert_cgp(drawable.shader.id != 0, "Try to draw mesh_drawable without shader ");
@@ -163,16 +355,19 @@ namespace cgp
 
 		// Set the current shader
 		// ********************************** //
-		glUseProgram(drawable.shader.id); opengl_check;
+		opengl_state().use_program(drawable.shader.id);
 
 		// Send uniforms for this shader
 		// ********************************** //
 
 		// send the uniform values for the model and material of the mesh_drawable
-		drawable.send_opengl_uniform(expected_uniforms);
+		static opengl_uniform_handle const uniform_model("model");
+		opengl_uniform(drawable.shader, uniform_model, model_shader, expected_uniforms);
+		material.send_opengl_uniform(drawable.shader, expected_uniforms);
 
 		// send the uniform values for the environment
-		environment.send_opengl_uniform(drawable.shader, expected_uniforms && environment.default_expected_uniform);
+		if (environment != nullptr)
+			environment->send_opengl_uniform(drawable.shader, expected_uniforms && environment->default_expected_uniform);
 
 		// [Optionnal] send any additional uniform for this specidic draw call
 		additional_uniforms.send_opengl_uniform(drawable.shader, expected_uniforms);
@@ -180,9 +375,10 @@ namespace cgp
 
 		// Set textures
 		// ********************************** //
-		glActiveTexture(GL_TEXTURE0); opengl_check;
+		opengl_state().active_texture(0);
 		drawable.texture.bind();
-		opengl_uniform(drawable.shader, "image_texture", 0, expected_uniforms);  opengl_check;
+		static opengl_uniform_handle const uniform_image_texture("image_texture");
+		opengl_uniform(drawable.shader, uniform_image_texture, 0, expected_uniforms);  opengl_check;
 
 		//Set any additional texture
 		int texture_count = 1;
@@ -191,7 +387,7 @@ namespace cgp
 			std::string const& additional_texture_name = element.first;
 			opengl_texture_image_structure const& additional_texture = element.second;
 
-			glActiveTexture(GL_TEXTURE0 + texture_count); opengl_check;
+			opengl_state().active_texture(texture_count);
 			additional_texture.bind();
 			opengl_uniform(drawable.shader, additional_texture_name, texture_count, expected_uniforms);
 
@@ -202,8 +398,12 @@ namespace cgp
 
 		// Prepare for draw call
 		// ********************************** //
-		glBindVertexArray(drawable.vao);                                     opengl_check;
+		opengl_state().bind_vertex_array(drawable.vao);
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, drawable.ebo_connectivity.id); opengl_check;
+		if (drawable.vertex_color_constant) {
+			// The color isn't stored per vertex: constant value of the attribute (not part of the VAO state)
+			glVertexAttrib3f(2, drawable.vertex_color.x, drawable.vertex_color.y, drawable.vertex_color.z); opengl_check;
+		}
 
 
 		// Draw call
@@ -216,11 +416,23 @@ namespace cgp
 		}
 
 
-		// Clean state
-		// ********************************** //
-		glBindVertexArray(0);
-		drawable.texture.unbind();
-		glUseProgram(0);
+		// The program, textures and VAO stay bound: the next draw call only changes the ones that differ (see opengl_state())
+	}
+
+	void request_texture_residency(mesh_drawable const& drawable)
+	{
+		request_texture_residency(drawable, drawable.hierarchy_transform_model.matrix() * drawable.supplementary_model_matrix * drawable.model.matrix());
+	}
+
+	void request_texture_residency(mesh_drawable const& drawable, mat4 const& model)
+	{
+		// Largest scaling of the model: the sphere is enlarged, the texture coordinates are spread on longer lengths
+		float const scaling = std::max(norm(model.transform_vector({1, 0, 0})), std::max(norm(model.transform_vector({0, 1, 0})), norm(model.transform_vector({0, 0, 1}))));
+		if (scaling <= 0)
+			return;
+
+		vec3 const center = model.transform_position(drawable.bounding_sphere_center);
+		opengl_texture_residency().request(drawable.texture, center, scaling * drawable.bounding_sphere_radius, drawable.uv_density / scaling);
 	}
 
 	void draw_wireframe(mesh_drawable const& drawable, environment_generic_structure const& environment, vec3 const& color, int instance_count, bool expected_uniforms, uniform_generic_structure const& additional_uniforms)
@@ -248,7 +460,8 @@ namespace cgp
 		mat4 const model_shader = hierarchy_transform_model.matrix() * supplementary_model_matrix * model.matrix();
 
 		// set the Model matrix
-		opengl_uniform(shader, "model", model_shader, expected);
+		static opengl_uniform_handle const uniform_model("model");
+		opengl_uniform(shader, uniform_model, model_shader, expected);
 
 		// set the material
 		material.send_opengl_uniform(shader, expected);
@@ -7,9 +7,18 @@
 #include "cgp/16_drawable/environment/environment.hpp"
 
 #include <functional>
+#include <vector>
 
 namespace cgp
 {
+	// Organization of the vertex data of a mesh_drawable on the GPU
+	//  - separate: one VBO per attribute (vbo_position, vbo_normal, vbo_color, vbo_uv) that can be updated individually
+	//  - interleaved_compressed: all the attributes of a vertex consecutively in a single VBO (vbo_interleaved)
+	//      position: 3 floats, normal: 10:10:10:2 signed normalized, uv: 2 half floats (precision of 1/2048 for uv in [1,2])
+	//      color: 3 floats - or omitted when it is the same for all vertices (then sent as a constant attribute)
+	//      => 20 Bytes per vertex with a constant color instead of 44. Updated with update_data_on_gpu().
+	enum class mesh_drawable_vertex_layout { separate, interleaved_compressed };
+
 	// Main structure used to draw a mesh
 	struct mesh_drawable
 	{
@@ -24,6 +33,12 @@ namespace cgp
 		opengl_texture_image_structure texture; // Actual texture (used if defined)
 		std::map<std::string, opengl_texture_image_structure> supplementary_texture; // optional supplementary texture (can be used for multi-texturing)
 
+		// Bounding sphere of the mesh, and length of its texture coordinates per unit of length (0 without texture coordinates)
+		//  Computed by initialize_data_on_gpu, used to choose the mipmap levels of the texture (see request_texture_residency)
+		vec3 bounding_sphere_center;
+		float bounding_sphere_radius = 0.0f;
+		float uv_density = 0.0f;
+
 		// Vertex Buffer Objects
 		// ********************************* //
 		opengl_vbo_structure vbo_position;
@@ -32,6 +47,15 @@ namespace cgp
 		opengl_vbo_structure vbo_uv;
 		std::vector<opengl_vbo_structure> supplementary_vbo; // optional supplementary vbo (per-vertex or per-instance)
 
+		// Layout of the vertex data (to be set before initialize_data_on_gpu)
+		mesh_drawable_vertex_layout vertex_layout = mesh_drawable_vertex_layout::separate;
+		// Single VBO used by the interleaved_compressed layout (the 4 VBOs above are then empty)
+		opengl_vbo_structure vbo_interleaved;
+		bool vertex_color_constant = false; // interleaved layout only: the color is not stored per vertex
+		vec3 vertex_color;                  // value of the constant color
+		// Optional second interleaved VBO (see initialize_interleaved_double_buffer) - the connectivity is shared
+		opengl_vbo_structure vbo_interleaved_back;
+
 		// Indexed connectivity
 		// ********************************* //
 		opengl_ebo_structure ebo_connectivity;
@@ -68,6 +92,19 @@ namespace cgp
 		// Fill the VBO and VAO of the class using the data provided from the mesh
 		void initialize_data_on_gpu(mesh const& data, opengl_shader_structure const& shader = default_shader, opengl_texture_image_structure const& texture = default_texture);
 
+		// Send new vertex data to the GPU (same number of vertices, no re-allocation)
+		//  With the interleaved layout, a constant color must keep the same value.
+		void update_data_on_gpu(mesh const& data);
+
+		// Vertex data of a mesh in the interleaved_compressed layout - can be computed out of the render thread (ex. in a worker
+		//  thread), and sent with update_interleaved_data_on_gpu (same number of vertices, and same constant color if any)
+		static std::vector<unsigned char> pack_interleaved(mesh const& data);
+		void update_interleaved_data_on_gpu(std::vector<unsigned char> const& buffer);
+
+		// Allocate a second interleaved VBO: update_interleaved_data_on_gpu then fills the VBO that is not used by the
+		//  previous draw calls and swaps the two (no wait on the pending draws). The EBO and VAO are not duplicated.
+		void initialize_interleaved_double_buffer();
+
 		// Clear the GPU memory from the VBO and VAO data
 		void clear();
 
@@ -75,12 +112,17 @@ namespace cgp
 		void send_opengl_uniform(bool expected = true) const;
 
 		// Additional method allowing to fill an additional VBO
+		//  T can be vec2, vec3, vec4, or mat4 (ex. per-instance model matrices with divisor=1 - a mat4 uses the locations [location_index, location_index+3])
 		template<typename T>
 		void initialize_supplementary_data_on_gpu(numarray<T> const& data, GLuint location_index, GLuint divisor = 0);
 		
 		// Additional method allowing to update an additional VBO
+		//  The VBO is re-allocated if data has more elements than the current VBO
 		template<typename T>
 		void update_supplementary_data_on_gpu(numarray<T> const& data, GLuint location_index, int size_elements_update = -1);
+		// Same from a per-frame buffer (ex. instance data recomputed at each frame)
+		template<typename T>
+		void update_supplementary_data_on_gpu(numarray_arena<T> const& data, GLuint location_index, int size_elements_update = -1);
 	};
 
 
@@ -88,6 +130,18 @@ namespace cgp
 	//  draw([mesh_drawable], environment);
 	void draw(mesh_drawable const& drawable, environment_generic_structure const& environment = environment_generic_structure(), int instance_count=1, bool expected_uniforms=true, uniform_generic_structure const& additional_uniforms = uniform_generic_structure(), GLenum draw_mode=GL_TRIANGLES);
 
+	namespace detail
+	{
+		// Draw call of a mesh_drawable with the final model matrix and the material given as parameters
+		//  The environment uniforms are not sent if environment is nullptr (ex. already sent to the shader).
+		void draw_mesh_drawable(mesh_drawable const& drawable, mat4 const& model_shader, material_mesh_drawable_phong const& material, environment_generic_structure const* environment, int instance_count, bool expected_uniforms, uniform_generic_structure const& additional_uniforms, GLenum draw_mode);
+	}
+
+	// Request the mipmap levels of the texture needed to draw the drawable at its distance to the camera (see opengl_texture_residency())
+	//  model: model matrix of the drawn element (ex. of an instance), by default the one used by draw()
+	void request_texture_residency(mesh_drawable const& drawable);
+	void request_texture_residency(mesh_drawable const& drawable, mat4 const& model);
+
 	// Draw the same shape while activating the GL_POLYGON_OFFSET_LINE mode from OpenGL
 	void draw_wireframe(mesh_drawable const& drawable, environment_generic_structure const& environment = environment_generic_structure(), vec3 const& color = {0,0,1}, int instance_count = 1, bool expected_uniforms = true, uniform_generic_structure const& additional_uniforms = uniform_generic_structure());
 
@@ -80,9 +80,9 @@ namespace cgp {
 
 		// Generate VAO
 		glGenVertexArrays(1, &vao); opengl_check;
-		glBindVertexArray(vao); opengl_check;
+		opengl_state().bind_vertex_array(vao);
 		opengl_set_vao_location(vbo_position, 0);
-		glBindVertexArray(0); opengl_check;
+		opengl_state().bind_vertex_array(0);
 		
 	}
 
@@ -104,7 +104,7 @@ namespace cgp {
 
 		// Set the current shader
 		// ********************************** //
-		glUseProgram(drawable.shader.id); opengl_check;
+		opengl_state().use_program(drawable.shader.id);
 
 		// Send uniforms for this shader
 		// ********************************** //
@@ -120,24 +120,17 @@ namespace cgp {
 
 		// Set textures
 		// ********************************** //
-		glActiveTexture(GL_TEXTURE0); opengl_check;
+		opengl_state().active_texture(0);
 		drawable.texture.bind();
 		opengl_uniform(drawable.shader, "image_skybox", 0);  opengl_check;
 
 		// Draw call
 		// ********************************** //
-		glBindVertexArray(drawable.vao);   opengl_check;
+		opengl_state().bind_vertex_array(drawable.vao);
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, drawable.ebo_connectivity.id); opengl_check;
 		glDrawElements(GL_TRIANGLES, GLsizei(drawable.ebo_connectivity.size * 3), GL_UNSIGNED_INT, nullptr); opengl_check;
 
-
-
-		// Clean state
-		// ********************************** //
-		glBindVertexArray(0);
-		glActiveTexture(GL_TEXTURE0); opengl_check;
-		glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
-		glUseProgram(0);
+		// The program, texture and VAO stay bound: the next draw call only changes the ones that differ (see opengl_state())
 	}
 
 	
@@ -91,12 +91,12 @@ namespace cgp
 		
 		// Generate VAO
 		glGenVertexArrays(1, &vao); opengl_check;
-		glBindVertexArray(vao); opengl_check;
+		opengl_state().bind_vertex_array(vao);
 		opengl_set_vao_location(vbo_position, 0);
 		opengl_set_vao_location(vbo_normal, 1);
 		opengl_set_vao_location(vbo_color, 2);
 		opengl_set_vao_location(vbo_uv, 3);
-		glBindVertexArray(0); opengl_check;
+		opengl_state().bind_vertex_array(0);
 	}
 
 	void triangles_drawable::clear()
@@ -106,8 +106,10 @@ namespace cgp
 		vbo_color.clear();
 		vbo_uv.clear();
 		
-		if(vao!=0)
+		if (vao != 0) {
 			glDeleteVertexArrays(1, &vao);
+			opengl_state().forget_vertex_array(vao);
+		}
 		vao = 0;
 		vertex_number = 0;
 
@@ -148,7 +150,7 @@ namespace cgp
 
 		// Set the current shader
 		// ********************************** //
-		glUseProgram(drawable.shader.id); opengl_check;
+		opengl_state().use_program(drawable.shader.id);
 
 		// Send uniforms for this shader
 		// ********************************** //
@@ -165,9 +167,10 @@ namespace cgp
 
 		// Set textures
 		// ********************************** //
-		glActiveTexture(GL_TEXTURE0); opengl_check;
+		opengl_state().active_texture(0);
 		drawable.texture.bind();
-		opengl_uniform(drawable.shader, "image_texture", 0);  opengl_check;
+		static opengl_uniform_handle const uniform_image_texture("image_texture");
+		opengl_uniform(drawable.shader, uniform_image_texture, 0);  opengl_check;
 
 		//Set any additional texture
 		int texture_count = 1;
@@ -176,7 +179,7 @@ namespace cgp
 			std::string const& additional_texture_name = element.first;
 			opengl_texture_image_structure const& additional_texture = element.second;
 
-			glActiveTexture(GL_TEXTURE0 + texture_count); opengl_check;
+			opengl_state().active_texture(texture_count);
 			additional_texture.bind();
 			opengl_uniform(drawable.shader, additional_texture_name, texture_count);
 
@@ -186,7 +189,7 @@ namespace cgp
 
 		// Prepare for draw call
 		// ********************************** //
-		glBindVertexArray(drawable.vao);                                     opengl_check;
+		opengl_state().bind_vertex_array(drawable.vao);
 
 
 		// Draw call
@@ -194,11 +197,7 @@ namespace cgp
 		glDrawArrays(GL_TRIANGLES, 0, drawable.vertex_number); opengl_check;
 
 
-		// Clean state
-		// ********************************** //
-		glBindVertexArray(0);
-		drawable.texture.unbind();
-		glUseProgram(0);
+		// The program, textures and VAO stay bound: the next draw call only changes the ones that differ (see opengl_state())
 	}
 
 	void draw_wireframe(triangles_drawable const& drawable, environment_generic_structure const& environment, vec3 const& color, uniform_generic_structure const& additional_uniforms)
@@ -228,8 +227,10 @@ namespace cgp
 		
 
 		// set the Model matrix
-		opengl_uniform(shader, "model", model_shader, expected);
-		opengl_uniform(shader, "modelNormal", model_normal_shader, expected);
+		static opengl_uniform_handle const uniform_model("model");
+		static opengl_uniform_handle const uniform_model_normal("modelNormal");
+		opengl_uniform(shader, uniform_model, model_shader, expected);
+		opengl_uniform(shader, uniform_model_normal, model_normal_shader, expected);
 
 		// set the material
 		material.send_opengl_uniform(shader);
@@ -2,10 +2,15 @@
 
 #include <GLFW/glfw3.h>
 
+#include <algorithm>
+#include <cmath>
+
 namespace cgp
 {
     timer_fps::timer_fps(float update_fps_period)
-        :timer_event_periodic(update_fps_period), fps(0), counter(0)
+        :timer_event_periodic(update_fps_period), fps(0),
+        frame_time_average(0), frame_time_jitter(0), frame_time_max(0), sleep_ratio(0), spin_ratio(0),
+        counter(0), dt_sum(0), dt2_sum(0), dt_max(0), sleep_sum(0), spin_sum(0)
     {}
 
     float timer_fps::update()
@@ -14,15 +19,32 @@ namespace cgp
         ++counter;
 
         float const dt = timer_event_periodic::update();
+        dt_sum += dt;
+        dt2_sum += dt * dt;
+        dt_max = std::max(dt_max, dt);
+
         if (event)
         {
             fps = counter/elapsed_time;
+
+            frame_time_average = dt_sum / counter;
+            frame_time_jitter = std::sqrt(std::max(0.0f, dt2_sum / counter - frame_time_average * frame_time_average));
+            frame_time_max = dt_max;
+            sleep_ratio = dt_sum > 0 ? sleep_sum / dt_sum : 0.0f;
+            spin_ratio = dt_sum > 0 ? spin_sum / dt_sum : 0.0f;
+
             counter = 0;
+            dt_sum = 0; dt2_sum = 0; dt_max = 0;
+            sleep_sum = 0; spin_sum = 0;
         }
 
         return dt;
     }
 
+    void timer_fps::add_wait_time(float sleep_time, float spin_time)
+    {
+        sleep_sum += sleep_time;
+        spin_sum += spin_time;
+    }
 
-
-}
\ No newline at end of file
+}
@@ -13,9 +13,21 @@ namespace cgp
 		timer_fps(float update_fps_period=1.5f);
 		float update();
 
+		// Add the time spent by the frame limiter during the current frame (see timer_frame_pacing)
+		void add_wait_time(float sleep_time, float spin_time);
+
 		int fps;
+
+		// Statistics over the last period (in s)
+		float frame_time_average; // average duration of a frame
+		float frame_time_jitter;  // standard deviation of the duration of the frames
+		float frame_time_max;     // duration of the slowest frame
+		float sleep_ratio;        // fraction of the time spent sleeping in the frame limiter
+		float spin_ratio;         // fraction of the time spent spinning in the frame limiter
 	private:
 		int counter;
+		float dt_sum, dt2_sum, dt_max;
+		float sleep_sum, spin_sum;
 	};
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,99 @@
+#include "timer_frame_pacing.hpp"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <mmsystem.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "winmm.lib")
+#endif
+#endif
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace cgp
+{
+	// Upper bound of the estimated oversleep: a single long sleep (ex. preemption) must not turn the next frames into spinning
+	static float const max_sleep_error = 0.002f;
+
+#if defined(_WIN32)
+	// Scheduler resolution of 1ms during the limiter (the default Windows resolution is ~15.6ms)
+	struct scoped_timer_resolution
+	{
+		scoped_timer_resolution() { timeBeginPeriod(1); }
+		~scoped_timer_resolution() { timeEndPeriod(1); }
+	};
+#endif
+
+	timer_frame_pacing::timer_frame_pacing()
+		:sleep_time(0), spin_time(0), spin_margin(0.0005f), fixed_dt(1.0f / 120.0f), max_steps_per_frame(8), started(false), deadline(0), sleep_error(0.001f), accumulator(0)
+	{}
+
+	void timer_frame_pacing::wait(float fps_max)
+	{
+		double const period = 1.0 / fps_max;
+		double now = glfwGetTime();
+		sleep_time = 0;
+		spin_time = 0;
+
+		// First frame, or more than one frame late: restart the sequence of deadlines from now instead of catching up
+		if (!started || now > deadline + period) {
+			deadline = now;
+			started = true;
+		}
+
+#if defined(_WIN32)
+		scoped_timer_resolution const resolution;
+#endif
+		while (now < deadline)
+		{
+			double const remaining = deadline - now;
+			double const spin_threshold = spin_margin + sleep_error;
+
+			if (remaining > spin_threshold) {
+				// Sleep, and keep track of the oversleep of the system
+				double const requested = remaining - spin_threshold;
+				std::this_thread::sleep_for(std::chrono::duration<double>(requested));
+				double const after = glfwGetTime();
+				float const oversleep = std::max(0.0f, float(after - now - requested));
+				sleep_error = std::min(max_sleep_error, std::max(oversleep, 0.9f * sleep_error + 0.1f * oversleep));
+				sleep_time += float(after - now);
+				now = after;
+			}
+			else {
+				std::this_thread::yield();
+				double const after = glfwGetTime();
+				spin_time += float(after - now);
+				now = after;
+			}
+		}
+
+		deadline += period;
+	}
+
+	void timer_frame_pacing::reset()
+	{
+		started = false;
+		accumulator = 0;
+	}
+
+	int timer_frame_pacing::fixed_steps(float dt)
+	{
+		accumulator = std::min(accumulator + dt, max_steps_per_frame * fixed_dt);
+
+		int const steps = int(accumulator / fixed_dt);
+		accumulator -= steps * fixed_dt;
+		return steps;
+	}
+
+	float timer_frame_pacing::fixed_alpha() const
+	{
+		return accumulator / fixed_dt;
+	}
+
+}
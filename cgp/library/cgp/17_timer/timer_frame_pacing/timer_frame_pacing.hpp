@@ -0,0 +1,44 @@
+#pragma once
+
+namespace cgp
+{
+
+	/** Frame rate limiter and fixed time step scheduler
+	 * - wait(fps_max): sleeps until shortly before the end of the frame, and only spins (yielding the thread) for the last
+	 *   fraction of millisecond. The spin duration is adapted to the observed precision of the system sleep.
+	 * - fixed_steps(dt): number of simulation steps of duration fixed_dt to run for a rendered frame lasting dt, so that
+	 *   the simulation is independent of the rendering frame rate. */
+	class timer_frame_pacing
+	{
+	public:
+
+		timer_frame_pacing();
+
+		// Wait for the end of the current frame period (1/fps_max after the previous one)
+		void wait(float fps_max);
+		// Forget the previous frames (ex. after a pause)
+		void reset();
+
+		// Time spent during the last call to wait() (in s)
+		float sleep_time;
+		float spin_time;
+
+		// Minimal time before the end of the frame under which the thread spins instead of sleeping (in s)
+		float spin_margin;
+
+		// Number of fixed steps to simulate to catch up with the elapsed time dt
+		int fixed_steps(float dt);
+		// Fraction of a fixed step elapsed but not simulated yet, in [0,1[ (can be used to interpolate the display)
+		float fixed_alpha() const;
+
+		float fixed_dt;          // Duration of a simulation step (in s)
+		int max_steps_per_frame; // Elapsed time above max_steps_per_frame x fixed_dt is dropped (avoid accumulating delay after a slow frame)
+
+	private:
+		bool started;
+		double deadline;     // end of the current frame period
+		float sleep_error;   // estimation of the maximal oversleep of the system (at most 2ms)
+		float accumulator;   // elapsed time not simulated yet
+	};
+
+}
@@ -0,0 +1,129 @@
+#include "cgpmesh.hpp"
+
+#include "cgp/01_base/base.hpp"
+#include "cgp/03_files/files.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace cgp
+{
+    // Layout of the file:
+    //  [header (64 octets)] [position] [normal] [color] [uv] [connectivity] - each array starts on a multiple of 16 octets
+    struct cgpmesh_header {
+        char magic[8];
+        uint32_t version;
+        uint32_t endianness;   // 0x01020304 written in the native order
+        uint64_t source_hash;
+        uint32_t count[5];     // number of elements of position/normal/color/uv/connectivity
+        uint32_t element_size[5];
+    };
+    static_assert(sizeof(cgpmesh_header) == 64, "Unexpected size of cgpmesh header");
+
+    static char const cgpmesh_magic[8] = {'C','G','P','M','E','S','H','\0'};
+    // The caches are only invalidated by a change of source content or of version: bump it whenever the layout of the file,
+    //  or the meshes written by the loaders (obj parser, triangulation, fill_empty_field, normal computation...) change
+    static uint32_t const cgpmesh_version = 2;
+    static uint32_t const cgpmesh_endianness = 0x01020304;
+
+    static size_t cgpmesh_align(size_t offset)
+    {
+        return (offset + 15) & ~size_t(15);
+    }
+
+    static size_t cgpmesh_file_size(cgpmesh_header const& header)
+    {
+        size_t offset = sizeof(cgpmesh_header);
+        for (int k = 0; k < 5; ++k)
+            offset = cgpmesh_align(offset + size_t(header.count[k]) * header.element_size[k]);
+        return offset;
+    }
+
+    template <typename T>
+    static void cgpmesh_write_array(std::ofstream& stream, numarray<T> const& data)
+    {
+        size_t const size = data.size() * sizeof(T);
+        if (size > 0)
+            stream.write(reinterpret_cast<char const*>(data.data.data()), size);
+        static char const zeros[16] = {};
+        stream.write(zeros, cgpmesh_align(size) - size);
+    }
+
+    template <typename T>
+    static char const* cgpmesh_read_array(char const* it, uint32_t count, numarray<T>& data)
+    {
+        T const* begin = reinterpret_cast<T const*>(it);
+        data.data.assign(begin, begin + count);
+        return it + cgpmesh_align(count * sizeof(T));
+    }
+
+    bool mesh_save_file_cgpmesh(std::string const& filename, mesh const& m, uint64_t source_hash)
+    {
+        cgpmesh_header header = {};
+        std::memcpy(header.magic, cgpmesh_magic, 8);
+        header.version = cgpmesh_version;
+        header.endianness = cgpmesh_endianness;
+        header.source_hash = source_hash;
+        header.count[0] = uint32_t(m.position.size());     header.element_size[0] = sizeof(vec3);
+        header.count[1] = uint32_t(m.normal.size());       header.element_size[1] = sizeof(vec3);
+        header.count[2] = uint32_t(m.color.size());        header.element_size[2] = sizeof(vec3);
+        header.count[3] = uint32_t(m.uv.size());           header.element_size[3] = sizeof(vec2);
+        header.count[4] = uint32_t(m.connectivity.size()); header.element_size[4] = sizeof(uint3);
+
+        // Write in a temporary file, then rename: a reader never sees a partially written file
+        std::string const filename_tmp = filename + ".tmp";
+        {
+            std::ofstream stream(filename_tmp, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!stream.is_open())
+                return false;
+
+            stream.write(reinterpret_cast<char const*>(&header), sizeof(header));
+            cgpmesh_write_array(stream, m.position);
+            cgpmesh_write_array(stream, m.normal);
+            cgpmesh_write_array(stream, m.color);
+            cgpmesh_write_array(stream, m.uv);
+            cgpmesh_write_array(stream, m.connectivity);
+            if (!stream.good()) {
+                stream.close();
+                std::remove(filename_tmp.c_str());
+                return false;
+            }
+        }
+
+        std::remove(filename.c_str()); // rename doesn't replace an existing file on Windows
+        if (std::rename(filename_tmp.c_str(), filename.c_str()) != 0) {
+            std::remove(filename_tmp.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool mesh_load_file_cgpmesh(std::string const& filename, mesh& m, uint64_t source_hash)
+    {
+        if (!check_file_exist(filename) || file_get_size(filename) < sizeof(cgpmesh_header))
+            return false;
+
+        file_mapping_structure file;
+        file.open(filename);
+
+        cgpmesh_header header;
+        std::memcpy(&header, file.data, sizeof(header));
+        bool const valid_header = std::memcmp(header.magic, cgpmesh_magic, 8) == 0
+            && header.version == cgpmesh_version
+            && header.endianness == cgpmesh_endianness
+            && header.element_size[0] == sizeof(vec3) && header.element_size[1] == sizeof(vec3) && header.element_size[2] == sizeof(vec3)
+            && header.element_size[3] == sizeof(vec2) && header.element_size[4] == sizeof(uint3);
+        if (!valid_header || header.source_hash != source_hash || cgpmesh_file_size(header) != file.size)
+            return false;
+
+        char const* it = file.data + sizeof(cgpmesh_header);
+        it = cgpmesh_read_array(it, header.count[0], m.position);
+        it = cgpmesh_read_array(it, header.count[1], m.normal);
+        it = cgpmesh_read_array(it, header.count[2], m.color);
+        it = cgpmesh_read_array(it, header.count[3], m.uv);
+        it = cgpmesh_read_array(it, header.count[4], m.connectivity);
+
+        return true;
+    }
+}
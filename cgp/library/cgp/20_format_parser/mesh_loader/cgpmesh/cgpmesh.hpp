@@ -0,0 +1,19 @@
+#pragma once
+
+#include "cgp/11_mesh/mesh.hpp"
+
+#include <cstdint>
+
+namespace cgp
+{
+    /** Save a mesh in the binary format .cgpmesh
+    * The file stores a versioned header followed by the raw arrays position/normal/color/uv/connectivity.
+    * source_hash identifies the content of the file the mesh has been generated from (see file_content_hash).
+    * Return false if the file cannot be written. */
+    bool mesh_save_file_cgpmesh(std::string const& filename, mesh const& m, uint64_t source_hash);
+
+    /** Load a mesh stored as .cgpmesh
+    * The file is memory-mapped and each array is copied in one block into the mesh.
+    * Return false (m is unchanged) if the file doesn't exist, has been written by another version, or from another source content. */
+    bool mesh_load_file_cgpmesh(std::string const& filename, mesh& m, uint64_t source_hash);
+}
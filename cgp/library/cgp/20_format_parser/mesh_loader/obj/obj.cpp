@@ -9,8 +9,16 @@
 
 #include "cgp/01_base/base.hpp"
 #include "cgp/03_files/files.hpp"
+#include "cgp/cgp_parameters.hpp"
+#include "../cgpmesh/cgpmesh.hpp"
 
-#include <map>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
 
 #include <fstream>
 #include <sstream>
@@ -69,154 +77,188 @@ namespace cgp
     }
 
 
-// Comparator of triplet of integer for std::map
-struct comparator_int3 {
-    long int N; // number of vertices
+// Hash table (open addressing, linear probing) from a triplet of indices position/texture/normal to the index of the vertex in the mesh
+struct hash_table_int3 {
 
-    comparator_int3(int N_arg=0) :N(N_arg) {}
+    struct slot_structure {
+        int3 key;
+        int value = -1; // -1: empty slot
+    };
 
-    // compute a<b
-    bool operator()(int3 const& a, int3 const& b) const
+    std::vector<slot_structure> slots;
+    size_t mask = 0;
+
+    // Allocate for at most N distinct keys (load factor <= 1/2)
+    explicit hash_table_int3(size_t N)
     {
-        long int const offset_a = long(a[0]) + N*(long(a[1]) + N*long(a[2]));
-        long int const offset_b = long(b[0]) + N*(long(b[1]) + N*long(b[2]));
-        return offset_a < offset_b;
+        size_t capacity = 16;
+        while(capacity < 2*N)
+            capacity *= 2;
+        slots.resize(capacity);
+        mask = capacity-1;
     }
-};
 
+    static size_t hash(int3 const& key)
+    {
+        uint64_t h = uint64_t(uint32_t(key[0]));
+        h = h*0x9E3779B97F4A7C15ull ^ uint64_t(uint32_t(key[1]));
+        h = h*0x9E3779B97F4A7C15ull ^ uint64_t(uint32_t(key[2]));
+        h ^= h >> 29;
+        h *= 0xBF58476D1CE4E5B9ull;
+        h ^= h >> 32;
+        return size_t(h);
+    }
 
-static numarray<numarray_stack<int3,3>> triangulate_faces(numarray<numarray<int3>> faces);
+    // Return the value associated to the key, or insert (key,value) and return value if the key is not in the table
+    int find_or_insert(int3 const& key, int value)
+    {
+        size_t k = hash(key) & mask;
+        while(true) {
+            slot_structure& slot = slots[k];
+            if(slot.value == -1) {
+                slot.key = key;
+                slot.value = value;
+                return value;
+            }
+            if(slot.key[0]==key[0] && slot.key[1]==key[1] && slot.key[2]==key[2])
+                return slot.value;
+            k = (k+1) & mask;
+        }
+    }
+};
 
 
-static std::pair<mesh, std::map<int3, int, comparator_int3>>
-    make_unique_parameter_per_value(numarray<vec3> const& positions,
-                                    numarray<vec2> const& texture_uv,
-                                    numarray<vec3> const& normals,
-                                    numarray<numarray_stack<int3,3>> const& faces,
-                                    loader::obj_type const type);
+// Duplicate the vertices having different texture or normal indices
+//  Returns the mesh, and the triplet of indices of each of its vertex
+static mesh make_unique_parameter_per_value(numarray<vec3> const& positions,
+                                            numarray<vec2> const& texture_uv,
+                                            numarray<vec3> const& normals,
+                                            numarray<numarray_stack<int3,3>> const& faces,
+                                            loader::obj_type const type,
+                                            std::vector<int3>& vertex_index);
 
 
 mesh mesh_load_file_obj(const std::string& filename)
 {
-    numarray<numarray<int>> vertex_correspondance;
-     mesh m = mesh_load_file_obj(filename, vertex_correspondance);
-     m.fill_empty_field();
-     return m;
+#ifndef CGP_NO_MESH_CACHE
+    // Reuse the binary cache if it has been generated from the same content
+    assert_file_exist(filename);
+    std::string const filename_cache = filename + ".cgpmesh";
+    uint64_t const source_hash = file_content_hash(filename);
+
+    mesh m;
+    if(mesh_load_file_cgpmesh(filename_cache, m, source_hash))
+        return m;
+
+    m = mesh_load_file_obj(filename, nullptr);
+    m.fill_empty_field();
+    mesh_save_file_cgpmesh(filename_cache, m, source_hash); // the cache is optional: ignore write failure (ex. read-only directory)
+    return m;
+#else
+    mesh m = mesh_load_file_obj(filename, nullptr);
+    m.fill_empty_field();
+    return m;
+#endif
 }
 mesh mesh_load_file_obj(const std::string& filename, numarray<numarray<int> >& vertex_correspondance)
+{
+    return mesh_load_file_obj(filename, &vertex_correspondance);
+}
+mesh mesh_load_file_obj(const std::string& filename, numarray<numarray<int> >* vertex_correspondance)
 {
     assert_file_exist(filename);
 
-    // Load parameters
-    numarray<vec3> positions = loader::obj_read_positions(filename);
-    numarray<vec2> texture_uv = loader::obj_read_texture_uv(filename);
-    numarray<vec3> normals = loader::obj_read_normals(filename);
+    // Load parameters and triangulated connectivity in a single pass
+    loader::obj_content_structure const content = loader::obj_read_content(filename);
+    numarray<vec3> const& positions = content.position;
+    numarray<vec2> const& texture_uv = content.texture_uv;
+    numarray<vec3> const& normals = content.normal;
+    numarray<numarray_stack<int3,3>> const& faces = content.triangles;
+    loader::obj_type const type = content.type;
 
     assert_cgp(positions.size()>0, str("File ")+filename+" has 0 vertices");
 
-    // set obj type
-    loader::obj_type type = loader::obj_type::vertex;
-    if(texture_uv.size()>0 && normals.size()>0)
-        type = loader::obj_type::vertex_texture_normal;
-    else if( texture_uv.size()>0 )
-        type = loader::obj_type::vertex_texture;
-    else if( normals.size()>0 )
-        type = loader::obj_type::vertex_normal;
-
-    // Load connectivity and triangulate
-    numarray<numarray_stack<int3,3>> faces = triangulate_faces( loader::obj_read_faces(filename, type) );
-
     // Set unique per-vertex value for texture and normals (duplicate vertices if necessary)
-    mesh m;
-    std::map<int3, int, comparator_int3> connectivity_map;
-    std::tie(m,connectivity_map) = make_unique_parameter_per_value(positions, texture_uv, normals, faces, type);
+    std::vector<int3> vertex_index;
+    mesh m = make_unique_parameter_per_value(positions, texture_uv, normals, faces, type, vertex_index);
 
     // Retrieve correspondance between initial vertices in files and new ones
-    vertex_correspondance.resize(positions.size());
-    for(auto const& it : connectivity_map)
+    if(vertex_correspondance != nullptr)
     {
-        int const vertex_in = it.first[0];
-        int const vertex_out = it.second;
-
-        vertex_correspondance[vertex_in].push_back(vertex_out);
+        numarray<numarray<int>>& correspondance = *vertex_correspondance;
+        correspondance.clear();
+        correspondance.resize(positions.size());
+        for(int vertex_out=0; vertex_out<int(vertex_index.size()); ++vertex_out)
+            correspondance[vertex_index[vertex_out][0]].push_back(vertex_out);
+
+        // Vertices duplicated from the same position are ordered by (normal, texture) index
+        for(numarray<int>& duplicates : correspondance.data) {
+            if(duplicates.size() > 1) {
+                std::sort(duplicates.data.begin(), duplicates.data.end(), [&vertex_index](int a, int b) {
+                    int3 const& ia = vertex_index[a];
+                    int3 const& ib = vertex_index[b];
+                    return ia[2]<ib[2] || (ia[2]==ib[2] && ia[1]<ib[1]);
+                });
+            }
+        }
     }
 
     return m;
 }
 
 
-numarray<numarray_stack<int3,3>> triangulate_faces(numarray<numarray<int3>> faces)
-{
-    numarray<numarray_stack<int3,3>> faces_triangulation;
-    size_t const N_face = faces.size();
-    for(size_t k_face=0; k_face<N_face; ++k_face)
-    {
-        numarray<int3> const& current_polygon = faces[k_face];
-        int const N_polygon = int(current_polygon.size());
-
-        for(int k=0; k<N_polygon-2; ++k) {
-            // triangulation
-            int3 const& f0 = current_polygon[0];
-            int3 const& f1 = current_polygon[k+1];
-            int3 const& f2 = current_polygon[k+2];
-
-            faces_triangulation.push_back({f0,f1,f2});
-        }
-    }
-    return faces_triangulation;
-}
-
-std::pair<mesh, std::map<int3, int, comparator_int3>>
-    make_unique_parameter_per_value(numarray<vec3> const& positions,
-                                    numarray<vec2> const& texture_uv,
-                                    numarray<vec3> const& normals,
-                                    numarray<numarray_stack<int3,3>> const& faces,
-                                    loader::obj_type const type)
+mesh make_unique_parameter_per_value(numarray<vec3> const& positions,
+                                     numarray<vec2> const& texture_uv,
+                                     numarray<vec3> const& normals,
+                                     numarray<numarray_stack<int3,3>> const& faces,
+                                     loader::obj_type const type,
+                                     std::vector<int3>& vertex_index)
 {
     mesh m;
-    comparator_int3 comparator(int(positions.size()));
-    std::map<int3, int, comparator_int3> connectivity_map(comparator); // stores map between original face index and final offset
+    size_t const N_triangle = faces.size();
 
+    bool const use_texture = type==loader::obj_type::vertex_texture_normal || type==loader::obj_type::vertex_texture;
+    bool const use_normal = type==loader::obj_type::vertex_texture_normal || type==loader::obj_type::vertex_normal;
+
+    // At most 3 distinct vertices per triangle
+    hash_table_int3 connectivity_map(3*N_triangle); // stores map between original face index and final offset
+    vertex_index.clear();
+    vertex_index.reserve(std::min(3*N_triangle, 2*size_t(positions.size())));
+    m.connectivity.resize(N_triangle);
 
-    size_t const N_triangle = faces.size();
     for(size_t k_triangle=0; k_triangle<N_triangle; ++k_triangle)
     {
-        numarray_stack<int3,3> const& tri = faces[k_triangle];
-        uint3 new_triangle_index;
+        numarray_stack<int3,3> const& tri = faces.at(k_triangle);
+        uint3& new_triangle_index = m.connectivity.at(k_triangle);
         for(int k=0; k<3; ++k)
         {
             int3 const& index = tri[k];
-            auto const it = connectivity_map.find( index );
-            if( it==connectivity_map.end() ) {
-
-                size_t const offset = m.position.size();
-                connectivity_map[index] = int(offset);
-                new_triangle_index[k] = int(offset);
+            int const offset = int(vertex_index.size());
+            int const value = connectivity_map.find_or_insert(index, offset);
+            new_triangle_index[k] = value;
 
+            if(value == offset) { // new vertex
+                vertex_index.push_back(index);
                 int const idx_position = index[0];
 
                 assert_cgp_no_msg( idx_position<int(positions.size()));
                 m.position.push_back( positions[idx_position] );
 
-                if(type==loader::obj_type::vertex_texture_normal || type==loader::obj_type::vertex_texture) {
+                if(use_texture) {
                     int const idx_uv = index[1];
                     assert_cgp_no_msg( idx_uv<int(texture_uv.size()) );
                     m.uv.push_back( texture_uv[ idx_uv ] );
                 }
-                if(type==loader::obj_type::vertex_texture_normal || type==loader::obj_type::vertex_normal) {
+                if(use_normal) {
                     int const idx_normal = index[2];
                     assert_cgp_no_msg( idx_normal<int(normals.size()) );
                     m.normal.push_back( normals[idx_normal] );
                 }
-
             }
-            else
-                new_triangle_index[k] = it->second;
         }
-        m.connectivity.push_back(new_triangle_index);
     }
 
-    return {m, connectivity_map};
+    return m;
 }
 
 
@@ -419,6 +461,269 @@ numarray<numarray<int3>> obj_read_faces(const std::string& filename, obj_type co
 }
 
 
+// Single pass parser
+// ***************************************************** //
+
+static bool obj_is_space(char c)
+{
+    return c==' ' || c=='\t' || c=='\r' || c=='\v' || c=='\f';
+}
+static bool obj_is_delimiter(char const* it, char const* end)
+{
+    return it==end || obj_is_space(*it) || *it=='\n' || *it=='/';
+}
+static char const* obj_skip_spaces(char const* it, char const* end)
+{
+    while(it<end && obj_is_space(*it))
+        ++it;
+    return it;
+}
+static char const* obj_skip_line(char const* it, char const* end)
+{
+    while(it<end && *it!='\n')
+        ++it;
+    return it<end? it+1 : end;
+}
+
+// Fallback parsing of a float by the standard library (copy of the token, as the mapped file isn't null terminated)
+static bool obj_parse_float_strtof(char const*& it, char const* end, float& value)
+{
+    char token[64];
+    int N = 0;
+    while(it+N<end && N<63 && !obj_is_space(it[N]) && it[N]!='\n')
+    {
+        token[N] = it[N];
+        ++N;
+    }
+    token[N] = '\0';
+
+    char* token_end = nullptr;
+    errno = 0;
+    float v = std::strtof(token, &token_end);
+    if(token_end==token)
+        return false;
+    if(errno==ERANGE && std::isinf(v))
+        v = std::copysign(std::numeric_limits<float>::max(), v); // same as stream >> float on overflow
+    value = v;
+    it += (token_end-token);
+    return true;
+}
+
+//  Fast path for the common decimal notation (exact conversion with at most 19 significant digits and 10^22 exponent,
+//  which is then correctly rounded to float unless it falls exactly in the middle of two floats); strtof otherwise.
+bool obj_parse_float(char const*& it, char const* end, float& value)
+{
+    static double const power_of_ten[] = {1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22};
+
+    char const* p = it;
+    bool negative = false;
+    if(p<end && (*p=='-' || *p=='+')) {
+        negative = (*p=='-');
+        ++p;
+    }
+
+    uint64_t mantissa = 0;
+    int significant_digits = 0;
+    int exponent = 0;
+    bool has_digits = false;
+    while(p<end && *p>='0' && *p<='9') {
+        if(mantissa>0 || *p!='0') {
+            mantissa = 10*mantissa + uint64_t(*p-'0');
+            significant_digits++;
+        }
+        has_digits = true;
+        ++p;
+    }
+    if(p<end && *p=='.') {
+        ++p;
+        while(p<end && *p>='0' && *p<='9') {
+            if(mantissa>0 || *p!='0') {
+                mantissa = 10*mantissa + uint64_t(*p-'0');
+                significant_digits++;
+            }
+            exponent--;
+            has_digits = true;
+            ++p;
+        }
+    }
+    if(has_digits && p<end && (*p=='e' || *p=='E')) {
+        char const* q = p+1;
+        bool negative_exponent = false;
+        if(q<end && (*q=='-' || *q=='+')) {
+            negative_exponent = (*q=='-');
+            ++q;
+        }
+        if(q<end && *q>='0' && *q<='9') {
+            int e = 0;
+            while(q<end && *q>='0' && *q<='9') {
+                if(e<100000)
+                    e = 10*e + (*q-'0');
+                ++q;
+            }
+            exponent += negative_exponent? -e : e;
+            p = q;
+        }
+    }
+
+    if(!has_digits || !obj_is_delimiter(p,end) || significant_digits>19 || mantissa>(uint64_t(1)<<53) || exponent<-22 || exponent>22)
+        return obj_parse_float_strtof(it, end, value);
+
+    double d = double(mantissa);
+    d = exponent<0? d/power_of_ten[-exponent] : d*power_of_ten[exponent];
+
+    // Double rounding (decimal->double->float) may differ from a direct rounding only on float midpoints, or out of the normal float range
+    uint64_t bits;
+    std::memcpy(&bits, &d, sizeof(double));
+    bool const midpoint = (bits & 0x1FFFFFFF) == 0x10000000;
+    if(midpoint || (d!=0 && (d<std::numeric_limits<float>::min() || d>std::numeric_limits<float>::max())))
+        return obj_parse_float_strtof(it, end, value);
+
+    value = negative? -float(d) : float(d);
+    it = p;
+    return true;
+}
+
+// Parse an integer in [it,end[ and move it after the integer
+static bool obj_parse_int(char const*& it, char const* end, int& value)
+{
+    char const* p = it;
+    bool negative = false;
+    if(p<end && (*p=='-' || *p=='+')) {
+        negative = (*p=='-');
+        ++p;
+    }
+    if(p==end || *p<'0' || *p>'9')
+        return false;
+
+    long long v = 0;
+    while(p<end && *p>='0' && *p<='9') {
+        v = 10*v + (*p-'0');
+        if(v>std::numeric_limits<int>::max())
+            v = std::numeric_limits<int>::max();
+        ++p;
+    }
+    value = negative? -int(v) : int(v);
+    it = p;
+    return true;
+}
+
+// Parse a vertex of a face "p", "p/t", "p//n" or "p/t/n" (indices starting at 1, negative relative indices)
+//  Returns the 0-based indices, with -1 for missing elements
+static int3 obj_parse_face_vertex(char const*& it, char const* end, int const count[3])
+{
+    int3 index = {0,0,0};
+    for(int k=0; k<3; ++k)
+    {
+        if(k>0) {
+            if(it==end || *it!='/')
+                break;
+            ++it;
+        }
+        obj_parse_int(it, end, index[k]);
+    }
+    // Skip the rest of the token if it was malformed
+    while(it<end && !obj_is_space(*it) && *it!='\n')
+        ++it;
+
+    for(int k=0; k<3; ++k) {
+        if(index[k]<0)
+            index[k] = count[k] + index[k]; // relative to the last element read
+        else
+            index[k]--;                     // obj indices starts at 1
+    }
+    return index;
+}
+
+// The meshes loaded from this content are cached (see mesh_load_file_obj): changing the values read here requires to bump
+//  cgpmesh_version (cgpmesh.cpp) so that the existing .cgpmesh files are regenerated
+obj_content_structure obj_read_content(const std::string& filename)
+{
+    assert_file_exist(filename);
+    file_mapping_structure file;
+    file.open(filename);
+
+    return obj_read_content(file.data, file.size);
+}
+
+obj_content_structure obj_read_content(char const* data, size_t size)
+{
+    obj_content_structure content;
+    numarray<int3> polygon;
+
+    char const* it = data;
+    char const* const end = data + size;
+    while(it<end)
+    {
+        it = obj_skip_spaces(it, end);
+        char const* const word = it;
+        while(it<end && !obj_is_space(*it) && *it!='\n')
+            ++it;
+        size_t const word_size = it-word;
+
+        if(word_size==1 && word[0]=='v') {
+            vec3 p;
+            for(int k=0; k<3; ++k) {
+                it = obj_skip_spaces(it, end);
+                obj_parse_float(it, end, p[k]);
+            }
+            content.position.push_back(p);
+        }
+        else if(word_size==2 && word[0]=='v' && word[1]=='t') {
+            vec2 uv;
+            for(int k=0; k<2; ++k) {
+                it = obj_skip_spaces(it, end);
+                obj_parse_float(it, end, uv[k]);
+            }
+            content.texture_uv.push_back(uv);
+        }
+        else if(word_size==2 && word[0]=='v' && word[1]=='n') {
+            vec3 n;
+            for(int k=0; k<3; ++k) {
+                it = obj_skip_spaces(it, end);
+                obj_parse_float(it, end, n[k]);
+            }
+            content.normal.push_back(n);
+        }
+        else if(word_size==1 && word[0]=='f') {
+            int const count[3] = {int(content.position.size()), int(content.texture_uv.size()), int(content.normal.size())};
+            polygon.clear();
+            while(true) {
+                it = obj_skip_spaces(it, end);
+                if(it==end || *it=='\n')
+                    break;
+                polygon.push_back(obj_parse_face_vertex(it, end, count));
+            }
+            for(int k=0; k+2<int(polygon.size()); ++k)
+                content.triangles.push_back({polygon[0], polygon[k+1], polygon[k+2]});
+        }
+
+        it = obj_skip_line(it, end);
+    }
+
+    // set obj type
+    if(content.texture_uv.size()>0 && content.normal.size()>0)
+        content.type = obj_type::vertex_texture_normal;
+    else if(content.texture_uv.size()>0)
+        content.type = obj_type::vertex_texture;
+    else if(content.normal.size()>0)
+        content.type = obj_type::vertex_normal;
+
+    // Only the indices of the elements present in the file are used
+    bool const use_texture = content.type==obj_type::vertex_texture || content.type==obj_type::vertex_texture_normal;
+    bool const use_normal = content.type==obj_type::vertex_normal || content.type==obj_type::vertex_texture_normal;
+    if(!use_texture || !use_normal) {
+        for(auto& triangle : content.triangles) {
+            for(int k=0; k<3; ++k) {
+                if(!use_texture) triangle[k][1] = -1;
+                if(!use_normal) triangle[k][2] = -1;
+            }
+        }
+    }
+
+    return content;
+}
+
+
 }
 
 }
@@ -18,12 +18,15 @@ namespace cgp
     *  - .mtl files are not read with this loader (cannot read shading and color)
     *  - Only one mesh is loaded - this parser cannot be used when multiple textures are associated to different objects
     *  - The mesh is triangulated if higher degree polygons are in the file
+    *  - The loaded mesh is cached in the binary file filename.cgpmesh, which is reused while the content of the .obj is unchanged (see CGP_NO_MESH_CACHE)
     */
     mesh mesh_load_file_obj(std::string const& filename);
 
     /** Load a mesh stored as .obj in the filename. 
     * Outputs the correspondance between the vertex index in the file, and the loaded one */
     mesh mesh_load_file_obj(std::string const& filename, numarray<numarray<int>>& vertex_correspondance);
+    /** Same as above, the correspondance isn't computed if vertex_correspondance is nullptr */
+    mesh mesh_load_file_obj(std::string const& filename, numarray<numarray<int>>* vertex_correspondance);
 
 
 
@@ -55,6 +58,25 @@ namespace loader{
     */
 
     numarray<numarray<int3>> obj_read_faces(const std::string& filename, obj_type const type);
+
+    /** Content of an obj file read in a single pass (used by mesh_load_file_obj) */
+    struct obj_content_structure {
+        numarray<vec3> position;
+        numarray<vec2> texture_uv;
+        numarray<vec3> normal;
+        numarray<numarray_stack<int3,3>> triangles; // faces triangulated as a fan, index of position/texture/normal (-1 if not used by the type)
+        obj_type type = obj_type::vertex;
+    };
+
+    /** Read positions, uv, normals and faces of an obj file in a single pass over the memory-mapped file
+     *  Same values as the individual obj_read_xxx functions (floats are parsed with correct rounding) */
+    obj_content_structure obj_read_content(const std::string& filename);
+    /** Same as above on the content of an obj file already in memory (data doesn't need to be null terminated) */
+    obj_content_structure obj_read_content(char const* data, size_t size);
+
+    /** Parse a float in [it,end[ and move it after the float - the value is the one given by strtof (correct rounding)
+     *  Returns false if [it,end[ doesn't start with a float */
+    bool obj_parse_float(char const*& it, char const* end, float& value);
 }
 
 
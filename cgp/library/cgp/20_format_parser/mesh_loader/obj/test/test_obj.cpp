@@ -0,0 +1,100 @@
+#include "cgp/20_format_parser/mesh_loader/obj/obj.hpp"
+#include "cgp/01_base/base.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#if defined(__linux__) || defined(__EMSCRIPTEN__)
+#pragma GCC diagnostic ignored "-Wunused-variable"
+#endif
+
+namespace cgp_test
+{
+	// Same bits as strtof (distinguishes -0 and 0), and the whole token is read
+	static bool is_parsed_as_strtof(std::string const& token)
+	{
+		char const* it = token.data();
+		char const* const end = token.data() + token.size();
+		float value = 0;
+		if (!cgp::loader::obj_parse_float(it, end, value) || it != end)
+			return false;
+
+		float const expected = std::strtof(token.c_str(), nullptr);
+		return std::memcmp(&value, &expected, sizeof(float)) == 0;
+	}
+
+	static bool is_equal_index(cgp::int3 const& a, int p, int t, int n)
+	{
+		return a.x == p && a.y == t && a.z == n;
+	}
+
+	void test_obj()
+	{
+		// Floats: same value as strtof
+		{
+			char const* tokens[] = {
+				"0", "-0", "+0.0", "1", "-1", "+1.5", ".5", "5.", "-.25e2", "0.1", "0.000001", "3.14159265358979",
+				"1e10", "1E-5", "2.5e+3", "-7.038531e-26", "1e22", "1e23", "3.4028234e38", "1.17549435e-38",
+				"123456789", "1.0000001", "0.30000000000000004", "123456789012345678901234", "0.1234567890123456789012",
+				"1e-40", "-2.5e-39", "1.4e-45", "1e-50",                                    // denormals and underflow
+				"16777217", "16777219", "1.00000005960464477539062500", "1.000000059604644775390625001", // midpoints of two floats
+				"0.500000029802322387695312500"
+			};
+			for (char const* token : tokens)
+				assert_cgp(is_parsed_as_strtof(token), std::string("obj_parse_float differs from strtof on ") + token);
+
+			// The parsing stops before the next element, and fails without a number
+			std::string const text = "-1.25e1 2/3";
+			char const* it = text.data();
+			float value = 0;
+			assert_cgp_no_msg(cgp::loader::obj_parse_float(it, text.data() + text.size(), value));
+			assert_cgp_no_msg(value == -12.5f && *it == ' ');
+
+			std::string const not_a_number = "abc";
+			it = not_a_number.data();
+			assert_cgp_no_msg(!cgp::loader::obj_parse_float(it, not_a_number.data() + not_a_number.size(), value));
+			assert_cgp_no_msg(it == not_a_number.data());
+		}
+
+		// In-memory file with uv, normals, a quad, negative (relative) indices and \r\n line endings
+		{
+			std::string const text =
+				"# square\n"
+				"v 0 0 0\n"
+				"v 1 0 0\r\n"
+				"v 1 1 0\n"
+				"v 0 1 0.5\n"
+				"vt 0 0\n"
+				"vt 1 0\n"
+				"vt 1 1\n"
+				"vt 0 1\n"
+				"vn 0 0 1\n"
+				"f 1/1/1 2/2/1 3/3/1 4/4/1\n"
+				"f -4/-4/-1 -2/-2/-1 -1/-1/-1"; // no final end of line
+
+			cgp::loader::obj_content_structure const content = cgp::loader::obj_read_content(text.data(), text.size());
+			assert_cgp_no_msg(content.type == cgp::loader::obj_type::vertex_texture_normal);
+			assert_cgp_no_msg(content.position.size() == 4 && content.texture_uv.size() == 4 && content.normal.size() == 1);
+			assert_cgp_no_msg(content.position[1].x == 1.0f && content.position[3].z == 0.5f);
+			assert_cgp_no_msg(content.texture_uv[2].x == 1.0f && content.texture_uv[2].y == 1.0f);
+			assert_cgp_no_msg(content.normal[0].z == 1.0f);
+
+			// The quad is triangulated as a fan, the last face uses the vertices 0, 2 and 3
+			assert_cgp_no_msg(content.triangles.size() == 3);
+			assert_cgp_no_msg(is_equal_index(content.triangles[0][0], 0, 0, 0) && is_equal_index(content.triangles[0][1], 1, 1, 0) && is_equal_index(content.triangles[0][2], 2, 2, 0));
+			assert_cgp_no_msg(is_equal_index(content.triangles[1][0], 0, 0, 0) && is_equal_index(content.triangles[1][1], 2, 2, 0) && is_equal_index(content.triangles[1][2], 3, 3, 0));
+			assert_cgp_no_msg(is_equal_index(content.triangles[2][0], 0, 0, 0) && is_equal_index(content.triangles[2][1], 2, 2, 0) && is_equal_index(content.triangles[2][2], 3, 3, 0));
+		}
+
+		// Positions only: the uv and normal indices are -1
+		{
+			std::string const text = "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\nf -3 -2 -1\n";
+			cgp::loader::obj_content_structure const content = cgp::loader::obj_read_content(text.data(), text.size());
+			assert_cgp_no_msg(content.type == cgp::loader::obj_type::vertex);
+			assert_cgp_no_msg(content.triangles.size() == 2);
+			for (int k = 0; k < 2; ++k)
+				assert_cgp_no_msg(is_equal_index(content.triangles[k][0], 0, -1, -1) && is_equal_index(content.triangles[k][1], 1, -1, -1) && is_equal_index(content.triangles[k][2], 2, -1, -1));
+		}
+	}
+}
@@ -13,6 +13,40 @@
 
 
 
+// *************************************************************** //
+// OPENGL ERROR CHECK
+//
+// The OpenGL errors are checked according to a mode selectable at runtime (see opengl_check_set_mode):
+//   off, sampled once per frame, after each call (default), or with the KHR_debug callback.
+//   The default mode is sampled when CGP_NO_DEBUG is defined.
+// Uncomment the following definition to remove the per call checks at compilation
+// *************************************************************** //
+// #define CGP_NO_OPENGL_CHECK
+
+
+
+// *************************************************************** //
+// MESH CACHE
+//
+// mesh_load_file_obj(filename) stores the loaded mesh in a binary file filename.cgpmesh
+//   next to the .obj, and reloads it directly as long as the content of the .obj is unchanged.
+// Uncomment the following definition to always parse the .obj files
+// *************************************************************** //
+// #define CGP_NO_MESH_CACHE
+
+
+
+// *************************************************************** //
+// TEXTURE COMPRESSION CACHE
+//
+// image_load_file_compressed(filename) stores the compressed image and its mipmap levels in a binary
+//   file filename.cgptex next to the image, and reloads it directly as long as the image is unchanged.
+// Uncomment the following definition to compress the images at each loading
+// *************************************************************** //
+// #define CGP_NO_TEXTURE_CACHE
+
+
+
 // *************************************************************** //
 // OpenGL Version
 // *************************************************************** //
@@ -0,0 +1,55 @@
+#version 330 core
+
+// Vertex shader - same as mesh.vert.glsl, with an additional model matrix per instance
+
+// Inputs coming from VBOs
+layout (location = 0) in vec3 vertex_position; // vertex position in local space (x,y,z)
+layout (location = 1) in vec3 vertex_normal;   // vertex normal in local space   (nx,ny,nz)
+layout (location = 2) in vec3 vertex_color;    // vertex color      (r,g,b)
+layout (location = 3) in vec2 vertex_uv;       // vertex uv-texture (u,v)
+layout (location = 4) in mat4 instance_model;  // per-instance transform (locations 4 to 7, divisor=1) - received row by row
+
+// Output variables sent to the fragment shader
+out struct fragment_data
+{
+    vec3 position; // vertex position in world space
+    vec3 normal;   // normal position in world space
+    vec3 color;    // vertex color
+    vec2 uv;       // vertex uv
+} fragment;
+
+// Uniform variables expected to receive from the C++ program
+uniform mat4 model; // Model affine transform matrix associated to the current shape (applied before the instance transform)
+// Values shared by all the shaders and constant over the frame (sent once per frame by the environment)
+layout(std140) uniform environment_block {
+	mat4 projection;    // Projection (perspective or orthogonal) matrix of the camera
+	mat4 view;          // View matrix (rigid transform) of the camera
+	vec3 light;         // Position of the light
+	float time;         // Time in seconds
+	float water_length; // Size of the water surface
+};
+
+void main()
+{
+	// The matrices are stored row by row on the CPU side: transpose to get the instance transform
+	mat4 M = transpose(instance_model) * model;
+
+	// The position of the vertex in the world space
+	vec4 position = M * vec4(vertex_position, 1.0);
+
+	// The normal of the vertex in the world space
+	mat4 modelNormal = transpose(inverse(M));
+	vec4 normal = modelNormal * vec4(vertex_normal, 0.0);
+
+	// The projected position of the vertex in the normalized device coordinates:
+	vec4 position_projected = projection * view * position;
+
+	// Fill the parameters sent to the fragment shader
+	fragment.position = position.xyz;
+	fragment.normal   = normal.xyz;
+	fragment.color = vertex_color;
+	fragment.uv = vertex_uv;
+
+	// gl_Position is a built-in variable which is the expected output of the vertex shader
+	gl_Position = position_projected; // gl_Position is the projected vertex position (in normalized device coordinates)
+}
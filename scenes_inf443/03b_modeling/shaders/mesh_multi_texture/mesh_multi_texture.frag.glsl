@@ -31,10 +31,14 @@ layout(location=0) out vec4 FragColor;
 uniform sampler2D image_texture;   // Texture image identifiant
 uniform sampler2D image_texture_2;
 
-uniform mat4 view;       // View matrix (rigid transform) of the camera - to compute the camera position
-
-uniform vec3 light; // position of the light
-
+// Values shared by all the shaders and constant over the frame (sent once per frame by the environment)
+layout(std140) uniform environment_block {
+	mat4 projection;    // Projection (perspective or orthogonal) matrix of the camera
+	mat4 view;          // View matrix (rigid transform) of the camera
+	vec3 light;         // Position of the light
+	float time;         // Time in seconds
+	float water_length; // Size of the water surface
+};
 
 // Coefficients of phong illumination model
 struct phong_structure {
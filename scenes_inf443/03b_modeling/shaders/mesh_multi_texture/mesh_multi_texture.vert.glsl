@@ -19,11 +19,14 @@ out struct fragment_data
 
 // Uniform variables expected to receive from the C++ program
 uniform mat4 model; // Model affine transform matrix associated to the current shape
-uniform mat4 view;  // View matrix (rigid transform) of the camera
-uniform mat4 projection; // Projection (perspective or orthogonal) matrix of the camera
-
-
-
+// Values shared by all the shaders and constant over the frame (sent once per frame by the environment)
+layout(std140) uniform environment_block {
+	mat4 projection;    // Projection (perspective or orthogonal) matrix of the camera
+	mat4 view;          // View matrix (rigid transform) of the camera
+	vec3 light;         // Position of the light
+	float time;         // Time in seconds
+	float water_length; // Size of the water surface
+};
 
 void main()
 {
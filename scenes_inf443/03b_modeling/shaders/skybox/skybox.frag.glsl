@@ -7,7 +7,14 @@ in struct fragment_data {
 layout(location = 0) out vec4 FragColor;
 
 uniform samplerCube image_skybox;
-uniform float time;
+// Values shared by all the shaders and constant over the frame (sent once per frame by the environment)
+layout(std140) uniform environment_block {
+	mat4 projection;    // Projection (perspective or orthogonal) matrix of the camera
+	mat4 view;          // View matrix (rigid transform) of the camera
+	vec3 light;         // Position of the light
+	float time;         // Time in seconds
+	float water_length; // Size of the water surface
+};
 
 // Main Shader
 /***************************************************************************************************/
@@ -7,8 +7,14 @@ out struct fragment_data {
 } fragment;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// Values shared by all the shaders and constant over the frame (sent once per frame by the environment)
+layout(std140) uniform environment_block {
+	mat4 projection;    // Projection (perspective or orthogonal) matrix of the camera
+	mat4 view;          // View matrix (rigid transform) of the camera
+	vec3 light;         // Position of the light
+	float time;         // Time in seconds
+	float water_length; // Size of the water surface
+};
 
 void main() {
     fragment.position = position.xyz;
@@ -18,10 +18,14 @@ layout(location = 0) out vec4 FragColor;
 // ***************************************************** //
 
 uniform samplerCube image_skybox;   // Texture image identifier
-uniform float time;                 // Time value
-uniform vec3 light;
-uniform float water_length;
-uniform mat4 view;       // View matrix (rigid transform) of the camera - to compute the camera position
+// Values shared by all the shaders and constant over the frame (sent once per frame by the environment)
+layout(std140) uniform environment_block {
+	mat4 projection;    // Projection (perspective or orthogonal) matrix of the camera
+	mat4 view;          // View matrix (rigid transform) of the camera
+	vec3 light;         // Position of the light
+	float time;         // Time in seconds
+	float water_length; // Size of the water surface
+};
 
 void main() {
 
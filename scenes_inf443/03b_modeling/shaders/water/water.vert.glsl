@@ -7,6 +7,7 @@ layout(location = 0) in vec3 vertex_position; // vertex position in local space
 layout(location = 1) in vec3 vertex_normal;   // vertex normal in local space   (nx,ny,nz)
 layout(location = 2) in vec3 vertex_color;    // vertex color      (r,g,b)
 layout(location = 3) in vec2 vertex_uv;       // vertex uv-texture (u,v)
+layout(location = 4) in vec3 instance_offset; // per-instance offset of the water tile in world space (divisor=1)
 
 // Output variables sent to the fragment shader
 out struct fragment_data {
@@ -18,9 +19,14 @@ out struct fragment_data {
 
 // Uniform variables expected to receive from the C++ program
 uniform mat4 model; // Model affine transform matrix associated to the current shape
-uniform mat4 view;  // View matrix (rigid transform) of the camera
-uniform mat4 projection; // Projection (perspective or orthogonal) matrix of the camera
-uniform float time; // Time in seconds
+// Values shared by all the shaders and constant over the frame (sent once per frame by the environment)
+layout(std140) uniform environment_block {
+	mat4 projection;    // Projection (perspective or orthogonal) matrix of the camera
+	mat4 view;          // View matrix (rigid transform) of the camera
+	vec3 light;         // Position of the light
+	float time;         // Time in seconds
+	float water_length; // Size of the water surface
+};
 
 vec3 mod289(vec3 x) {
     return x - floor(x * (1.0 / 289.0)) * 289.0;
@@ -113,7 +119,7 @@ float pnoise(vec3 P, vec3 rep) {
 void main() {
     float pnoise_value = pnoise(vertex_position * 0.5 + 0.6 * time, vec3(5.0, 5.0, 5.0));
     vec3 new_position = vertex_position + vertex_normal * pnoise_value / 5.0;
-    vec4 position = model * vec4(new_position, 1.0);
+    vec4 position = model * vec4(new_position, 1.0) + vec4(instance_offset, 0.0);
 
     // Compute the normal for the new position with Perlin noise
     float pnoise_offset = pnoise(vertex_position + 0.6 * time + 0.1, vec3(5.0, 5.0, 5.0));
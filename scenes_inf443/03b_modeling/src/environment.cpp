@@ -25,11 +25,42 @@ cgp::vec3 environment_structure::get_camera_position() const
 	return -transpose(mat3(camera_view)) * last_col; // get the orientation matrix * last camera view column
 }
 
+void environment_structure::initialize_uniform_block()
+{
+	block_projection = uniform_block.add_member<mat4>("projection");
+	block_view = uniform_block.add_member<mat4>("view");
+	block_light = uniform_block.add_member<vec3>("light");
+	block_time = uniform_block.add_member<float>("time");
+	block_water_length = uniform_block.add_member<float>("water_length");
+	uniform_block.initialize_data_on_gpu("environment_block", 1);
+}
+
+void environment_structure::update_uniform_block()
+{
+	uniform_block.set(block_projection, camera_projection);
+	uniform_block.set(block_view, camera_view);
+	uniform_block.set(block_light, light_position);
+	uniform_block.set(block_time, time);
+	uniform_block.set(block_water_length, water_length);
+	uniform_block.update();
+}
+
 void environment_structure::send_opengl_uniform(opengl_shader_structure const &shader, bool expected) const
 {
-	opengl_uniform(shader, "projection", camera_projection, expected);
-	opengl_uniform(shader, "view", camera_view, expected);
-	opengl_uniform(shader, "light", light_position, false);
+	// Shaders using the uniform block already have the values of the frame
+	if (!uniform_block.use_in_shader(shader))
+	{
+		static opengl_uniform_handle const uniform_projection("projection");
+		static opengl_uniform_handle const uniform_view("view");
+		static opengl_uniform_handle const uniform_light("light");
+		static opengl_uniform_handle const uniform_time("time");
+		static opengl_uniform_handle const uniform_water_length("water_length");
+		opengl_uniform(shader, uniform_projection, camera_projection, expected);
+		opengl_uniform(shader, uniform_view, camera_view, expected);
+		opengl_uniform(shader, uniform_light, light_position, false);
+		opengl_uniform(shader, uniform_time, time, false);
+		opengl_uniform(shader, uniform_water_length, water_length, false);
+	}
 
 	uniform_generic.send_opengl_uniform(shader, false);
 }
\ No newline at end of file
@@ -24,6 +24,10 @@ struct environment_structure : environment_generic_structure
 	// The position of a light
 	vec3 light_position = {1, 1, 1};
 
+	// Time and size of the water used for the animated shaders
+	float time = 0.0f;
+	float water_length = 0.0f;
+
 	// Additional uniforms that can be attached to the environment if needed (empty by default)
 	uniform_generic_structure uniform_generic;
 
@@ -31,6 +35,15 @@ struct environment_structure : environment_generic_structure
 	//  The function is expected to send the uniform variables to the shader (e.g. camera, light)
 	void send_opengl_uniform(opengl_shader_structure const &shader, bool expected = true) const override;
 
+	// Declare the uniform block "environment_block" shared by the shaders (camera, light, time)
+	//  The shaders of the scene declare it as:
+	//    layout(std140) uniform environment_block { mat4 projection; mat4 view; vec3 light; float time; float water_length; };
+	void initialize_uniform_block();
+	// Copy the current values in the uniform block and send it - once per frame
+	void update_uniform_block() override;
+	// Index of the members in the uniform block
+	int block_projection = -1, block_view = -1, block_light = -1, block_time = -1, block_water_length = -1;
+
 	cgp::vec3 environment_structure::get_camera_position() const;
 };
 
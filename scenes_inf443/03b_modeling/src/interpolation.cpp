@@ -1,5 +1,7 @@
 #include "interpolation.hpp"
 
+#include <algorithm>
+
 using namespace cgp;
 
 /** Compute the linear interpolation p(t) between p1 at time t1 and p2 at time t2*/
@@ -9,7 +11,7 @@ vec3 linear_interpolation(float t, float t1, float t2, vec3 const &p1, vec3 cons
  *  - Assume t \in [t1,t2] */
 vec3 cardinal_spline_interpolation(float t, float t0, float t1, float t2, float t3, vec3 const &p0, vec3 const &p1, vec3 const &p2, vec3 const &p3, float K);
 
-/** Find the index k such that intervals[k] < t < intervals[k+1]
+/** Find the index k such that intervals[k] < t < intervals[k+1] (binary search)
  * - Assume intervals is a sorted array of N time values
  * - Assume t \in [ intervals[0], intervals[N-1] [       */
 int find_index_of_interval(float t, numarray<float> const &intervals);
@@ -76,31 +78,112 @@ vec3 cardinal_spline_interpolation(float t, float t0, float t1, float t2, float
 int find_index_of_interval(float t, numarray<float> const &intervals)
 {
     int const N = intervals.size();
-    bool error = false;
 
-    if (intervals.size() < 2)
-    {
-        std::cout << "Error: Intervals should have at least two values; current size=" << intervals.size() << std::endl;
-        error = true;
-    }
-    if (N > 0 && t < intervals[0])
-    {
-        std::cout << "Error: current time t is smaller than the first time of the interval" << std::endl;
-        error = true;
-    }
-    if (N > 0 && t > intervals[N - 1])
-    {
-        std::cout << "Error: current time t is greater than the last time of the interval" << std::endl;
-        error = true;
-    }
-    if (error == true)
+    // Only the diagnostic is expensive: it is built when t is out of the intervals
+    if (N < 2 || t < intervals.at(0) || t > intervals.at(N - 1))
     {
+        if (N < 2)
+            std::cout << "Error: Intervals should have at least two values; current size=" << intervals.size() << std::endl;
+        if (N > 0 && t < intervals[0])
+            std::cout << "Error: current time t is smaller than the first time of the interval" << std::endl;
+        if (N > 0 && t > intervals[N - 1])
+            std::cout << "Error: current time t is greater than the last time of the interval" << std::endl;
+
         std::string const error_str = "Error trying to find interval for t=" + str(t) + " within values: [" + str(intervals) + "]";
         error_cgp(error_str);
     }
 
-    int k = 0;
-    while (intervals[k + 1] < t)
-        ++k;
+    // First k such that t <= intervals[k+1]
+    int const k = int(std::lower_bound(intervals.data.begin() + 1, intervals.data.end(), t) - intervals.data.begin()) - 1;
     return k;
-}
\ No newline at end of file
+}
+
+void KeyframeTracks::initialize(int track_count, numarray<float> const& key_times)
+{
+    times = key_times;
+    positions.resize(track_count * int(times.size()));
+    cursor = 0;
+}
+
+int KeyframeTracks::track_count() const
+{
+    return times.size() == 0 ? 0 : int(positions.size() / times.size());
+}
+
+void KeyframeTracks::set_track(int track, numarray<vec3> const& key_positions)
+{
+    assert_cgp(key_positions.size() == times.size(), "Track should have one key position per key time");
+    for (int k = 0; k < int(times.size()); ++k)
+        position(track, k) = key_positions[k];
+}
+
+int KeyframeTracks::find_interval(float t) const
+{
+    return find_index_of_interval(t, times);
+}
+
+int KeyframeTracks::find_interval_cursor(float t)
+{
+    int const N = times.size();
+    if (t < times.at(cursor) || cursor >= N - 1)
+    {
+        // The time went backward (ex. looping animation)
+        cursor = find_interval(t);
+        return cursor;
+    }
+
+    while (cursor < N - 2 && times.at(cursor + 1) < t)
+        ++cursor;
+    return cursor;
+}
+
+int KeyframeTracks::spline_weights(float t, float w[4])
+{
+    int const N = times.size();
+    assert_cgp(N >= 4, "Cardinal spline needs at least 4 key frames");
+
+    // The spline segment [k, k+1] needs the key frames k-1 and k+2
+    int const k = std::min(std::max(find_interval_cursor(t), 1), N - 3);
+    float const t0 = times.at(k - 1), t1 = times.at(k), t2 = times.at(k + 1), t3 = times.at(k + 2);
+
+    // Same as cardinal_spline_interpolation, with the tangents expanded on the key positions
+    float const s = (t - t1) / (t2 - t1);
+    float const h00 = 2 * s * s * s - 3 * s * s + 1;
+    float const h10 = s * s * s - 2 * s * s + s;
+    float const h01 = -2 * s * s * s + 3 * s * s;
+    float const h11 = s * s * s - s * s;
+    float const c0 = 2 * K / (t2 - t0);
+    float const c1 = 2 * K / (t3 - t1);
+
+    w[0] = -h10 * c0;
+    w[1] = h00 - h11 * c1;
+    w[2] = h01 + h10 * c0;
+    w[3] = h11 * c1;
+    return k;
+}
+
+vec3 KeyframeTracks::evaluate(int track, float t)
+{
+    float w[4];
+    int const k = spline_weights(t, w);
+    return w[0] * position(track, k - 1) + w[1] * position(track, k) + w[2] * position(track, k + 1) + w[3] * position(track, k + 2);
+}
+
+void KeyframeTracks::evaluate(float t, numarray<vec3>& result)
+{
+    float w[4];
+    int const k = spline_weights(t, w);
+
+    int const N = times.size();
+    int const count = track_count();
+    result.resize(count);
+
+    vec3 const* p = positions.data.data() + (k - 1);
+    vec3* r = result.data.data();
+    #pragma omp parallel for schedule(static) if (count > 4096)
+    for (int track = 0; track < count; ++track)
+    {
+        vec3 const* q = p + track * N;
+        r[track] = w[0] * q[0] + w[1] * q[1] + w[2] * q[2] + w[3] * q[3];
+    }
+}
@@ -6,3 +6,38 @@
 // Compute the interpolated position p(t) given a time t and the set of key_positions and key_frame
 cgp::vec3 interpolation(float t, cgp::numarray<cgp::vec3> const& key_positions, cgp::numarray<float> const& key_times);
 
+// Set of animation tracks sharing the same key times (ex. a school of fish)
+//  - The key positions of all the tracks are stored contiguously: the k-th key position of a track is positions[track * N + k], with N = times.size()
+//  - The interval containing t is searched once for all the tracks: by binary search (O(log N)), or from the last
+//    interval found when the time only increases between two calls (O(1) amortized)
+//  - The positions are interpolated with a cardinal spline: t must be in [times[1], times[N-2]]
+struct KeyframeTracks
+{
+    cgp::numarray<float> times;
+    cgp::numarray<cgp::vec3> positions;
+    float K = 0.5f; // spline tension
+
+    // Set the key times and allocate the key positions of track_count tracks
+    void initialize(int track_count, cgp::numarray<float> const& key_times);
+    int track_count() const;
+
+    // Set all the key positions of one track (key_positions.size() == times.size())
+    void set_track(int track, cgp::numarray<cgp::vec3> const& key_positions);
+    cgp::vec3& position(int track, int k) { return positions.at(track * int(times.size()) + k); }
+    cgp::vec3 const& position(int track, int k) const { return positions.at(track * int(times.size()) + k); }
+
+    // Index k such that times[k] < t <= times[k+1]
+    int find_interval(float t) const;        // binary search
+    int find_interval_cursor(float t);       // start from the previous result, binary search if t went backward
+
+    // Interpolated position of one track at time t
+    cgp::vec3 evaluate(int track, float t);
+    // Interpolated positions of all the tracks at time t (result is resized to track_count())
+    void evaluate(float t, cgp::numarray<cgp::vec3>& result);
+
+private:
+    int cursor = 0;
+
+    // Index of the spline segment and weights of the 4 key positions [k-1, k, k+1, k+2] at time t
+    int spline_weights(float t, float w[4]);
+};
@@ -28,6 +28,7 @@ void animation_loop();
 void display_gui_default();
 
 timer_fps fps_record;
+timer_frame_pacing frame_pacing; // FPS limitation and fixed time step of the simulation
 
 int main(int, char* argv[])
 {
@@ -66,16 +67,15 @@ int main(int, char* argv[])
 	//  The following part is simply a loop that call the function "animation_loop"
 	//  (This call is different when we compile in standard mode with GLFW, than when we compile with emscripten to output the result in a webpage.)
 #ifndef __EMSCRIPTEN__
-    double lasttime = glfwGetTime();
 	// Default mode to run the animation/display loop with GLFW in C++
 	while (!glfwWindowShouldClose(scene.window.glfw_window)) {
 		// The real animation loop
 		animation_loop();
 
-		// FPS limitation
+		// FPS limitation (sleep until the end of the frame instead of busy waiting)
 		if(project::fps_limiting){
-			while (glfwGetTime() < lasttime + 1.0 / project::fps_max) {	}
-        	lasttime = glfwGetTime();
+			frame_pacing.wait(project::fps_max);
+			fps_record.add_wait_time(frame_pacing.sleep_time, frame_pacing.spin_time);
 		}
 	}
 #else
@@ -86,6 +86,7 @@ int main(int, char* argv[])
 	std::cout << "\nAnimation loop stopped" << std::endl;
 
 	// Cleanup
+	opengl_texture_loader().stop_workers(); // releases its pixel buffer while the context exists
 	cgp::imgui_cleanup();
 	glfwDestroyWindow(scene.window.glfw_window);
 	glfwTerminate();
@@ -108,6 +109,11 @@ void animation_loop()
 	glClear(GL_DEPTH_BUFFER_BIT);
 	glEnable(GL_DEPTH_TEST);
 
+	// Send the textures decoded in background since the last frame (within the per-frame upload budget)
+	opengl_texture_loader().upload();
+	// Send/remove the finer mipmap levels requested by the distance of the objects at the previous frame (within the memory budget)
+	opengl_texture_residency().update();
+
 	float const time_interval = fps_record.update();
 	if (fps_record.event) {
 		std::string const title = "CGP Display - " + str(fps_record.fps) + " fps";
@@ -120,6 +126,11 @@ void animation_loop()
 	scene.inputs.mouse.on_gui = ImGui::GetIO().WantCaptureMouse;
 	scene.inputs.time_interval = time_interval;
 
+	// Simulation with a fixed time step, independent of the frame rate
+	int const simulation_steps = frame_pacing.fixed_steps(time_interval);
+	for (int k = 0; k < simulation_steps; ++k)
+		scene.simulation_step(frame_pacing.fixed_dt);
+
 
 	// Display the ImGUI interface (button, sliders, etc)
 	display_gui_default();
@@ -137,6 +148,13 @@ void animation_loop()
 	imgui_render_frame(scene.window.glfw_window);
 	glfwSwapBuffers(scene.window.glfw_window);
 	glfwPollEvents();
+
+	// Release all the per-frame buffers at once
+	frame_arena().reset();
+	opengl_state().end_frame();
+	opengl_texture_loader().end_frame();
+	opengl_texture_residency().end_frame();
+	opengl_check_frame();
 }
 
 
@@ -295,6 +313,35 @@ void display_gui_default()
 		fps_txt += " [shift]";
 
 	ImGui::Text( fps_txt.c_str(), "%s" );
+	if(ImGui::CollapsingHeader("Frame timing")) {
+		ImGui::Text("Frame: %.2f ms (jitter %.2f ms, max %.2f ms)", 1000*fps_record.frame_time_average, 1000*fps_record.frame_time_jitter, 1000*fps_record.frame_time_max);
+		ImGui::Text("Limiter: %.0f%% sleep, %.1f%% spin", 100*fps_record.sleep_ratio, 100*fps_record.spin_ratio);
+		memory_arena_structure::counters_structure const& arena = frame_arena().counters_previous;
+		ImGui::Text("Frame arena: %.1f KB in %d allocations (peak %.1f KB)", arena.bytes/1024.0f, int(arena.allocations), frame_arena().peak_bytes/1024.0f);
+		ImGui::Text("Frame arena heap: %d allocations, %.1f KB", int(arena.heap_allocations), arena.heap_bytes/1024.0f);
+		opengl_state_structure::counters_structure const& state = opengl_state().counters_previous;
+		ImGui::Text("Program binds: %d (%d avoided)", int(state.program_binds), int(state.program_binds_avoided));
+		ImGui::Text("Texture binds: %d (%d avoided)", int(state.texture_binds), int(state.texture_binds_avoided));
+		ImGui::Text("VAO binds: %d (%d avoided)", int(state.vertex_array_binds), int(state.vertex_array_binds_avoided));
+		opengl_texture_loader_structure::counters_structure const& loader = opengl_texture_loader().counters_previous;
+		ImGui::Text("Texture uploads: %d (%.1f KB, %.2f ms), %d pending", int(loader.textures_uploaded), loader.bytes_uploaded/1024.0f, loader.upload_time_ms, opengl_texture_loader().pending_count());
+		ImGui::Text("Shared textures: %d (%.1f MB resident)", opengl_texture_registry().size(), opengl_texture_registry().resident_bytes()/(1024.0f*1024.0f));
+		opengl_texture_residency_structure::counters_structure const& residency = opengl_texture_residency().counters_previous;
+		ImGui::Text("Streamed mipmaps: %.1f / %.1f MB, %d levels sent, %d evicted (%.2f ms)", opengl_texture_residency().resident_bytes()/(1024.0f*1024.0f), opengl_texture_residency().budget_bytes/(1024.0f*1024.0f), int(residency.levels_uploaded), int(residency.levels_evicted), residency.upload_time_ms);
+
+		// OpenGL error checks (each glGetError of the per call mode synchronizes with the driver)
+		opengl_check_mode const check_mode = opengl_check_get_mode();
+		if (ImGui::BeginCombo("OpenGL checks", opengl_check_mode_name(check_mode))) {
+			opengl_check_mode const modes[] = { opengl_check_mode::off, opengl_check_mode::sampled, opengl_check_mode::per_call, opengl_check_mode::debug_output };
+			for (opengl_check_mode mode : modes) {
+				if (mode == opengl_check_mode::debug_output && !opengl_check_debug_output_available())
+					continue;
+				if (ImGui::Selectable(opengl_check_mode_name(mode), mode == check_mode))
+					opengl_check_set_mode(mode);
+			}
+			ImGui::EndCombo();
+		}
+	}
 	if(ImGui::CollapsingHeader("Window")) {
 		ImGui::Indent();
 #ifndef __EMSCRIPTEN__
@@ -0,0 +1,127 @@
+#include "obstacle_grid.hpp"
+
+#include <algorithm>
+
+using namespace cgp;
+
+void ObstacleGrid::clear()
+{
+    obstacles.clear();
+    free_entries.clear();
+    owner_entries.clear();
+    cells.clear();
+    max_radius = 0.0f;
+    obstacles_count = 0;
+}
+
+void ObstacleGrid::set_owner_obstacles(int owner, std::vector<Obstacle> const& new_obstacles)
+{
+    remove_owner_obstacles(owner);
+    if (owner >= int(owner_entries.size()))
+        owner_entries.resize(owner + 1);
+
+    std::vector<int>& entries = owner_entries[owner];
+    for (Obstacle const& obstacle : new_obstacles)
+    {
+        int entry;
+        if (free_entries.empty())
+        {
+            entry = int(obstacles.size());
+            obstacles.push_back(obstacle);
+        }
+        else
+        {
+            entry = free_entries.back();
+            free_entries.pop_back();
+            obstacles[entry] = obstacle;
+        }
+        obstacles[entry].owner = owner;
+        max_radius = std::max(max_radius, obstacle.radius);
+
+        entries.push_back(entry);
+        insert_in_cell(entry);
+    }
+    obstacles_count += int(new_obstacles.size());
+}
+
+void ObstacleGrid::remove_owner_obstacles(int owner)
+{
+    if (owner >= int(owner_entries.size()))
+        return;
+
+    std::vector<int>& entries = owner_entries[owner];
+    for (int entry : entries)
+    {
+        remove_from_cell(entry);
+        free_entries.push_back(entry);
+    }
+    obstacles_count -= int(entries.size());
+    entries.clear();
+}
+
+void ObstacleGrid::translate_owner_obstacles(int owner, vec2 const& translation)
+{
+    if (owner >= int(owner_entries.size()))
+        return;
+
+    for (int entry : owner_entries[owner])
+    {
+        remove_from_cell(entry);
+        obstacles[entry].position += translation;
+        insert_in_cell(entry);
+    }
+}
+
+void ObstacleGrid::resolve_collisions(vec3& vessel_position, float vessel_radius, float moveback) const
+{
+    // The candidates are gathered around the initial position, with a margin for the correction of one obstacle
+    vec2 const p = {vessel_position.x, vessel_position.y};
+    for_each_candidate(p, vessel_radius + moveback, [&](Obstacle const& obstacle)
+    {
+        float const distX = vessel_position.x - obstacle.position.x;
+        float const distY = vessel_position.y - obstacle.position.y;
+        float const d = vessel_radius + obstacle.radius;
+        if (distX * distX + distY * distY >= d * d)
+            return;
+
+        // Apply a simple correction by moving the vessel away from the obstacle
+        if (std::abs(distX) > std::abs(distY))
+            vessel_position.x += (distX > 0) ? moveback : -moveback;
+        else
+            vessel_position.y += (distY > 0) ? moveback : -moveback;
+    });
+}
+
+void ObstacleGrid::resolve_collisions(numarray<vec3>& vessel_positions, float vessel_radius, float moveback) const
+{
+    int const N = int(vessel_positions.size());
+    #pragma omp parallel for schedule(static) if (N > 64)
+    for (int k = 0; k < N; ++k)
+        resolve_collisions(vessel_positions.at(k), vessel_radius, moveback);
+}
+
+void ObstacleGrid::insert_in_cell(int entry)
+{
+    vec2 const& p = obstacles[entry].position;
+    cells[key(cell_coordinate(p.x), cell_coordinate(p.y))].push_back(entry);
+}
+
+void ObstacleGrid::remove_from_cell(int entry)
+{
+    vec2 const& p = obstacles[entry].position;
+    auto it = cells.find(key(cell_coordinate(p.x), cell_coordinate(p.y)));
+    if (it == cells.end())
+        return;
+
+    // Order inside a cell doesn't matter: swap with the last one
+    std::vector<int>& cell = it->second;
+    auto const position = std::find(cell.begin(), cell.end(), entry);
+    if (position != cell.end())
+    {
+        *position = cell.back();
+        cell.pop_back();
+    }
+    // The tiles move to new cells as the boat travels: an emptied cell is removed so that the table doesn't grow with the distance
+    if (cell.empty())
+        cells.erase(it);
+}
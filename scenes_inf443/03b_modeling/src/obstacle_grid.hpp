@@ -0,0 +1,94 @@
+#pragma once
+
+#include "cgp/cgp.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+
+// Static obstacle of the scene (rock or house), seen from above as a disc
+struct Obstacle
+{
+    cgp::vec2 position;
+    float radius; // collision distance to the center of the obstacle
+    int owner;    // group of obstacles it belongs to (terrain tile slot) - used to remove them all at once
+};
+
+// Uniform grid (spatial hash) over the obstacles.
+//  Each obstacle is stored in the cell containing its center, the cells are stored in a hash table so that the
+//  grid is unbounded. As the cell size is larger than the diameter of any obstacle, a query of radius r around a point
+//  only visits the few cells overlapping the disc of radius r + max_radius: O(1) expected per query.
+//  The obstacles are inserted/removed per owner, so that a recycled tile only updates its own obstacles.
+struct ObstacleGrid
+{
+    // Size of a cell - must be set before the first insertion
+    float cell_size = 40.0f;
+
+    // Remove all the obstacles
+    void clear();
+
+    // Replace all the obstacles of an owner by new ones (the owner field of the obstacles is overwritten)
+    void set_owner_obstacles(int owner, std::vector<Obstacle> const& obstacles);
+    // Remove all the obstacles of an owner
+    void remove_owner_obstacles(int owner);
+    // Move all the obstacles of an owner by the same translation
+    void translate_owner_obstacles(int owner, cgp::vec2 const& translation);
+
+    // Call f(Obstacle const&) for each obstacle such that the disc (p, radius) intersects the obstacle disc
+    template <typename F> void for_each_colliding(cgp::vec2 const& p, float radius, F f) const;
+    // Call f(Obstacle const&) for each obstacle stored in the cells that may intersect the disc (p, radius) - no distance test
+    template <typename F> void for_each_candidate(cgp::vec2 const& p, float radius, F f) const;
+
+    // Push the vessels out of the obstacles they collide with, by a step of moveback along the main axis of separation
+    //  Each obstacle is tested with the position already corrected by the previous ones.
+    //  The vessels are independent: they are processed in parallel.
+    void resolve_collisions(cgp::vec3& vessel_position, float vessel_radius, float moveback) const;
+    void resolve_collisions(cgp::numarray<cgp::vec3>& vessel_positions, float vessel_radius, float moveback) const;
+
+    int size() const { return obstacles_count; }
+
+private:
+    typedef uint64_t cell_key;
+
+    std::vector<Obstacle> obstacles;               // storage of the obstacles (entries of removed obstacles are reused)
+    std::vector<int> free_entries;                 // unused indices in obstacles
+    std::vector<std::vector<int>> owner_entries;   // indices of the obstacles of each owner
+    std::unordered_map<cell_key, std::vector<int>> cells; // indices of the obstacles whose center is in the cell (non-empty cells only)
+    float max_radius = 0.0f;
+    int obstacles_count = 0;
+
+    int cell_coordinate(float x) const { return int(std::floor(x / cell_size)); }
+    static cell_key key(int i, int j) { return cell_key(uint32_t(i)) << 32 | uint32_t(j); }
+
+    void insert_in_cell(int entry);
+    void remove_from_cell(int entry);
+};
+
+template <typename F> void ObstacleGrid::for_each_colliding(cgp::vec2 const& p, float radius, F f) const
+{
+    for_each_candidate(p, radius, [&](Obstacle const& obstacle)
+    {
+        float const d = radius + obstacle.radius;
+        float const dx = p.x - obstacle.position.x;
+        float const dy = p.y - obstacle.position.y;
+        if (dx * dx + dy * dy < d * d)
+            f(obstacle);
+    });
+}
+
+template <typename F> void ObstacleGrid::for_each_candidate(cgp::vec2 const& p, float radius, F f) const
+{
+    float const r = radius + max_radius;
+    int const i0 = cell_coordinate(p.x - r), i1 = cell_coordinate(p.x + r);
+    int const j0 = cell_coordinate(p.y - r), j1 = cell_coordinate(p.y + r);
+    for (int i = i0; i <= i1; ++i)
+    {
+        for (int j = j0; j <= j1; ++j)
+        {
+            auto const it = cells.find(key(i, j));
+            if (it == cells.end())
+                continue;
+            for (int entry : it->second)
+                f(obstacles[entry]);
+        }
+    }
+}
@@ -28,20 +28,22 @@ void scene_structure::initialize()
 	// Load skybox
 	// ***************************************** //
 	image_structure image_skybox_template = image_load_file("assets/skybox/hdr_01.png"); // hdr_01.png OR skybox_01.jpg
-	std::vector<image_structure> image_grid = image_split_grid(image_skybox_template, 4, 3);
+	// Views on the faces of the template: each face is copied only once, already oriented
+	std::vector<image_view_structure> const image_grid = image_split_grid_view(image_skybox_template, 4, 3);
 	skybox.initialize_data_on_gpu();
 	skybox.texture.initialize_cubemap_on_gpu(
-		image_grid[1].mirror_vertical().rotate_90_degrees_counterclockwise(),
-		image_grid[7].mirror_vertical().rotate_90_degrees_clockwise(),
-		image_grid[10].mirror_horizontal(),
-		image_grid[4].mirror_vertical(),
-		image_grid[5].mirror_horizontal(),
-		image_grid[3].mirror_vertical());
+		image_grid[1].mirror_vertical().rotate_90_degrees_counterclockwise().to_image(),
+		image_grid[7].mirror_vertical().rotate_90_degrees_clockwise().to_image(),
+		image_grid[10].mirror_horizontal().to_image(),
+		image_grid[4].mirror_vertical().to_image(),
+		image_grid[5].mirror_horizontal().to_image(),
+		image_grid[3].mirror_vertical().to_image());
 	skybox.shader.load(
 		project::path + "shaders/skybox/skybox.vert.glsl",
 		project::path + "shaders/skybox/skybox.frag.glsl");
 
 	environment.background_color = {0.0f, 1.0f, 1.0f};
+	environment.initialize_uniform_block();
 
 	// Load Terrain & Water Terrain
 	// ***************************************** //
@@ -62,52 +64,37 @@ void scene_structure::initialize()
 
 	std::srand(static_cast<unsigned int>(std::time(0))); // Seed for randomness
 
-	Cini = 1;
-	Rini = 1;
-	for (int i = 0; i < 3; i++)
-	{
-		for (int j = 0; j < 3; j++)
-		{
-			// Create reference terrain
-			terrain_array[i][j].create_terrain_mesh(N_water_samples, water_length, nb_hollow);
-			terrain_array[i][j].generate_type_rock(nb_hollow);
-			terrain_array[i][j].generate_rock_rotation(nb_hollow);
-			terrain_array[i][j].generate_houses(nb_hollow);
-			terrain_array[i][j].mesh.texture.load_and_initialize_texture_2d_on_gpu(project::path + "assets/sand.jpg", GL_REPEAT, GL_REPEAT);
-			terrain_array[i][j].mesh.shader = terrain_shader;
-
-			water_array[i][j].initialize_data_on_gpu(create_water_mesh(N_water_samples, water_length));
-			water_array[i][j].shader = water_shader;
-			water_array[i][j].material.color = {0.0f, 0.5f, 1.0f}; // blue color for water
-			water_array[i][j].material.phong.specular = 0.0f;	   // non-specular terrain material
-
-			// Sending the skybox texture to the water shader as a uniform
-			glUseProgram(water_array[i][j].shader.id);
-			opengl_check;
-			glActiveTexture(GL_TEXTURE1);
-			opengl_check;
-			skybox.texture.bind();
-			opengl_uniform(water_array[i][j].shader, "image_skybox", 1);
-			opengl_check;
-
-			// Set the intial terrain layout centered on (Cini, Rini)
-			terrain_array[i][j].mesh.model.translation = {water_length * (i - Cini), water_length * (j - Rini), depth};
-			water_array[i][j].model.translation = {water_length * (i - Cini), water_length * (j - Rini), 0};
-
-			for (int k = 0; k < nb_hollow; k++)
-			{
-				terrain_array[i][j].hollowCenters[k].x += water_length * (i - Cini);
-				terrain_array[i][j].hollowCenters[k].y += water_length * (j - Rini);
-			}
-		}
-	}
+	// Terrains are generated in parallel on the worker threads of terrain_tiles
+	ring_radius = 1;
+	// The textures are shared through the registry and decoded in background: they are displayed with a placeholder until their upload (see animation_loop)
+	//  They are compressed (bc1/bc3 with mipmap levels, cached next to the images as .cgptex) when the GPU supports it
+	opengl_texture_loader().use_compression = true;
+	//  Only their coarse mipmap levels are resident at first: the finer ones are streamed by distance to the camera (see display_frame)
+	opengl_texture_loader().stream_mipmaps = true;
+	opengl_texture_image_structure const sand_texture = opengl_texture_registry().acquire(project::path + "assets/sand.jpg", GL_REPEAT, GL_REPEAT);
+	terrain_tiles.initialize(ring_radius, N_water_samples, water_length, nb_hollow, depth, terrain_shader, sand_texture);
+
+	// A single water mesh is drawn once per tile with instancing, the offset of each tile is given per instance
+	water.initialize_data_on_gpu(create_water_mesh(N_water_samples, water_length));
+	water.shader = water_shader;
+	water.material.color = {0.0f, 0.5f, 1.0f}; // blue color for water
+	water.material.phong.specular = 0.0f;	   // non-specular terrain material
+	water_tile_offsets.resize(terrain_tiles.tiles.size());
+	water.initialize_supplementary_data_on_gpu(water_tile_offsets, 4, 1);
+
+	// Sending the skybox texture to the water shader as a uniform
+	opengl_state().use_program(water.shader.id);
+	opengl_state().active_texture(1);
+	skybox.texture.bind();
+	opengl_uniform(water.shader, "image_skybox", 1);
+	opengl_check;
 
 	// Load boat
 	// ***************************************** //
 	// Open source file https://sketchfab.com/3d-models/chinese-junk-ship-35b340bce9fb4e0680bc0116cebc35c9
 	mesh boat_mesh = mesh_load_file_obj(project::path + "assets/boat.obj");
 	boat.initialize_data_on_gpu(boat_mesh);
-	boat.texture.load_and_initialize_texture_2d_on_gpu(project::path + "assets/boat.png");
+	boat.texture = opengl_texture_registry().acquire(project::path + "assets/boat.png");
 	opengl_shader_structure boat_shader;
 	boat_shader.load(
 		project::path + "shaders/mesh/mesh.vert.glsl",
@@ -128,9 +115,8 @@ void scene_structure::initialize()
 	for (int i = 0; i < 2; i++)
 	{
 		fish[i].initialize_data_on_gpu(fish_mesh);
-		fish[i].texture.load_and_initialize_texture_2d_on_gpu(project::path + "assets/fish/Body_Normal.png");
-		fish[i].texture.load_and_initialize_texture_2d_on_gpu(project::path + "assets/fish/Winf3_Normal.png");
-		fish[i].texture.load_and_initialize_texture_2d_on_gpu(project::path + "assets/fish/Wing_Normal.png");
+		// A mesh_drawable has a single texture: only the last one (Wing_Normal) was used among Body_Normal, Winf3_Normal and Wing_Normal
+		fish[i].texture = opengl_texture_registry().acquire(project::path + "assets/fish/Wing_Normal.png");
 		fish[i].model.rotation = rotation_transform::from_axis_angle({0, 0, 1}, Pi) * rotation_transform::from_axis_angle({1, 0, 0}, Pi / 2);
 		fish[i].model.scaling = 0.1f;
 	}
@@ -149,9 +135,6 @@ void scene_structure::initialize()
 		 {0, -10.0, -15.0},
 		 {0, -10.0, -20.0}};
 
-	fish_positions = initial_fish_positions;
-	fish_positions2 = initial_fish_positions;
-
 	// Key times (time at which the position must pass in the corresponding position)
 	fish_times =
 		{0.0f,
@@ -162,7 +145,12 @@ void scene_structure::initialize()
 		 5.0f,
 		 8.0f};
 
-	int N = fish_positions.size();
+	// One track per fish, sharing the key times
+	fish_tracks.initialize(2, fish_times);
+	for (int k = 0; k < 2; k++)
+		fish_tracks.set_track(k, initial_fish_positions);
+
+	int N = fish_times.size();
 	fish_interval.t_min = fish_times[1];
 	fish_interval.t_max = fish_times[N - 2];
 	fish_interval.t = fish_interval.t_min;
@@ -175,7 +163,7 @@ void scene_structure::initialize()
 		rock_array[i].resize(rock_mesh[i], resize_ratios[i]);
 		rock_array[i].mesh.initialize_data_on_gpu(rock_mesh[i]);
 		// rock_array[i].mesh.model.scaling = 5.0f;
-		rock_array[i].mesh.texture.load_and_initialize_texture_2d_on_gpu(project::path + "assets/rocks/rock" + str(i + 1) + ".png", GL_REPEAT, GL_REPEAT);
+		rock_array[i].mesh.texture = opengl_texture_registry().acquire(project::path + "assets/rocks/rock" + str(i + 1) + ".png", GL_REPEAT, GL_REPEAT);
 		rock_array[i].mesh.shader = terrain_shader;
 		rock_array[i].mesh.material.phong.specular = 0.0f; // non-specular rock material
 	}
@@ -185,16 +173,37 @@ void scene_structure::initialize()
 	// ***************************************** //
 	mesh house_mesh = mesh_load_file_obj(project::path + "assets/thaihouse/thaihouse.obj");
 	house.initialize_data_on_gpu(house_mesh);
-	house.texture.load_and_initialize_texture_2d_on_gpu(project::path + "assets/thaihouse/Texture/Door_Window/Door_Window_BaseColor.png");
-	house.texture.load_and_initialize_texture_2d_on_gpu(project::path + "assets/thaihouse/Texture/stairs/stairs_BaseColor.png");
-	house.texture.load_and_initialize_texture_2d_on_gpu(project::path + "assets/thaihouse/Texture/structure/structure_BaseColor.png");
-	house.texture.load_and_initialize_texture_2d_on_gpu(project::path + "assets/thaihouse/Texture/wooden_planks/wooden planks_BaseColor.png");
+	// Single texture: only the last one (wooden planks) was used among Door_Window, stairs, structure and wooden planks
+	house.texture = opengl_texture_registry().acquire(project::path + "assets/thaihouse/Texture/wooden_planks/wooden planks_BaseColor.png");
 
 	house.model.scaling = 0.1f;
 	house.model.translation = {0, 0, 5.0f};
 	house_initial_rotation = rotation_transform::from_axis_angle({0, 0, 1}, Pi) * rotation_transform::from_axis_angle({1, 0, 0}, Pi / 2);
 	house.model.rotation = house_initial_rotation;
-	house_position.clear();
+
+	// Instanced versions of the rocks and the house
+	//  ***************************************** //
+	opengl_shader_structure instanced_shader;
+	instanced_shader.load(
+		project::path + "shaders/mesh_instanced/mesh_instanced.vert.glsl",
+		project::path + "shaders/mesh/mesh.frag.glsl");
+
+	int const max_rock_count = terrain_tiles.tiles.size() * nb_hollow; // upper bound per rock type
+	numarray<mat4> const rock_instance_models(max_rock_count);
+	// Each batch has its own VAO (the per-instance attributes 4-7 must not be enabled on the VAO of the non-instanced mesh)
+	for (int i = 0; i < 4; i++)
+	{
+		rock_batch[i].initialize_data_on_gpu(rock_mesh[i], instanced_shader, rock_array[i].mesh.texture);
+		rock_batch[i].material = rock_array[i].mesh.material;
+		rock_batch[i].initialize_supplementary_data_on_gpu(rock_instance_models, 4, 1);
+	}
+
+	house_batch.initialize_data_on_gpu(house_mesh, instanced_shader, house.texture);
+	house_batch.material = house.material;
+	house_batch.model = house.model;
+	house_batch.model.translation = {0, 0, 0}; // the instance gives the position and the rotation around z
+	numarray<mat4> const house_instance_models(3 * max_rock_count); // at most 3 houses per rock
+	house_batch.initialize_supplementary_data_on_gpu(house_instance_models, 4, 1);
 }
 
 void scene_structure::display_frame()
@@ -205,82 +214,100 @@ void scene_structure::display_frame()
 
 	vec3 camera_position = environment.get_camera_position();
 
+	// Update light position & time, and send the values shared by all the shaders once for the frame
+	environment.light_position = {boat.model.translation.x, boat.model.translation.y, 10.0f};
+	environment.time = timer.t;
+	environment.water_length = water_length;
+	environment.update_uniform_block();
+
+	// The textured elements request the mipmap levels needed at their distance, sent at the next frame
+	opengl_texture_residency().set_view(camera_position, environment.camera_projection, window.height);
+
 	glDepthMask(GL_FALSE); // disable depth-buffer writing
 	draw(skybox, environment);
 	glDepthMask(GL_TRUE); // re-activate depth-buffer write
 
-	environment.uniform_generic.uniform_float["time"] = timer.t;
-	environment.uniform_generic.uniform_float["water_length"] = water_length;
-
-	// Update light position & fog parameters
-	environment.light_position = {boat.model.translation.x, boat.model.translation.y, 10.0f};
-
-	draw(global_frame, environment);
+	// The opaque elements are recorded in the queue, and drawn at the end of the frame sorted by shader/texture/VAO
+	opaque_queue.push(global_frame);
 
 	// Draw Terrains & Rocks & Houses
 	//  ***************************************** //
-	int Cmov = (int)(boat.model.translation.x / water_length + 1.5 + 999) - Cini - 999;
-	int Cshift = (999 + Cini - Cmov) % 3; // making sure that (999 + Cini - Cmov) > 0
+	// Recycle the terrains left behind by the boat, and swap in the ones regenerated in background
+	terrain_tiles.update(boat.model.translation);
 
-	int Rmov = (int)(boat.model.translation.y / water_length + 1.5 + 999) - Rini - 999;
-	int Rshift = (999 + Rini - Rmov) % 3;
+	numarray_arena<mat4> rock_instance_models[4];
+	numarray_arena<mat4> house_instance_models;
 
-	// Recycle terrains whenever it is required
-	if (Cmov)
-	{
-		for (int j = 0; j < 3; j++)
-		{
-			terrain_array[Cshift][j].mesh.model.translation.x += 3 * water_length * Cmov;
-			water_array[Cshift][j].model.translation.x += 3 * water_length * Cmov;
-			for (int k = 0; k < nb_hollow; k++)
-				terrain_array[Cshift][j].hollowCenters[k].x += 3 * water_length * Cmov;
-		}
-		Cini += Cmov;
-	}
-	if (Rmov)
+	for (int t = 0; t < terrain_tiles.tiles.size(); t++)
 	{
-		for (int i = 0; i < 3; i++)
-		{
-			terrain_array[i][Rshift].mesh.model.translation.y += 3 * water_length * Rmov;
-			water_array[i][Rshift].model.translation.y += 3 * water_length * Rmov;
-			for (int k = 0; k < nb_hollow; k++)
-				terrain_array[i][Rshift].hollowCenters[k].y += 3 * water_length * Rmov;
-		}
-		Rini += Rmov;
-	}
+		TerrainTile const& tile = terrain_tiles.tiles[t];
+		TerrainData const& terrain = tile.current();
 
-	house_position.clear();
+		vec2 const water_offset = terrain_tiles.tile_offset(tile.tile);
+		water_tile_offsets[t] = {water_offset.x, water_offset.y, 0};
 
-	for (int i = 0; i < 3; i++)
-	{
-		for (int j = 0; j < 3; j++)
+		opaque_queue.push(terrain.mesh);
+		request_texture_residency(terrain.mesh);
+		for (int k = 0; k < nb_hollow; k++)
 		{
-
-			draw(terrain_array[i][j].mesh, environment);
-			draw(water_array[i][j], environment);
-			for (int k = 0; k < nb_hollow; k++)
+			int rock_type = terrain.type_rock[k];
+			vec3 const rock_position = vec3{terrain.hollowCenters[k].x, terrain.hollowCenters[k].y, 5.0f};
+			rotation_transform const rock_rotation = rotation_transform::from_axis_angle({0, 0, 1}, terrain.rock_rotation[k]);
+			mat4 const rock_model = affine(rock_rotation, rock_position).matrix();
+			request_texture_residency(rock_batch[rock_type], rock_model * rock_batch[rock_type].model.matrix());
+			if (gui.instanced_drawing)
+				rock_instance_models[rock_type].push_back(rock_model);
+			else
 			{
-				int rock_type = terrain_array[i][j].type_rock[k];
-				rock_array[rock_type].mesh.model.translation = vec3{terrain_array[i][j].hollowCenters[k].x, terrain_array[i][j].hollowCenters[k].y, 5.0f};
-				rock_array[rock_type].mesh.model.rotation = rotation_transform::from_axis_angle({0, 0, 1}, terrain_array[i][j].rock_rotation[k]);
-				draw(rock_array[rock_type].mesh, environment);
+				rock_array[rock_type].mesh.model.translation = rock_position;
+				rock_array[rock_type].mesh.model.rotation = rock_rotation;
+				opaque_queue.push(rock_array[rock_type].mesh);
+			}
 
-				for (int l = 0; l < terrain_array[i][j].nb_houses[k]; l++)
+			for (int l = 0; l < terrain.nb_houses[k]; l++)
+			{
+				vec3 const new_pos = terrain.house_position(k, l);
+				rotation_transform const house_rotation = rotation_transform::from_axis_angle({0, 0, 1}, l * 15.0f);
+				mat4 const house_model = affine(house_rotation, new_pos).matrix();
+				request_texture_residency(house_batch, house_model * house_batch.model.matrix());
+				if (gui.instanced_drawing)
+					house_instance_models.push_back(house_model);
+				else
 				{
-					vec3 new_pos = vec3{terrain_array[i][j].hollowCenters[k].x + (l + 1) * 10.0f, terrain_array[i][j].hollowCenters[k].y + (l + 1) * 10.0f, -1.0f};
 					house.model.translation = new_pos;
-					house_position.push_back(new_pos);
-					house.model.rotation = rotation_transform::from_axis_angle({0, 0, 1}, l * 15.0f) * house_initial_rotation;
-					draw(house, environment);
+					house.model.rotation = house_rotation * house_initial_rotation;
+					opaque_queue.push(house);
 					house.model.rotation = house_initial_rotation;
 				}
 			}
 		}
 	}
 
+	// One draw call per rock type, and one for all the houses
+	if (gui.instanced_drawing)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			if (rock_instance_models[i].size() == 0)
+				continue;
+			rock_batch[i].update_supplementary_data_on_gpu(rock_instance_models[i], 4);
+			opaque_queue.push(rock_batch[i], rock_instance_models[i].size());
+		}
+		if (house_instance_models.size() > 0)
+		{
+			house_batch.update_supplementary_data_on_gpu(house_instance_models, 4);
+			opaque_queue.push(house_batch, house_instance_models.size());
+		}
+	}
+
+	// All the water tiles in one draw call
+	water.update_supplementary_data_on_gpu(water_tile_offsets, 4);
+	opaque_queue.push(water, water_tile_offsets.size());
+
 	// Draw Boat
 	//  ***************************************** //
-	draw(boat, environment);
+	opaque_queue.push(boat);
+	request_texture_residency(boat);
 	display_semiTransparent(); // Display water and terrain as semi transparent for underwater effect
 
 	boat.model.rotation = rotation_transform::from_axis_angle({0, 1, 0}, 0.03f * sin(timer.t)) * rotation_transform::from_axis_angle({1, 0, 0}, 0.2f * sin(timer.t)) * initial_position_rotation;
@@ -298,12 +325,12 @@ void scene_structure::display_frame()
 	{
 		// std::cout << "Updating fish positions" << std::endl;
 
-		for (int i = 0; i < fish_positions.size(); i++)
+		for (int i = 0; i < initial_fish_positions.size(); i++)
 		{
 			vec3 translation = {boat.model.translation.x + 3.0f, boat.model.translation.y, boat.model.translation.z};
 			vec3 translation2 = {boat.model.translation.x + 5.0f, boat.model.translation.y, boat.model.translation.z};
-			fish_positions[i] = boat.model.rotation * initial_fish_positions[i] + translation;
-			fish_positions2[i] = boat.model.rotation * initial_fish_positions[i] + translation2;
+			fish_tracks.position(0, i) = boat.model.rotation * initial_fish_positions[i] + translation;
+			fish_tracks.position(1, i) = boat.model.rotation * initial_fish_positions[i] + translation2;
 
 			fish[0].model.rotation = boat.model.rotation;
 			fish[1].model.rotation = boat.model.rotation;
@@ -314,103 +341,27 @@ void scene_structure::display_frame()
 		// std::cout << "Fish Timer updated : " << fish_timer << std::endl;
 	}
 
-	// Compute the interpolated position
-	vec3 p = interpolation(t, fish_positions, fish_times);
-	vec3 p2 = interpolation(t, fish_positions2, fish_times);
+	// Compute the interpolated positions of all the fish at once
+	fish_tracks.evaluate(t, fish_current_positions);
 
-	fish[0].model.translation = p;
-	fish[1].model.translation = p2;
+	fish[0].model.translation = fish_current_positions[0];
+	fish[1].model.translation = fish_current_positions[1];
 
-	draw(fish[0], environment);
-	draw(fish[1], environment);
+	opaque_queue.push(fish[0]);
+	opaque_queue.push(fish[1]);
+	request_texture_residency(fish[0]);
+	request_texture_residency(fish[1]);
+
+	opaque_queue.draw(environment);
+}
 
+void scene_structure::simulation_step(float dt)
+{
 	// Detect collisions
 	//  ***************************************** //
-	const float collisionThreshold = 16.5f;
-	const float HousecollisionThreshold = 6.0f;
-	const float moveback = 1.0f;
-
-	for (int i = 0; i < 3; i++)
-	{
-		for (int j = 0; j < 3; j++)
-		{
-			for (int k = 0; k < nb_hollow; k++)
-			{
-				float rockX = terrain_array[i][j].hollowCenters[k].x;
-				float rockY = terrain_array[i][j].hollowCenters[k].y;
-
-				// Calculate the distance between the boat and the rock
-				float distX = boat.model.translation.x - rockX;
-				float distY = boat.model.translation.y - rockY;
-				float distanceSquared = distX * distX + distY * distY;
-
-				if (distanceSquared < collisionThreshold * collisionThreshold)
-				{
-					// Apply a simple correction by moving the boat away from the rock
-					if (std::abs(distX) > std::abs(distY))
-					{
-						if (distX > 0)
-						{
-							boat.model.translation.x += moveback;
-						}
-						else
-						{
-							boat.model.translation.x -= moveback;
-						}
-					}
-					else
-					{
-						if (distY > 0)
-						{
-							boat.model.translation.y += moveback;
-						}
-						else
-						{
-							boat.model.translation.y -= moveback;
-						}
-					}
-				}
-			}
-		}
-	}
-
-	for (int i = 0; i < house_position.size(); i++)
-	{
-		float houseX = house_position[i].x;
-		float houseY = house_position[i].y;
-
-		// Calculate the distance between the boat and the rock
-		float distX = boat.model.translation.x - houseX;
-		float distY = boat.model.translation.y - houseY;
-		float distanceSquared = distX * distX + distY * distY;
-
-		if (distanceSquared < HousecollisionThreshold * HousecollisionThreshold)
-		{
-			// Apply a simple correction by moving the boat away from the rock
-			if (std::abs(distX) > std::abs(distY))
-			{
-				if (distX > 0)
-				{
-					boat.model.translation.x += moveback;
-				}
-				else
-				{
-					boat.model.translation.x -= moveback;
-				}
-			}
-			else
-			{
-				if (distY > 0)
-				{
-					boat.model.translation.y += moveback;
-				}
-				else
-				{
-					boat.model.translation.y -= moveback;
-				}
-			}
-		}
-	}
+	// Only the rocks and houses stored in the grid cells around the boat are tested
+	const float moveback = 60.0f * dt; // 1 unit per step at 60 steps per second
+	terrain_tiles.obstacles.resolve_collisions(boat.model.translation, 0.0f, moveback);
 }
 
 void scene_structure::display_semiTransparent()
@@ -421,6 +372,7 @@ void scene_structure::display_gui()
 {
 	ImGui::Checkbox("Frame", &gui.display_frame);
 	ImGui::Checkbox("Wireframe", &gui.display_wireframe);
+	ImGui::Checkbox("Instanced rocks/houses", &gui.instanced_drawing);
 }
 
 void scene_structure::mouse_move_event()
@@ -5,6 +5,8 @@
 
 #include "rock.hpp"
 #include "terrain.hpp"
+#include "tile_streaming.hpp"
+#include "interpolation.hpp"
 
 // This definitions allow to use the structures: mesh, mesh_drawable, etc. without mentionning explicitly cgp::
 using cgp::mesh;
@@ -18,6 +20,7 @@ struct gui_parameters
 {
 	bool display_frame = true;
 	bool display_wireframe = false;
+	bool instanced_drawing = true; // Draw the rocks (one call per rock type) and the houses (one call) with instancing
 };
 
 // The structure of the custom scene
@@ -35,6 +38,7 @@ struct scene_structure : cgp::scene_inputs_generic
 	mesh_drawable global_frame;		   // The standard global frame
 	environment_structure environment; // Standard environment controler
 	cgp::skybox_drawable skybox;
+	cgp::draw_queue_structure opaque_queue; // opaque draw calls of the frame, sorted by state before drawing
 
 	input_devices inputs; // Storage for inputs status (mouse, keyboard, window dimension)
 	gui_parameters gui;	  // Standard GUI element storage
@@ -50,7 +54,8 @@ struct scene_structure : cgp::scene_inputs_generic
 	// *********************************** //
 	// Water elements
 	// *********************************** //
-	cgp::mesh_drawable water_array[3][3];
+	cgp::mesh_drawable water;		  // single water geometry shared by all the tiles (drawn with instancing)
+	numarray<vec3> water_tile_offsets; // per-instance offset of each water tile (same index as terrain_tiles.tiles)
 	float water_length;
 	int N_water_samples;
 	int nb_hollow;
@@ -58,9 +63,8 @@ struct scene_structure : cgp::scene_inputs_generic
 	// ***********************************//
 	// Terrain elements
 	// *********************************** //
-	TerrainData terrain_array[3][3];
-	int Cini;
-	int Rini;
+	TileStreaming terrain_tiles; // ring of terrains around the boat, regenerated in background
+	int ring_radius;			 // 1: 3x3 tiles, 2: 5x5, 3: 7x7
 
 	// *********************************** //
 	// Fish elements
@@ -79,7 +83,15 @@ struct scene_structure : cgp::scene_inputs_generic
 	cgp::mesh_drawable house;
 	cgp::rotation_transform house_initial_rotation;
 	int house_number;
-	std::vector<cgp::vec3> house_position;
+
+	// *********************************** //
+	// Instanced drawing of rocks and houses
+	// *********************************** //
+	// Same meshes as rock_array[k].mesh and house, drawn with the instanced shader and a per-instance model matrix
+	//  (the model of the mesh_drawable is applied first, then the one of the instance)
+	//  The per-instance model matrices are recomputed at each frame in the frame arena
+	mesh_drawable rock_batch[4];
+	mesh_drawable house_batch;
 
 	// *********************************** //
 	// Rock elements
@@ -96,9 +108,9 @@ struct scene_structure : cgp::scene_inputs_generic
 	float fish_timer; // Timer used for the interpolation of the position
 	cgp ::timer_interval fish_interval;
 	numarray<vec3> initial_fish_positions;
-	numarray<vec3> fish_positions;
-	numarray<vec3> fish_positions2;
 	numarray<float> fish_times;
+	KeyframeTracks fish_tracks;			   // key positions of each fish (updated every 10s around the boat)
+	numarray<vec3> fish_current_positions; // interpolated position of each fish at the current time
 
 	// ****************************** //
 	// Functions
@@ -106,6 +118,7 @@ struct scene_structure : cgp::scene_inputs_generic
 	void
 	initialize();		  // Standard initialization to be called before the animation loop
 	void display_frame(); // The frame display to be called within the animation loop
+	void simulation_step(float dt); // Fixed time step update of the simulation (called 0..N times per frame)
 	void display_gui();	  // The display of the GUI, also called within the animation loop
 	void scene_structure::display_semiTransparent();
 	void mouse_move_event();
@@ -17,7 +17,7 @@ float TerrainData::gaussian(float x, float y, float a, float b, float sigma)
 
 // max set at 10 on each center position, 6.1 at 1sigma = 2, 1.4 at 2sigma = 4
 // secondary max at 0.8 (10 x 2 x exp[-25/8]) in the middle of two nearest centers spearater by 10 (= 2 x (5/2)sigma if sigma=2)
-float TerrainData::terrainFunction(float x, float y, std::vector<cgp::vec2> centers)
+float TerrainData::terrainFunction(float x, float y, std::vector<cgp::vec2> const& centers)
 {
     float result = 0.0f;
     for (vec2 center : centers)
@@ -27,7 +27,61 @@ float TerrainData::terrainFunction(float x, float y, std::vector<cgp::vec2> cent
     return 6.0f * result;
 }
 
-bool TerrainData::nocolision(std::vector<cgp::vec2> center, float taille, cgp::vec2 new_pos)
+// Same heights as calling terrainFunction(x, y, hollowCenters) on each vertex of the grid, but
+//  - the rows (ku) are distributed over the threads (OpenMP)
+//  - each row is processed one center at a time over contiguous arrays, so that the arithmetic part vectorizes.
+//    exp is kept as the scalar function and the sum over the centers is done in the same order: the result is bit-identical.
+void TerrainData::compute_heightfield(numarray<float>& height, int N, int terrain_length) const
+{
+    height.resize(N * N);
+    int const N_center = int(hollowCenters.size());
+    float const sigma = 6.0f;
+
+    // The y coordinates are the same for every row
+    std::vector<float> y_row(N);
+    for (int kv = 0; kv < N; ++kv)
+    {
+        float v = kv / (N - 1.0f);
+        y_row[kv] = (v - 0.5f) * terrain_length;
+    }
+
+#pragma omp parallel
+    {
+        std::vector<float> exponent(N); // per-thread buffer
+
+#pragma omp for schedule(static)
+        for (int ku = 0; ku < N; ++ku)
+        {
+            float u = ku / (N - 1.0f);
+            float x = (u - 0.5f) * terrain_length;
+            float* z = &height.at(N * ku);
+
+            for (int kv = 0; kv < N; ++kv)
+                z[kv] = 0.0f;
+
+            for (int kc = 0; kc < N_center; ++kc)
+            {
+                float const dx = x - hollowCenters[kc].x;
+                float const cy = hollowCenters[kc].y;
+                for (int kv = 0; kv < N; ++kv)
+                {
+                    float const dy = y_row[kv] - cy;
+                    exponent[kv] = -((dx * dx) + (dy * dy)) / (2 * sigma * sigma);
+                }
+                for (int kv = 0; kv < N; ++kv)
+                {
+                    float const g = exp(exponent[kv]); // rounded to float as returned by gaussian()
+                    z[kv] += g;
+                }
+            }
+
+            for (int kv = 0; kv < N; ++kv)
+                z[kv] = 6.0f * z[kv];
+        }
+    }
+}
+
+bool TerrainData::nocolision(std::vector<cgp::vec2> const& center, float taille, cgp::vec2 new_pos)
 {
     for (cgp::vec2 pos : center)
         if ((pos.x - new_pos.x) * (pos.x - new_pos.x) + (pos.y - new_pos.y) * (pos.y - new_pos.y) < taille * taille) return false;
@@ -37,14 +91,19 @@ bool TerrainData::nocolision(std::vector<cgp::vec2> center, float taille, cgp::v
 
 std::vector<cgp::vec2> TerrainData::generateRandomCenters(int terrain_length, int nb_hollow)
 {
+    // Local generator (instead of std::rand) so that terrains can be generated from several threads
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<> dis(0, terrain_length - 26);
+
     std::vector<cgp::vec2> centers;
     int nb = 0;
     while (nb < nb_hollow)
     {
         vec2 center;
         
-        center.x = (std::rand() % (terrain_length - 25)) - (terrain_length - 25) / 2;   // Random x within terrain bounds, with a distance of 25 to the borders
-        center.y = (std::rand() % (terrain_length - 25)) - (terrain_length - 25) / 2;   // Random y within terrain bounds, with a distance of 25 to the borders
+        center.x = dis(gen) - (terrain_length - 25) / 2;   // Random x within terrain bounds, with a distance of 25 to the borders
+        center.y = dis(gen) - (terrain_length - 25) / 2;   // Random y within terrain bounds, with a distance of 25 to the borders
 
         if (nocolision(centers, 40, center))                                // Min distance 40 between centers
         {
@@ -55,15 +114,20 @@ std::vector<cgp::vec2> TerrainData::generateRandomCenters(int terrain_length, in
     return centers;
 }
 
-void TerrainData::create_terrain_mesh(int N, int terrain_length, int nb_hollow)
+cgp::mesh TerrainData::create_terrain_geometry(int N, int terrain_length, int nb_hollow)
 {
     hollowCenters = generateRandomCenters(terrain_length, nb_hollow);
 
+    // Compute the surface height function on the whole grid
+    numarray<float> height;
+    compute_heightfield(height, N, terrain_length);
+
     cgp::mesh terrain; // temporary terrain storage (CPU only)
     terrain.position.resize(N * N);
     terrain.uv.resize(N * N);
 
     // Fill terrain geometry
+#pragma omp parallel for schedule(static)
     for (int ku = 0; ku < N; ++ku)
     {
         for (int kv = 0; kv < N; ++kv){
@@ -75,8 +139,8 @@ void TerrainData::create_terrain_mesh(int N, int terrain_length, int nb_hollow)
             float x = (u - 0.5f) * terrain_length;
             float y = (v - 0.5f) * terrain_length;
 
-            // Compute the surface height function at the given sampled coordinate
-            float z = terrainFunction(x, y, hollowCenters);
+            // Surface height at the given sampled coordinate (= terrainFunction(x, y, hollowCenters))
+            float z = height.at(kv + N * ku);
 
             // Store vertex coordinates
             terrain.position[kv + N * ku] = { x, y, z };
@@ -86,24 +150,34 @@ void TerrainData::create_terrain_mesh(int N, int terrain_length, int nb_hollow)
 
     // Generate triangle organization
     // Parametric surface with uniform grid sampling: generate 2 triangles for each grid cell
+    terrain.connectivity.resize(2 * (N - 1) * (N - 1));
     for (int ku = 0; ku < N - 1; ++ku)
     {
         for (int kv = 0; kv < N - 1; ++kv)
         {
             unsigned int idx = kv + N * ku; // current vertex offset
+            int const k_triangle = 2 * (kv + (N - 1) * ku);
 
             uint3 triangle_1 = { idx, idx + 1 + N, idx + 1 };
             uint3 triangle_2 = { idx, idx + N, idx + 1 + N };
 
-            terrain.connectivity.push_back(triangle_1);
-            terrain.connectivity.push_back(triangle_2);
+            terrain.connectivity.at(k_triangle) = triangle_1;
+            terrain.connectivity.at(k_triangle + 1) = triangle_2;
         }
     }
 
-    // need to call this function to fill the other buffer with default values (normal, color, etc)
+    // Normals of the regular grid by finite differences (no need of the connectivity)
+    normal_per_vertex_grid(terrain.position, N, N, terrain.normal);
+
+    // need to call this function to fill the other buffer with default values (color, etc)
     terrain.fill_empty_field();
 
-    mesh.initialize_data_on_gpu(terrain);
+    return terrain;
+}
+
+void TerrainData::create_terrain_mesh(int N, int terrain_length, int nb_hollow)
+{
+    mesh.initialize_data_on_gpu(create_terrain_geometry(N, terrain_length, nb_hollow));
 }
 
 void TerrainData::generate_type_rock(int nb_hollow) {
@@ -135,6 +209,11 @@ void TerrainData::generate_rock_rotation(int nb_hollow) {
     }
 }
 
+vec3 TerrainData::house_position(int k, int l) const
+{
+    return {hollowCenters[k].x + (l + 1) * 10.0f, hollowCenters[k].y + (l + 1) * 10.0f, -1.0f};
+}
+
 void TerrainData::generate_houses(int nb_hollow) {
     std::random_device rd;
     std::mt19937 gen(rd());
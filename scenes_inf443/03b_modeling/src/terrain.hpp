@@ -13,9 +13,15 @@ public:
     std::vector<int> nb_houses;
 
     float gaussian(float x, float y, float a, float b, float sigma);
-    float terrainFunction(float x, float y, std::vector<cgp::vec2> centers);
+    float terrainFunction(float x, float y, std::vector<cgp::vec2> const& centers);
     std::vector<cgp::vec2> generateRandomCenters(int terrain_length, int nb_hollow);
-    bool nocolision(std::vector<cgp::vec2> centers, float taille, cgp::vec2 new_pos);
+    bool nocolision(std::vector<cgp::vec2> const& centers, float taille, cgp::vec2 new_pos);
+    // Position of the l-th house around the k-th rock
+    cgp::vec3 house_position(int k, int l) const;
+    // Evaluate terrainFunction on the N x N grid of the terrain (same values, rows computed in parallel)
+    void compute_heightfield(cgp::numarray<float>& height, int N, int terrain_length) const;
+    // Generate the centers and the geometry of a new terrain on the CPU only (no OpenGL call: can run on a worker thread)
+    cgp::mesh create_terrain_geometry(int N, int terrain_length, int nb_hollow);
     void TerrainData::create_terrain_mesh(int N, int terrain_length, int nb_hollow);
     void TerrainData::generate_type_rock(int nb_hollow);
     void TerrainData::generate_rock_rotation(int nb_hollow);
@@ -0,0 +1,262 @@
+#include "tile_streaming.hpp"
+
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace cgp;
+
+// a mod n in [0, n[ (also for negative a)
+static int positive_mod(int a, int n)
+{
+    return ((a % n) + n) % n;
+}
+
+void TileStreaming::initialize(int ring_radius_arg, int N_samples_arg, float tile_length_arg, int nb_hollow_arg, float depth_arg, opengl_shader_structure const& shader, opengl_texture_image_structure const& texture, int thread_count)
+{
+    // A previous initialization: its workers may still use the tiles
+    stop_workers();
+    results.clear();
+
+    ring_radius = ring_radius_arg;
+    ring_size = 2 * ring_radius + 1;
+    N_samples = N_samples_arg;
+    tile_length = tile_length_arg;
+    nb_hollow = nb_hollow_arg;
+    depth = depth_arg;
+
+    for (TerrainTile& tile : tiles)
+        tile.terrain.mesh.clear();
+    tiles.clear();
+    tiles.resize(ring_size * ring_size);
+    center_tile = {0, 0};
+
+    obstacles.clear();
+    obstacles.cell_size = 2 * std::max(rock_collision_radius, house_collision_radius);
+
+    // Start the worker pool
+    if (thread_count <= 0)
+        thread_count = std::max(1, int(std::thread::hardware_concurrency()) - 1);
+    workers_stop = false;
+    for (int k = 0; k < thread_count; ++k)
+        workers.push_back(std::thread(&TileStreaming::worker_loop, this));
+
+    // Initial layout centered on tile (0,0): tile (tx,ty) goes in slot (tx mod ring_size, ty mod ring_size)
+    for (int ty = -ring_radius; ty <= ring_radius; ++ty)
+    {
+        for (int tx = -ring_radius; tx <= ring_radius; ++tx)
+        {
+            int const slot = positive_mod(tx, ring_size) + ring_size * positive_mod(ty, ring_size);
+            tiles[slot].tile = {tx, ty};
+            tiles[slot].generation = 1;
+            push_job(slot, true);
+        }
+    }
+
+    // Wait for all the initial terrains (generated in parallel) and allocate the GPU buffers of each tile
+    int received = 0;
+    while (received < int(tiles.size()))
+    {
+        TerrainTileResult result;
+        {
+            std::unique_lock<std::mutex> lock(results_mutex);
+            results_condition.wait(lock, [this] { return !results.empty(); });
+            result = std::move(results.front());
+            results.pop_front();
+        }
+
+        TerrainData& terrain = tiles[result.slot].terrain;
+        terrain.mesh.vertex_layout = mesh_drawable_vertex_layout::interleaved_compressed; // single compact VBO (constant color omitted)
+        terrain.mesh.initialize_data_on_gpu(result.geometry);
+        terrain.mesh.initialize_interleaved_double_buffer();
+        terrain.mesh.shader = shader;
+        terrain.mesh.texture = texture;
+        publish(result);
+        received++;
+    }
+}
+
+vec2 TileStreaming::tile_offset(int2 const& tile) const
+{
+    return {tile_length * tile.x, tile_length * tile.y};
+}
+
+void TileStreaming::update(vec3 const& position)
+{
+    // Recycle the tiles that are now outside of the ring
+    int2 const new_center = {int(std::floor(position.x / tile_length + 0.5f)), int(std::floor(position.y / tile_length + 0.5f))};
+    if (new_center.x != center_tile.x || new_center.y != center_tile.y)
+    {
+        center_tile = new_center;
+        for (int j = 0; j < ring_size; ++j)
+        {
+            for (int i = 0; i < ring_size; ++i)
+            {
+                // The unique tile of the ring [center-radius, center+radius] that belongs to the slot (i,j)
+                int const tx = center_tile.x - ring_radius + positive_mod(i - (center_tile.x - ring_radius), ring_size);
+                int const ty = center_tile.y - ring_radius + positive_mod(j - (center_tile.y - ring_radius), ring_size);
+
+                int const slot = i + ring_size * j;
+                if (tiles[slot].tile.x != tx || tiles[slot].tile.y != ty)
+                    recycle(slot, {tx, ty});
+            }
+        }
+    }
+
+    // Send the finished terrains to the GPU, with a limited number of uploads per frame
+    int uploaded = 0;
+    TerrainTileResult result;
+    while (uploaded < max_upload_per_frame && pop_result(result))
+    {
+        if (result.generation != tiles[result.slot].generation)
+            continue; // the tile has been recycled again in the meantime
+        publish(result);
+        uploaded++;
+    }
+}
+
+int TileStreaming::pending_count() const
+{
+    int count = 0;
+    for (TerrainTile const& tile : tiles)
+        if (tile.generation != tile.generation_ready)
+            count++;
+    return count;
+}
+
+void TileStreaming::recycle(int slot, int2 const& new_tile)
+{
+    TerrainTile& tile = tiles[slot];
+
+    // Move the current terrain to its new position while the new one is generated
+    vec2 const shift = tile_offset(new_tile) - tile_offset(tile.tile);
+    TerrainData& terrain = tile.current();
+    terrain.mesh.model.translation.x += shift.x;
+    terrain.mesh.model.translation.y += shift.y;
+    for (vec2& center : terrain.hollowCenters)
+        center += shift;
+    obstacles.translate_owner_obstacles(slot, shift);
+
+    tile.tile = new_tile;
+    tile.generation++;
+    push_job(slot);
+}
+
+void TileStreaming::publish(TerrainTileResult const& result)
+{
+    TerrainTile& tile = tiles[result.slot];
+    TerrainData& terrain = tile.terrain;
+
+    // All the terrains share the same grid: the vertices, packed by the worker, are written in the back vertex buffer
+    //  of the mesh which then becomes the drawn one (no re-allocation, the connectivity is unchanged)
+    terrain.mesh.update_interleaved_data_on_gpu(result.vertex_data);
+
+    vec2 const offset = tile_offset(tile.tile);
+    terrain.mesh.model.translation = {offset.x, offset.y, depth};
+    terrain.hollowCenters = result.layout.hollowCenters;
+    for (vec2& center : terrain.hollowCenters)
+        center += offset;
+    terrain.type_rock = result.layout.type_rock;
+    terrain.rock_rotation = result.layout.rock_rotation;
+    terrain.nb_houses = result.layout.nb_houses;
+
+    tile.generation_ready = result.generation;
+    update_obstacles(result.slot);
+}
+
+void TileStreaming::update_obstacles(int slot)
+{
+    TerrainData const& terrain = tiles[slot].current();
+
+    std::vector<Obstacle> tile_obstacles;
+    for (int k = 0; k < int(terrain.hollowCenters.size()); ++k)
+    {
+        tile_obstacles.push_back({terrain.hollowCenters[k], rock_collision_radius, slot});
+        for (int l = 0; l < terrain.nb_houses[k]; ++l)
+        {
+            vec3 const p = terrain.house_position(k, l);
+            tile_obstacles.push_back({{p.x, p.y}, house_collision_radius, slot});
+        }
+    }
+    obstacles.set_owner_obstacles(slot, tile_obstacles);
+}
+
+void TileStreaming::push_job(int slot, bool keep_geometry)
+{
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex);
+        // A job not started yet for the same slot is outdated
+        jobs.erase(std::remove_if(jobs.begin(), jobs.end(), [slot](job_structure const& job) { return job.slot == slot; }), jobs.end());
+        jobs.push_back({slot, tiles[slot].generation, keep_geometry});
+    }
+    jobs_condition.notify_one();
+}
+
+bool TileStreaming::pop_result(TerrainTileResult& result)
+{
+    std::lock_guard<std::mutex> lock(results_mutex);
+    if (results.empty())
+        return false;
+    result = std::move(results.front());
+    results.pop_front();
+    return true;
+}
+
+void TileStreaming::worker_loop()
+{
+#ifdef _OPENMP
+    // The pool already uses the cores: the OpenMP loops of the terrain generation run serially in each worker
+    omp_set_num_threads(1);
+#endif
+
+    while (true)
+    {
+        job_structure job;
+        {
+            std::unique_lock<std::mutex> lock(jobs_mutex);
+            jobs_condition.wait(lock, [this] { return workers_stop || !jobs.empty(); });
+            if (workers_stop)
+                return;
+            job = jobs.front();
+            jobs.pop_front();
+        }
+
+        // CPU only generation of the terrain and its elements
+        TerrainTileResult result;
+        result.slot = job.slot;
+        result.generation = job.generation;
+        result.geometry = result.layout.create_terrain_geometry(N_samples, int(tile_length), nb_hollow);
+        result.vertex_data = mesh_drawable::pack_interleaved(result.geometry);
+        if (!job.keep_geometry)
+            result.geometry = mesh();
+        result.layout.generate_type_rock(nb_hollow);
+        result.layout.generate_rock_rotation(nb_hollow);
+        result.layout.generate_houses(nb_hollow);
+
+        {
+            std::lock_guard<std::mutex> lock(results_mutex);
+            results.push_back(std::move(result));
+        }
+        results_condition.notify_one();
+    }
+}
+
+void TileStreaming::stop_workers()
+{
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex);
+        workers_stop = true;
+        jobs.clear();
+    }
+    jobs_condition.notify_all();
+    for (std::thread& worker : workers)
+        worker.join();
+    workers.clear();
+}
+
+TileStreaming::~TileStreaming()
+{
+    stop_workers();
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "cgp/cgp.hpp"
+#include "terrain.hpp"
+#include "obstacle_grid.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+// Terrain content generated by a worker thread, waiting to be sent to the GPU by the render thread
+struct TerrainTileResult
+{
+    int slot;       // index of the tile in TileStreaming::tiles
+    int generation; // value of TerrainTile::generation when the job was sent (older results are dropped)
+    cgp::mesh geometry; // only kept for the initial tiles (allocation of the GPU buffers)
+    std::vector<unsigned char> vertex_data; // vertices packed in the interleaved layout of the terrain mesh_drawable
+    TerrainData layout; // hollowCenters (local coordinates), type_rock, rock_rotation, nb_houses - its mesh_drawable is unused
+};
+
+// One slot of the ring of terrains around the boat
+struct TerrainTile
+{
+    // Terrain drawn for this tile - its mesh double-buffers the vertex buffer (initialize_interleaved_double_buffer):
+    //  a regenerated terrain is written in the buffer not used by the previous frame, and the connectivity is shared
+    TerrainData terrain;
+
+    // Coordinates of the tile in the infinite grid of tiles (tile (0,0) is centered on the origin)
+    cgp::int2 tile;
+
+    // Incremented each time the tile is recycled; a regeneration is pending while generation != generation_ready
+    int generation = 0;
+    int generation_ready = 0;
+
+    TerrainData& current() { return terrain; }
+    TerrainData const& current() const { return terrain; }
+};
+
+// Ring of (2 ring_radius + 1)^2 terrain tiles following the boat over an infinite ocean.
+//  When the boat crosses a tile, the tiles left behind are moved to the front (as before) and a new terrain
+//  is generated for them on a pool of worker threads. The render thread only uploads the finished terrains
+//  (at most max_upload_per_frame per frame) into the back vertex buffer of the tile, and then swaps the buffers.
+struct TileStreaming
+{
+    int ring_radius = 1; // 1: 3x3 tiles, 2: 5x5, 3: 7x7, ...
+    int ring_size = 3;   // = 2 ring_radius + 1
+
+    int N_samples = 0;      // number of samples along each side of a terrain
+    float tile_length = 0;  // size of a tile
+    int nb_hollow = 0;      // number of rocks per tile
+    float depth = 0;        // vertical position of the terrain
+
+    int max_upload_per_frame = 1; // Number of regenerated terrains sent to the GPU per frame
+
+    std::vector<TerrainTile> tiles; // ring_size x ring_size slots - slot (i,j) is tiles[i + ring_size * j]
+    cgp::int2 center_tile;          // tile on which the ring is centered
+
+    // Rocks and houses of the current terrains (owner = tile slot), updated when a tile is recycled or published
+    ObstacleGrid obstacles;
+    float rock_collision_radius = 16.5f;
+    float house_collision_radius = 6.0f;
+
+    // Generate all the initial tiles (in parallel on the worker pool) and send them to the GPU - the workers and the GPU meshes of a previous initialization are released first
+    //  thread_count<=0: use the number of hardware threads - 1
+    void initialize(int ring_radius, int N_samples, float tile_length, int nb_hollow, float depth, cgp::opengl_shader_structure const& shader, cgp::opengl_texture_image_structure const& texture, int thread_count = -1);
+
+    // To be called at every frame (render thread): recycle the tiles according to the position, and publish the finished ones
+    void update(cgp::vec3 const& position);
+
+    // Number of tiles currently regenerated in background
+    int pending_count() const;
+
+    // Position of the center of a tile in world space
+    cgp::vec2 tile_offset(cgp::int2 const& tile) const;
+
+    // Stop and join the worker threads (the tiles stay on the GPU)
+    void stop_workers();
+    ~TileStreaming();
+
+private:
+    struct job_structure { int slot; int generation; bool keep_geometry; };
+
+    std::vector<std::thread> workers;
+    std::deque<job_structure> jobs;
+    std::mutex jobs_mutex;
+    std::condition_variable jobs_condition;
+    bool workers_stop = false;
+
+    std::deque<TerrainTileResult> results;
+    std::mutex results_mutex;
+    std::condition_variable results_condition;
+
+    void worker_loop();
+    void push_job(int slot, bool keep_geometry = false);
+    void recycle(int slot, cgp::int2 const& new_tile);
+    void publish(TerrainTileResult const& result);
+    void update_obstacles(int slot);
+    bool pop_result(TerrainTileResult& result);
+};